@@ -22,10 +22,12 @@
 #include "render/integrator.h"
 #include "render/scene.h"
 #include "render/session.h"
+#include "render/stats.h"
 
 #include "util/util_args.h"
 #include "util/util_foreach.h"
 #include "util/util_function.h"
+#include "util/util_guarded_allocator.h"
 #include "util/util_image.h"
 #include "util/util_logging.h"
 #include "util/util_path.h"
@@ -48,12 +50,15 @@ struct Options {
   Session *session;
   Scene *scene;
   string filepath;
+  vector<string> filepaths;
   int width, height;
   SceneParams scene_params;
   SessionParams session_params;
   bool quiet;
   bool show_help, interactive, pause;
   string output_path;
+  string benchmark_path;
+  double scene_load_time;
 } options;
 
 static void session_print(const string &str)
@@ -129,7 +134,14 @@ static void scene_init()
   options.scene = new Scene(options.scene_params, options.session->device);
 
   /* Read XML */
-  xml_read_file(options.scene, options.filepath.c_str());
+  {
+    scoped_timer timer(&options.scene_load_time);
+    xml_read_file(options.scene, options.filepath.c_str());
+  }
+
+  if (!options.benchmark_path.empty()) {
+    options.scene->enable_update_stats();
+  }
 
   /* Camera width/height override? */
   if (!(options.width == 0 || options.height == 0)) {
@@ -352,10 +364,179 @@ static void keyboard(unsigned char key)
 }
 #endif
 
+/* Benchmark mode: render every given scene in background and write the timings of each
+ * render as JSON, so throughput can be compared between versions and machines. */
+
+static string json_escape(const string &str)
+{
+  string result = "\"";
+  foreach (char c, str) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    }
+    else if ((unsigned char)c < 0x20) {
+      result += string_printf("\\u%04x", (int)c);
+    }
+    else {
+      result += c;
+    }
+  }
+  return result + "\"";
+}
+
+static string json_time_stats(const UpdateTimeStats &stats)
+{
+  string result = "{";
+  for (size_t i = 0; i < stats.times.entries.size(); i++) {
+    const NamedTimeEntry &entry = stats.times.entries[i];
+    result += string_printf(
+        "%s%s: %f", (i == 0) ? "" : ", ", json_escape(entry.name).c_str(), entry.time);
+  }
+  return result + "}";
+}
+
+static void json_sample_stats(string &result,
+                              const NamedNestedSampleStats &stats,
+                              const string &indent)
+{
+  result += string_printf("%s{\"name\": %s, \"samples\": %llu, \"children\": [",
+                          indent.c_str(),
+                          json_escape(stats.name).c_str(),
+                          (unsigned long long)stats.sum_samples);
+  for (size_t i = 0; i < stats.entries.size(); i++) {
+    result += (i == 0) ? "\n" : ",\n";
+    json_sample_stats(result, stats.entries[i], indent + "  ");
+  }
+  result += "]}";
+}
+
+static string benchmark_scene_report()
+{
+  Session *session = options.session;
+  Scene *scene = session->scene;
+
+  double total_time, render_time;
+  session->progress.get_time(total_time, render_time);
+  const uint64_t pixel_samples = session->progress.get_pixel_samples();
+
+  string result = "    {\n";
+  result += string_printf("      \"file\": %s,\n", json_escape(options.filepath).c_str());
+  result += string_printf("      \"width\": %d,\n", options.width);
+  result += string_printf("      \"height\": %d,\n", options.height);
+  result += string_printf("      \"samples\": %d,\n", options.session_params.samples);
+  result += string_printf("      \"scene_load_time\": %f,\n", options.scene_load_time);
+  result += string_printf("      \"total_time\": %f,\n", total_time);
+  result += string_printf("      \"render_time\": %f,\n", render_time);
+  result += string_printf("      \"pixel_samples\": %llu,\n", (unsigned long long)pixel_samples);
+  result += string_printf("      \"pixel_samples_per_second\": %f,\n",
+                          (render_time > 0.0) ? pixel_samples / render_time : 0.0);
+  result += string_printf("      \"device_memory_peak\": %llu,\n",
+                          (unsigned long long)session->stats.mem_peak);
+  result += string_printf("      \"host_memory_peak\": %llu,\n",
+                          (unsigned long long)util_guarded_get_mem_peak());
+
+  /* Timings of the last scene update, per manager. */
+  const SceneUpdateStats *update_stats = scene->update_stats;
+  result += "      \"update_times\": {\n";
+  result += "        \"scene\": " + json_time_stats(update_stats->scene) + ",\n";
+  result += "        \"geometry\": " + json_time_stats(update_stats->geometry) + ",\n";
+  result += "        \"light\": " + json_time_stats(update_stats->light) + ",\n";
+  result += "        \"object\": " + json_time_stats(update_stats->object) + ",\n";
+  result += "        \"image\": " + json_time_stats(update_stats->image) + ",\n";
+  result += "        \"background\": " + json_time_stats(update_stats->background) + ",\n";
+  result += "        \"camera\": " + json_time_stats(update_stats->camera) + ",\n";
+  result += "        \"film\": " + json_time_stats(update_stats->film) + ",\n";
+  result += "        \"integrator\": " + json_time_stats(update_stats->integrator) + ",\n";
+  result += "        \"osl\": " + json_time_stats(update_stats->osl) + ",\n";
+  result += "        \"particles\": " + json_time_stats(update_stats->particles) + ",\n";
+  result += "        \"svm\": " + json_time_stats(update_stats->svm) + ",\n";
+  result += "        \"tables\": " + json_time_stats(update_stats->tables) + ",\n";
+  result += "        \"procedurals\": " + json_time_stats(update_stats->procedurals) + "\n";
+  result += "      },\n";
+
+  /* Kernel profiling samples, only gathered on the CPU device. */
+  RenderStats render_stats;
+  session->collect_statistics(&render_stats);
+  result += string_printf("      \"geometry_memory\": %llu,\n",
+                          (unsigned long long)render_stats.mesh.geometry.total_size);
+  result += string_printf("      \"texture_memory\": %llu,\n",
+                          (unsigned long long)render_stats.image.textures.total_size);
+  result += "      \"kernel\":\n";
+  if (render_stats.has_profiling) {
+    render_stats.kernel.update_sum();
+    json_sample_stats(result, render_stats.kernel, "        ");
+    result += "\n";
+  }
+  else {
+    result += "        null\n";
+  }
+  result += "    }";
+
+  return result;
+}
+
+static bool benchmark_write_report(const vector<string> &scene_reports)
+{
+  FILE *file = path_fopen(options.benchmark_path, "wb");
+  if (!file) {
+    fprintf(stderr, "Failed to open benchmark report file %s\n", options.benchmark_path.c_str());
+    return false;
+  }
+
+  const DeviceInfo &device = options.session_params.device;
+  fprintf(file, "{\n");
+  fprintf(file, "  \"version\": %s,\n", json_escape(CYCLES_VERSION_STRING).c_str());
+  fprintf(file, "  \"device\": %s,\n", json_escape(device.description).c_str());
+  fprintf(file,
+          "  \"device_type\": %s,\n",
+          json_escape(Device::string_from_type(device.type)).c_str());
+  fprintf(file, "  \"threads\": %d,\n", options.session_params.threads);
+  fprintf(file, "  \"scenes\": [\n");
+  for (size_t i = 0; i < scene_reports.size(); i++) {
+    fprintf(file, "%s%s\n", scene_reports[i].c_str(), (i + 1 < scene_reports.size()) ? "," : "");
+  }
+  fprintf(file, "  ]\n");
+  fprintf(file, "}\n");
+  fclose(file);
+
+  return true;
+}
+
+static void benchmark_run()
+{
+  const int width = options.width, height = options.height;
+  vector<string> scene_reports;
+
+  foreach (const string &filepath, options.filepaths) {
+    options.filepath = filepath;
+    options.width = width;
+    options.height = height;
+
+    if (!options.quiet) {
+      printf("Benchmarking %s\n", filepath.c_str());
+    }
+
+    /* Measure the host memory peak of this scene only, not of all scenes so far. */
+    util_guarded_reset_mem_peak();
+
+    session_init();
+    options.session->wait();
+    scene_reports.push_back(benchmark_scene_report());
+    session_exit();
+  }
+
+  if (!benchmark_write_report(scene_reports)) {
+    exit(EXIT_FAILURE);
+  }
+}
+
 static int files_parse(int argc, const char *argv[])
 {
-  if (argc > 0)
+  if (argc > 0) {
     options.filepath = argv[0];
+    options.filepaths.push_back(argv[0]);
+  }
 
   return 0;
 }
@@ -429,6 +610,10 @@ static void options_parse(int argc, const char **argv)
              "--tile-height %d",
              &options.session_params.tile_size.y,
              "Tile height in pixels",
+             "--benchmark %s",
+             &options.benchmark_path,
+             "Render all given files in background and write timing statistics as JSON to this "
+             "file",
              "--list-devices",
              &list,
              "List information about all available devices",
@@ -490,6 +675,11 @@ static void options_parse(int argc, const char **argv)
   options.session_params.background = true;
 #endif
 
+  if (!options.benchmark_path.empty()) {
+    options.session_params.background = true;
+    options.session_params.use_profiling = true;
+  }
+
   /* Use progressive rendering */
   options.session_params.progressive = true;
 
@@ -542,6 +732,11 @@ int main(int argc, const char **argv)
   path_init();
   options_parse(argc, argv);
 
+  if (!options.benchmark_path.empty()) {
+    benchmark_run();
+    return 0;
+  }
+
 #ifdef WITH_CYCLES_STANDALONE_GUI
   if (options.session_params.background) {
 #endif
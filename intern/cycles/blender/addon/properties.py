@@ -693,6 +693,11 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         default=0,
         min=0, max=16,
     )
+    use_compact_attributes: BoolProperty(
+        name="Compact Attributes",
+        description="Store normals, tangents and UV maps with reduced precision to lower memory usage of dense meshes",
+        default=False,
+    )
     tile_order: EnumProperty(
         name="Tile Order",
         description="Tile order for rendering",
@@ -1622,11 +1622,19 @@ int2 CPUSplitKernel::split_kernel_local_size()
   return make_int2(1, 1);
 }
 
-int2 CPUSplitKernel::split_kernel_global_size(device_memory & /*kg*/,
-                                              device_memory & /*data*/,
+int2 CPUSplitKernel::split_kernel_global_size(device_memory &kg,
+                                              device_memory &data,
                                               DeviceTask & /*task*/)
 {
-  return make_int2(1, 1);
+  /* Every render thread runs its own split kernel, so keep a wavefront of rays in flight per
+   * thread: large enough for shader sorting to find coherent batches, while bounding the
+   * per-thread state buffer. */
+  const uint64_t max_buffer_size = 64 * 1024 * 1024;
+  const size_t num_elements = max_elements_for_max_buffer_size(kg, data, max_buffer_size);
+  const int side = clamp((int)round_down((size_t)sqrtf((float)num_elements), 8), 1, 32);
+  int2 global_size = make_int2(side, side);
+  VLOG(1) << "Global size: " << global_size << ".";
+  return global_size;
 }
 
 uint64_t CPUSplitKernel::state_buffer_size(device_memory &kernel_globals,
@@ -44,6 +44,40 @@ ccl_device_inline AttributeDescriptor attribute_not_found()
   return desc;
 }
 
+/* Compact attribute storage
+ *
+ * Unit vectors like normals and tangents are stored octahedron encoded with 16 bits per
+ * component, UV maps as two half floats. Both fit in a single uint. */
+
+ccl_device_inline float attribute_decode_snorm16(uint v)
+{
+  return max((float)(int)(short)(v & 0xFFFF) * (1.0f / 32767.0f), -1.0f);
+}
+
+ccl_device_inline float3 attribute_decode_octahedral(uint v)
+{
+  float x = attribute_decode_snorm16(v);
+  float y = attribute_decode_snorm16(v >> 16);
+  const float z = 1.0f - fabsf(x) - fabsf(y);
+  const float t = max(-z, 0.0f);
+  x += (x >= 0.0f) ? -t : t;
+  y += (y >= 0.0f) ? -t : t;
+  return normalize(make_float3(x, y, z));
+}
+
+ccl_device_inline float attribute_decode_half(uint h)
+{
+  /* Half floats written by the host never contain denormals, infinities or NaN. */
+  const uint sign = (h & 0x8000) << 16;
+  const uint bits = h & 0x7FFF;
+  return __uint_as_float((bits == 0) ? sign : (sign | ((bits << 13) + 0x38000000)));
+}
+
+ccl_device_inline float2 attribute_decode_half2(uint v)
+{
+  return make_float2(attribute_decode_half(v & 0xFFFF), attribute_decode_half(v >> 16));
+}
+
 /* Find attribute based on ID */
 
 ccl_device_inline uint object_attribute_map_offset(KernelGlobals *kg, int object)
@@ -164,7 +164,8 @@ ccl_device float2 triangle_attribute_float2(KernelGlobals *kg,
                                             float2 *dx,
                                             float2 *dy)
 {
-  if (desc.element & (ATTR_ELEMENT_VERTEX | ATTR_ELEMENT_VERTEX_MOTION | ATTR_ELEMENT_CORNER)) {
+  if (desc.element & (ATTR_ELEMENT_VERTEX | ATTR_ELEMENT_VERTEX_MOTION | ATTR_ELEMENT_CORNER |
+                      ATTR_ELEMENT_CORNER_HALF)) {
     float2 f0, f1, f2;
 
     if (desc.element & (ATTR_ELEMENT_VERTEX | ATTR_ELEMENT_VERTEX_MOTION)) {
@@ -175,9 +176,16 @@ ccl_device float2 triangle_attribute_float2(KernelGlobals *kg,
     }
     else {
       const int tri = desc.offset + sd->prim * 3;
-      f0 = kernel_tex_fetch(__attributes_float2, tri + 0);
-      f1 = kernel_tex_fetch(__attributes_float2, tri + 1);
-      f2 = kernel_tex_fetch(__attributes_float2, tri + 2);
+      if (desc.element == ATTR_ELEMENT_CORNER) {
+        f0 = kernel_tex_fetch(__attributes_float2, tri + 0);
+        f1 = kernel_tex_fetch(__attributes_float2, tri + 1);
+        f2 = kernel_tex_fetch(__attributes_float2, tri + 2);
+      }
+      else {
+        f0 = attribute_decode_half2(kernel_tex_fetch(__attributes_uint, tri + 0));
+        f1 = attribute_decode_half2(kernel_tex_fetch(__attributes_uint, tri + 1));
+        f2 = attribute_decode_half2(kernel_tex_fetch(__attributes_uint, tri + 2));
+      }
     }
 
 #ifdef __RAY_DIFFERENTIALS__
@@ -214,7 +222,8 @@ ccl_device float3 triangle_attribute_float3(KernelGlobals *kg,
                                             float3 *dx,
                                             float3 *dy)
 {
-  if (desc.element & (ATTR_ELEMENT_VERTEX | ATTR_ELEMENT_VERTEX_MOTION | ATTR_ELEMENT_CORNER)) {
+  if (desc.element & (ATTR_ELEMENT_VERTEX | ATTR_ELEMENT_VERTEX_MOTION | ATTR_ELEMENT_CORNER |
+                      ATTR_ELEMENT_VERTEX_OCT | ATTR_ELEMENT_CORNER_OCT)) {
     float3 f0, f1, f2;
 
     if (desc.element & (ATTR_ELEMENT_VERTEX | ATTR_ELEMENT_VERTEX_MOTION)) {
@@ -223,6 +232,21 @@ ccl_device float3 triangle_attribute_float3(KernelGlobals *kg,
       f1 = float4_to_float3(kernel_tex_fetch(__attributes_float3, desc.offset + tri_vindex.y));
       f2 = float4_to_float3(kernel_tex_fetch(__attributes_float3, desc.offset + tri_vindex.z));
     }
+    else if (desc.element == ATTR_ELEMENT_VERTEX_OCT) {
+      const uint4 tri_vindex = kernel_tex_fetch(__tri_vindex, sd->prim);
+      f0 = attribute_decode_octahedral(
+          kernel_tex_fetch(__attributes_uint, desc.offset + tri_vindex.x));
+      f1 = attribute_decode_octahedral(
+          kernel_tex_fetch(__attributes_uint, desc.offset + tri_vindex.y));
+      f2 = attribute_decode_octahedral(
+          kernel_tex_fetch(__attributes_uint, desc.offset + tri_vindex.z));
+    }
+    else if (desc.element == ATTR_ELEMENT_CORNER_OCT) {
+      const int tri = desc.offset + sd->prim * 3;
+      f0 = attribute_decode_octahedral(kernel_tex_fetch(__attributes_uint, tri + 0));
+      f1 = attribute_decode_octahedral(kernel_tex_fetch(__attributes_uint, tri + 1));
+      f2 = attribute_decode_octahedral(kernel_tex_fetch(__attributes_uint, tri + 2));
+    }
     else {
       const int tri = desc.offset + sd->prim * 3;
       f0 = float4_to_float3(kernel_tex_fetch(__attributes_float3, tri + 0));
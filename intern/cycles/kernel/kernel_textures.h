@@ -60,6 +60,7 @@ KERNEL_TEX(float, __attributes_float)
 KERNEL_TEX(float2, __attributes_float2)
 KERNEL_TEX(float4, __attributes_float3)
 KERNEL_TEX(uchar4, __attributes_uchar4)
+KERNEL_TEX(uint, __attributes_uint)
 
 /* lights */
 KERNEL_TEX(KernelLightDistribution, __light_distribution)
@@ -742,7 +742,12 @@ typedef enum AttributeElement {
   ATTR_ELEMENT_CURVE = (1 << 7),
   ATTR_ELEMENT_CURVE_KEY = (1 << 8),
   ATTR_ELEMENT_CURVE_KEY_MOTION = (1 << 9),
-  ATTR_ELEMENT_VOXEL = (1 << 10)
+  ATTR_ELEMENT_VOXEL = (1 << 10),
+  /* Compact device storage of vertex and corner attributes, see attribute_decode_octahedral()
+   * and attribute_decode_half2(). Only used on the device side, never on scene attributes. */
+  ATTR_ELEMENT_VERTEX_OCT = (1 << 11),
+  ATTR_ELEMENT_CORNER_OCT = (1 << 12),
+  ATTR_ELEMENT_CORNER_HALF = (1 << 13)
 } AttributeElement;
 
 typedef enum AttributeStandard {
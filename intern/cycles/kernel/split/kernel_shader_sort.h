@@ -46,7 +46,14 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
       bool valid = (ray_index != QUEUE_EMPTY_SLOT) &&
                    IS_STATE(kernel_split_state.ray_state, ray_index, RAY_ACTIVE);
       if (valid) {
-        value = kernel_split_sd(sd, ray_index)->shader & SHADER_MASK;
+        ShaderData *sd = kernel_split_sd(sd, ray_index);
+        value = sd->shader & SHADER_MASK;
+#  ifdef __KERNEL_CPU__
+        /* Group rays hitting the same shader by the octant of their direction as well, so
+         * consecutive rays also take similar paths through the BVH on the next bounce. */
+        value = (value << 3) | ((sd->I.x < 0.0f) ? 1 : 0) | ((sd->I.y < 0.0f) ? 2 : 0) |
+                ((sd->I.z < 0.0f) ? 4 : 0);
+#  endif
       }
     }
     local_value[i + lid] = value;
@@ -54,7 +61,6 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
   }
   ccl_barrier(CCL_LOCAL_MEM_FENCE);
 
-  /* skip sorting for cpu split kernel */
 #  ifdef __KERNEL_OPENCL__
 
   /* bitonic sort */
@@ -77,6 +83,38 @@ ccl_device void kernel_shader_sort(KernelGlobals *kg, ccl_local_param ShaderSort
       }
     }
   }
+#  elif defined(__KERNEL_CPU__)
+
+  /* The CPU split kernel runs with a local size of one, so a single thread owns the whole
+   * block and can sort it directly. Bottom-up merge sort, stable so rays with equal keys
+   * keep their queue order. */
+  ushort scratch[SHADER_SORT_BLOCK_SIZE];
+  ushort *src = local_index;
+  ushort *dst = scratch;
+  for (int width = 1; width < SHADER_SORT_BLOCK_SIZE; width <<= 1) {
+    for (int start = 0; start < SHADER_SORT_BLOCK_SIZE; start += 2 * width) {
+      const int mid = min(start + width, SHADER_SORT_BLOCK_SIZE);
+      const int end = min(start + 2 * width, SHADER_SORT_BLOCK_SIZE);
+      int i = start, j = mid, k = start;
+      while (i < mid && j < end) {
+        dst[k++] = (local_value[src[j]] < local_value[src[i]]) ? src[j++] : src[i++];
+      }
+      while (i < mid) {
+        dst[k++] = src[i++];
+      }
+      while (j < end) {
+        dst[k++] = src[j++];
+      }
+    }
+    ushort *tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  if (src != local_index) {
+    for (int i = 0; i < SHADER_SORT_BLOCK_SIZE; i++) {
+      local_index[i] = src[i];
+    }
+  }
 #  endif /* __KERNEL_OPENCL__ */
 
   /* copy to destination */
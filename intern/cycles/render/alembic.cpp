@@ -25,6 +25,8 @@
 
 #include "util/util_foreach.h"
 #include "util/util_progress.h"
+#include "util/util_task.h"
+#include "util/util_tbb.h"
 #include "util/util_transform.h"
 #include "util/util_vector.h"
 
@@ -1043,10 +1045,9 @@ AttributeRequestSet AlembicObject::get_requested_attributes()
 {
   AttributeRequestSet requested_attributes;
 
-  Geometry *geometry = object->get_geometry();
-  assert(geometry);
-
-  foreach (Node *node, geometry->get_used_shaders()) {
+  /* Use our own shaders rather than the ones of the geometry, so that data can be loaded before
+   * the geometry is created. */
+  foreach (Node *node, used_shaders) {
     Shader *shader = static_cast<Shader *>(node);
 
     foreach (const AttributeRequest &attr, shader->attributes.requests) {
@@ -1367,6 +1368,8 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
   if (!archive.valid()) {
     Alembic::AbcCoreFactory::IFactory factory;
     factory.setPolicy(Alembic::Abc::ErrorHandler::kQuietNoopPolicy);
+    /* One stream per thread, so objects can be read in parallel. */
+    factory.setOgawaNumStreams(max(TaskScheduler::num_threads(), 1));
     archive = factory.getArchive(filepath.c_str());
 
     if (!archive.valid()) {
@@ -1382,6 +1385,8 @@ void AlembicProcedural::generate(Scene *scene, Progress &progress)
     objects_loaded = true;
   }
 
+  load_objects_data(progress);
+
   const chrono_t frame_time = (chrono_t)((frame - frame_offset) / frame_rate);
 
   foreach (Node *node, objects) {
@@ -1462,6 +1467,57 @@ void AlembicProcedural::load_objects(Progress &progress)
   }
 }
 
+void AlembicProcedural::load_objects_data(Progress &progress)
+{
+  vector<AlembicObject *> objects_to_load;
+
+  foreach (Node *node, objects) {
+    AlembicObject *object = static_cast<AlembicObject *>(node);
+
+    if (!object->iobject.valid()) {
+      continue;
+    }
+
+    /* Curves have to be reloaded when their radius changes. */
+    if (ICurves::matches(object->iobject.getHeader()) &&
+        (default_radius_is_modified() || object->radius_scale_is_modified())) {
+      object->data_loaded = false;
+    }
+
+    if (!object->has_data_loaded()) {
+      objects_to_load.push_back(object);
+    }
+  }
+
+  parallel_for(blocked_range<size_t>(0, objects_to_load.size(), 1),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   if (progress.get_cancel()) {
+                     return;
+                   }
+
+                   AlembicObject *object = objects_to_load[i];
+                   const ObjectHeader &header = object->iobject.getHeader();
+
+                   if (IPolyMesh::matches(header)) {
+                     IPolyMesh polymesh(object->iobject, Alembic::Abc::kWrapExisting);
+                     IPolyMeshSchema schema = polymesh.getSchema();
+                     object->load_all_data(this, schema, scale, progress);
+                   }
+                   else if (ICurves::matches(header)) {
+                     ICurves curves(object->iobject, Alembic::Abc::kWrapExisting);
+                     ICurvesSchema schema = curves.getSchema();
+                     object->load_all_data(this, schema, scale, progress, default_radius);
+                   }
+                   else if (ISubD::matches(header)) {
+                     ISubD subd_mesh(object->iobject, Alembic::Abc::kWrapExisting);
+                     ISubDSchema schema = subd_mesh.getSchema();
+                     object->load_all_data(this, schema, scale, progress);
+                   }
+                 }
+               });
+}
+
 void AlembicProcedural::read_mesh(Scene *scene,
                                   AlembicObject *abc_object,
                                   Abc::chrono_t frame_time,
@@ -1716,8 +1772,7 @@ void AlembicProcedural::read_curves(Scene *scene,
 
   ICurvesSchema schema = curves.getSchema();
 
-  if (!abc_object->has_data_loaded() || default_radius_is_modified() ||
-      abc_object->radius_scale_is_modified()) {
+  if (!abc_object->has_data_loaded()) {
     abc_object->load_all_data(this, schema, scale, progress, default_radius);
   }
   else {
@@ -49,17 +49,22 @@ template<typename T> struct is_array<array<T>> : public std::true_type {
  * for constant data.
  *
  * The data is supposed to be stored in chronological order, and is looked up using the current
- * animation time in seconds using the TimeSampling from the Alembic property. */
+ * animation time in seconds using the TimeSampling from the Alembic property.
+ *
+ * Consecutive time points with identical data share a single copy of it, so data that does not
+ * actually change over (part of) the animation is only stored once and is not reloaded into the
+ * sockets when the frame changes. */
 template<typename T> class DataStore {
-  struct DataTimePair {
+  struct DataTimeIndexPair {
     double time = 0;
-    T data{};
+    size_t index = 0;
   };
 
-  vector<DataTimePair> data{};
+  vector<DataTimeIndexPair> index_data_map{};
+  vector<T> data{};
   Alembic::AbcCoreAbstract::TimeSampling time_sampling{};
 
-  double last_loaded_time = std::numeric_limits<double>::max();
+  size_t last_loaded_index = std::numeric_limits<size_t>::max();
 
  public:
   void set_time_sampling(Alembic::AbcCoreAbstract::TimeSampling time_sampling_)
@@ -81,16 +86,16 @@ template<typename T> class DataStore {
     }
 
     std::pair<size_t, Alembic::Abc::chrono_t> index_pair;
-    index_pair = time_sampling.getNearIndex(time, data.size());
-    DataTimePair &data_pair = data[index_pair.first];
+    index_pair = time_sampling.getNearIndex(time, index_data_map.size());
+    const DataTimeIndexPair &data_index = index_data_map[index_pair.first];
 
-    if (last_loaded_time == data_pair.time) {
+    if (last_loaded_index == data_index.index) {
       return nullptr;
     }
 
-    last_loaded_time = data_pair.time;
+    last_loaded_index = data_index.index;
 
-    return &data_pair.data;
+    return &data[data_index.index];
   }
 
   /* get the data for the specified time, but do not check if the data was already loaded for this
@@ -102,21 +107,26 @@ template<typename T> class DataStore {
     }
 
     std::pair<size_t, Alembic::Abc::chrono_t> index_pair;
-    index_pair = time_sampling.getNearIndex(time, data.size());
-    DataTimePair &data_pair = data[index_pair.first];
-    return &data_pair.data;
+    index_pair = time_sampling.getNearIndex(time, index_data_map.size());
+    return &data[index_data_map[index_pair.first].index];
   }
 
   void add_data(T &data_, double time)
   {
+    if (!data.empty() && data.back() == data_) {
+      index_data_map.push_back({time, data.size() - 1});
+      return;
+    }
+
+    index_data_map.push_back({time, data.size()});
+
     if constexpr (is_array<T>::value) {
       data.emplace_back();
-      data.back().data.steal_data(data_);
-      data.back().time = time;
+      data.back().steal_data(data_);
       return;
     }
 
-    data.push_back({time, data_});
+    data.push_back(data_);
   }
 
   bool is_constant() const
@@ -126,18 +136,19 @@ template<typename T> class DataStore {
 
   size_t size() const
   {
-    return data.size();
+    return index_data_map.size();
   }
 
   void clear()
   {
     invalidate_last_loaded_time();
+    index_data_map.clear();
     data.clear();
   }
 
   void invalidate_last_loaded_time()
   {
-    last_loaded_time = std::numeric_limits<double>::max();
+    last_loaded_index = std::numeric_limits<size_t>::max();
   }
 
   /* Copy the data for the specified time to the node's socket. If there is no
@@ -368,6 +379,10 @@ class AlembicProcedural : public Procedural {
   /* Load the data for all the objects whose data has not yet been loaded. */
   void load_objects(Progress &progress);
 
+  /* Read the cached data of all objects that need it from the archive, in parallel. Nodes for
+   * the objects are created afterwards by the read functions below. */
+  void load_objects_data(Progress &progress);
+
   /* Traverse the Alembic hierarchy to lookup the IObjects for the AlembicObjects that were
    * specified in our objects socket, and accumulate all of the transformations samples along the
    * way for each IObject. */
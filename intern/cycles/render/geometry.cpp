@@ -38,6 +38,7 @@
 #include "kernel/osl/osl_globals.h"
 
 #include "util/util_foreach.h"
+#include "util/util_half.h"
 #include "util/util_logging.h"
 #include "util/util_progress.h"
 #include "util/util_task.h"
@@ -293,10 +294,12 @@ GeometryManager::GeometryManager()
 {
   update_flags = UPDATE_ALL;
   need_flags_update = true;
+  dice_cache = new DiceCache();
 }
 
 GeometryManager::~GeometryManager()
 {
+  delete dice_cache;
 }
 
 void GeometryManager::update_osl_attributes(Device *device,
@@ -536,13 +539,78 @@ void GeometryManager::update_svm_attributes(Device *,
   dscene->attributes_map.copy_to_device();
 }
 
+/* Compact attribute storage, used for scenes that opt in to trade some precision for memory.
+ * Unit vectors are octahedron encoded and UV maps stored as half floats, see the decoding
+ * functions in geom_attribute.h. Returns ATTR_ELEMENT_NONE for attributes stored as is. */
+static AttributeElement compact_attribute_element(Geometry *geom,
+                                                  Attribute *mattr,
+                                                  AttributePrimitive prim,
+                                                  bool use_compact_attributes)
+{
+  if (!use_compact_attributes || prim != ATTR_PRIM_GEOMETRY || !geom->is_mesh()) {
+    return ATTR_ELEMENT_NONE;
+  }
+
+  /* Patch evaluation of subdivision surfaces reads attributes in their original format. */
+  Mesh *mesh = static_cast<Mesh *>(geom);
+  if (mesh->get_subdivision_type() != Mesh::SUBDIVISION_NONE) {
+    return ATTR_ELEMENT_NONE;
+  }
+
+  if (mattr->type == TypeFloat2 && mattr->element == ATTR_ELEMENT_CORNER) {
+    return ATTR_ELEMENT_CORNER_HALF;
+  }
+
+  if (mattr->std == ATTR_STD_VERTEX_NORMAL || mattr->std == ATTR_STD_UV_TANGENT) {
+    if (mattr->element == ATTR_ELEMENT_VERTEX) {
+      return ATTR_ELEMENT_VERTEX_OCT;
+    }
+    else if (mattr->element == ATTR_ELEMENT_CORNER) {
+      return ATTR_ELEMENT_CORNER_OCT;
+    }
+  }
+
+  return ATTR_ELEMENT_NONE;
+}
+
+static uint attribute_encode_snorm16(float f)
+{
+  return (uint)(ushort)(short)roundf(clamp(f, -1.0f, 1.0f) * 32767.0f);
+}
+
+static uint attribute_encode_octahedral(float3 n)
+{
+  const float len = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+  if (len == 0.0f) {
+    return 0;
+  }
+
+  float x = n.x / len;
+  float y = n.y / len;
+  if (n.z < 0.0f) {
+    const float fold_x = (1.0f - fabsf(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+    const float fold_y = (1.0f - fabsf(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+    x = fold_x;
+    y = fold_y;
+  }
+
+  return attribute_encode_snorm16(x) | (attribute_encode_snorm16(y) << 16);
+}
+
+static uint attribute_encode_half2(float2 f)
+{
+  return (uint)(ushort)float_to_half(f.x) | ((uint)(ushort)float_to_half(f.y) << 16);
+}
+
 static void update_attribute_element_size(Geometry *geom,
                                           Attribute *mattr,
                                           AttributePrimitive prim,
+                                          bool use_compact_attributes,
                                           size_t *attr_float_size,
                                           size_t *attr_float2_size,
                                           size_t *attr_float3_size,
-                                          size_t *attr_uchar4_size)
+                                          size_t *attr_uchar4_size,
+                                          size_t *attr_uint_size)
 {
   if (mattr) {
     size_t size = mattr->element_size(geom, prim);
@@ -550,6 +618,10 @@ static void update_attribute_element_size(Geometry *geom,
     if (mattr->element == ATTR_ELEMENT_VOXEL) {
       /* pass */
     }
+    else if (compact_attribute_element(geom, mattr, prim, use_compact_attributes) !=
+             ATTR_ELEMENT_NONE) {
+      *attr_uint_size += size;
+    }
     else if (mattr->element == ATTR_ELEMENT_CORNER_BYTE) {
       *attr_uchar4_size += size;
     }
@@ -577,8 +649,11 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
                                                       size_t &attr_float3_offset,
                                                       device_vector<uchar4> &attr_uchar4,
                                                       size_t &attr_uchar4_offset,
+                                                      device_vector<uint> &attr_uint,
+                                                      size_t &attr_uint_offset,
                                                       Attribute *mattr,
                                                       AttributePrimitive prim,
+                                                      bool use_compact_attributes,
                                                       TypeDesc &type,
                                                       AttributeDescriptor &desc)
 {
@@ -594,11 +669,35 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
     AttributeElement &element = desc.element;
     int &offset = desc.offset;
 
+    const AttributeElement compact_element = compact_attribute_element(
+        geom, mattr, prim, use_compact_attributes);
+
     if (mattr->element == ATTR_ELEMENT_VOXEL) {
       /* store slot in offset value */
       ImageHandle &handle = mattr->data_voxel();
       offset = handle.svm_slot();
     }
+    else if (compact_element != ATTR_ELEMENT_NONE) {
+      element = compact_element;
+      offset = attr_uint_offset;
+
+      assert(attr_uint.size() >= offset + size);
+      if (mattr->modified) {
+        if (element == ATTR_ELEMENT_CORNER_HALF) {
+          float2 *data = mattr->data_float2();
+          for (size_t k = 0; k < size; k++) {
+            attr_uint[offset + k] = attribute_encode_half2(data[k]);
+          }
+        }
+        else {
+          float3 *data = mattr->data_float3();
+          for (size_t k = 0; k < size; k++) {
+            attr_uint[offset + k] = attribute_encode_octahedral(data[k]);
+          }
+        }
+      }
+      attr_uint_offset += size;
+    }
     else if (mattr->element == ATTR_ELEMENT_CORNER_BYTE) {
       uchar4 *data = mattr->data_uchar4();
       offset = attr_uchar4_offset;
@@ -669,7 +768,7 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
         /* indices for subdivided attributes are retrieved
          * from patch table so no need for correction here*/
       }
-      else if (element == ATTR_ELEMENT_VERTEX)
+      else if (element == ATTR_ELEMENT_VERTEX || element == ATTR_ELEMENT_VERTEX_OCT)
         offset -= mesh->vert_offset;
       else if (element == ATTR_ELEMENT_VERTEX_MOTION)
         offset -= mesh->vert_offset;
@@ -679,7 +778,8 @@ void GeometryManager::update_attribute_element_offset(Geometry *geom,
         else
           offset -= mesh->face_offset;
       }
-      else if (element == ATTR_ELEMENT_CORNER || element == ATTR_ELEMENT_CORNER_BYTE) {
+      else if (element & (ATTR_ELEMENT_CORNER | ATTR_ELEMENT_CORNER_BYTE |
+                          ATTR_ELEMENT_CORNER_OCT | ATTR_ELEMENT_CORNER_HALF)) {
         if (prim == ATTR_PRIM_GEOMETRY)
           offset -= 3 * mesh->prim_offset;
         else
@@ -771,6 +871,9 @@ void GeometryManager::device_update_attributes(Device *device,
   size_t attr_float2_size = 0;
   size_t attr_float3_size = 0;
   size_t attr_uchar4_size = 0;
+  size_t attr_uint_size = 0;
+
+  const bool use_compact_attributes = scene->params.use_compact_attributes;
 
   for (size_t i = 0; i < scene->geometry.size(); i++) {
     Geometry *geom = scene->geometry[i];
@@ -781,10 +884,12 @@ void GeometryManager::device_update_attributes(Device *device,
       update_attribute_element_size(geom,
                                     attr,
                                     ATTR_PRIM_GEOMETRY,
+                                    use_compact_attributes,
                                     &attr_float_size,
                                     &attr_float2_size,
                                     &attr_float3_size,
-                                    &attr_uchar4_size);
+                                    &attr_uchar4_size,
+                                    &attr_uint_size);
 
       if (geom->is_mesh()) {
         Mesh *mesh = static_cast<Mesh *>(geom);
@@ -793,10 +898,12 @@ void GeometryManager::device_update_attributes(Device *device,
         update_attribute_element_size(mesh,
                                       subd_attr,
                                       ATTR_PRIM_SUBD,
+                                      use_compact_attributes,
                                       &attr_float_size,
                                       &attr_float2_size,
                                       &attr_float3_size,
-                                      &attr_uchar4_size);
+                                      &attr_uchar4_size,
+                                      &attr_uint_size);
       }
     }
   }
@@ -808,10 +915,12 @@ void GeometryManager::device_update_attributes(Device *device,
       update_attribute_element_size(object->geometry,
                                     &attr,
                                     ATTR_PRIM_GEOMETRY,
+                                    use_compact_attributes,
                                     &attr_float_size,
                                     &attr_float2_size,
                                     &attr_float3_size,
-                                    &attr_uchar4_size);
+                                    &attr_uchar4_size,
+                                    &attr_uint_size);
     }
   }
 
@@ -819,16 +928,19 @@ void GeometryManager::device_update_attributes(Device *device,
   dscene->attributes_float2.alloc(attr_float2_size);
   dscene->attributes_float3.alloc(attr_float3_size);
   dscene->attributes_uchar4.alloc(attr_uchar4_size);
+  dscene->attributes_uint.alloc(attr_uint_size);
 
   const bool copy_all_data = dscene->attributes_float.need_realloc() ||
                              dscene->attributes_float2.need_realloc() ||
                              dscene->attributes_float3.need_realloc() ||
-                             dscene->attributes_uchar4.need_realloc();
+                             dscene->attributes_uchar4.need_realloc() ||
+                             dscene->attributes_uint.need_realloc();
 
   size_t attr_float_offset = 0;
   size_t attr_float2_offset = 0;
   size_t attr_float3_offset = 0;
   size_t attr_uchar4_offset = 0;
+  size_t attr_uint_offset = 0;
 
   /* Fill in attributes. */
   for (size_t i = 0; i < scene->geometry.size(); i++) {
@@ -854,8 +966,11 @@ void GeometryManager::device_update_attributes(Device *device,
                                       attr_float3_offset,
                                       dscene->attributes_uchar4,
                                       attr_uchar4_offset,
+                                      dscene->attributes_uint,
+                                      attr_uint_offset,
                                       attr,
                                       ATTR_PRIM_GEOMETRY,
+                                      use_compact_attributes,
                                       req.type,
                                       req.desc);
 
@@ -877,8 +992,11 @@ void GeometryManager::device_update_attributes(Device *device,
                                         attr_float3_offset,
                                         dscene->attributes_uchar4,
                                         attr_uchar4_offset,
+                                        dscene->attributes_uint,
+                                        attr_uint_offset,
                                         subd_attr,
                                         ATTR_PRIM_SUBD,
+                                        use_compact_attributes,
                                         req.subd_type,
                                         req.subd_desc);
       }
@@ -905,8 +1023,11 @@ void GeometryManager::device_update_attributes(Device *device,
                                       attr_float3_offset,
                                       dscene->attributes_uchar4,
                                       attr_uchar4_offset,
+                                      dscene->attributes_uint,
+                                      attr_uint_offset,
                                       attr,
                                       ATTR_PRIM_GEOMETRY,
+                                      use_compact_attributes,
                                       req.type,
                                       req.desc);
 
@@ -935,6 +1056,7 @@ void GeometryManager::device_update_attributes(Device *device,
   dscene->attributes_float2.copy_to_device();
   dscene->attributes_float3.copy_to_device();
   dscene->attributes_uchar4.copy_to_device();
+  dscene->attributes_uint.copy_to_device();
 
   if (progress.get_cancel())
     return;
@@ -1377,6 +1499,7 @@ enum {
   ATTR_FLOAT2_MODIFIED = (1 << 3),
   ATTR_FLOAT3_MODIFIED = (1 << 4),
   ATTR_UCHAR4_MODIFIED = (1 << 5),
+  ATTR_UINT_MODIFIED = (1 << 12),
 
   CURVE_DATA_NEED_REALLOC = (1 << 6),
   MESH_DATA_NEED_REALLOC = (1 << 7),
@@ -1385,9 +1508,11 @@ enum {
   ATTR_FLOAT2_NEEDS_REALLOC = (1 << 9),
   ATTR_FLOAT3_NEEDS_REALLOC = (1 << 10),
   ATTR_UCHAR4_NEEDS_REALLOC = (1 << 11),
+  ATTR_UINT_NEEDS_REALLOC = (1 << 13),
 
   ATTRS_NEED_REALLOC = (ATTR_FLOAT_NEEDS_REALLOC | ATTR_FLOAT2_NEEDS_REALLOC |
-                        ATTR_FLOAT3_NEEDS_REALLOC | ATTR_UCHAR4_NEEDS_REALLOC),
+                        ATTR_FLOAT3_NEEDS_REALLOC | ATTR_UCHAR4_NEEDS_REALLOC |
+                        ATTR_UINT_NEEDS_REALLOC),
   DEVICE_MESH_DATA_NEEDS_REALLOC = (CURVE_DATA_NEED_REALLOC | ATTRS_NEED_REALLOC),
   DEVICE_CURVE_DATA_NEEDS_REALLOC = (MESH_DATA_NEED_REALLOC | ATTRS_NEED_REALLOC),
 };
@@ -1611,6 +1736,24 @@ void GeometryManager::device_update_preprocess(Device *device, Scene *scene, Pro
     dscene->attributes_uchar4.tag_modified();
   }
 
+  /* Compact attributes are encoded from float2 and float3 attributes. */
+  if (scene->params.use_compact_attributes) {
+    if (device_update_flags & (ATTR_FLOAT2_NEEDS_REALLOC | ATTR_FLOAT3_NEEDS_REALLOC)) {
+      device_update_flags |= ATTR_UINT_NEEDS_REALLOC;
+    }
+    else if (device_update_flags & (ATTR_FLOAT2_MODIFIED | ATTR_FLOAT3_MODIFIED)) {
+      device_update_flags |= ATTR_UINT_MODIFIED;
+    }
+  }
+
+  if (device_update_flags & ATTR_UINT_NEEDS_REALLOC) {
+    dscene->attributes_map.tag_realloc();
+    dscene->attributes_uint.tag_realloc();
+  }
+  else if (device_update_flags & ATTR_UINT_MODIFIED) {
+    dscene->attributes_uint.tag_modified();
+  }
+
   if (device_update_flags & DEVICE_MESH_DATA_MODIFIED) {
     /* if anything else than vertices or shaders are modified, we would need to reallocate, so
      * these are the only arrays that can be updated */
@@ -1768,6 +1911,9 @@ void GeometryManager::device_update(Device *device,
         dicing_camera->get_full_width(), dicing_camera->get_full_height(), 1);
     dicing_camera->update(scene);
 
+    /* Meshes are tessellated in parallel, dicing of a single mesh is multithreaded too. */
+    TaskPool pool;
+
     size_t i = 0;
     foreach (Geometry *geom, scene->geometry) {
       if (!(geom->is_modified() && geom->is_mesh())) {
@@ -1783,20 +1929,26 @@ void GeometryManager::device_update(Device *device,
           msg += string_printf(
               "%s %u/%u", mesh->name.c_str(), (uint)(i + 1), (uint)total_tess_needed);
 
-        progress.set_status("Updating Mesh", msg);
-
         mesh->subd_params->camera = dicing_camera;
-        DiagSplit dsplit(*mesh->subd_params);
-        mesh->tessellate(&dsplit);
+        mesh->subd_params->dice_cache = dice_cache;
 
-        i++;
+        pool.push([mesh, msg, &progress]() {
+          if (progress.get_cancel()) {
+            return;
+          }
 
-        if (progress.get_cancel()) {
-          return;
-        }
+          progress.set_status("Updating Mesh", msg);
+
+          DiagSplit dsplit(*mesh->subd_params);
+          mesh->tessellate(&dsplit);
+        });
+
+        i++;
       }
     }
 
+    pool.wait_work();
+
     if (progress.get_cancel()) {
       return;
     }
@@ -2024,6 +2176,7 @@ void GeometryManager::device_update(Device *device,
   dscene->attributes_float2.clear_modified();
   dscene->attributes_float3.clear_modified();
   dscene->attributes_uchar4.clear_modified();
+  dscene->attributes_uint.clear_modified();
 }
 
 void GeometryManager::device_free(Device *device, DeviceScene *dscene, bool force_free)
@@ -2051,6 +2204,7 @@ void GeometryManager::device_free(Device *device, DeviceScene *dscene, bool forc
   dscene->attributes_float2.free_if_need_realloc(force_free);
   dscene->attributes_float3.free_if_need_realloc(force_free);
   dscene->attributes_uchar4.free_if_need_realloc(force_free);
+  dscene->attributes_uint.free_if_need_realloc(force_free);
 
   /* Signal for shaders like displacement not to do ray tracing. */
   dscene->data.bvh.bvh_layout = BVH_LAYOUT_NONE;
@@ -34,6 +34,7 @@ CCL_NAMESPACE_BEGIN
 class BVH;
 class Device;
 class DeviceScene;
+class DiceCache;
 class Mesh;
 class Progress;
 class RenderStats;
@@ -197,6 +198,9 @@ class GeometryManager {
   /* Update Flags */
   bool need_flags_update;
 
+  /* Results of adaptive subdivision dicing, reused when re-tessellating. */
+  DiceCache *dice_cache;
+
   /* Constructor/Destructor */
   GeometryManager();
   ~GeometryManager();
@@ -261,8 +265,11 @@ class GeometryManager {
                                               size_t &attr_float3_offset,
                                               device_vector<uchar4> &attr_uchar4,
                                               size_t &attr_uchar4_offset,
+                                              device_vector<uint> &attr_uint,
+                                              size_t &attr_uint_offset,
                                               Attribute *mattr,
                                               AttributePrimitive prim,
+                                              bool use_compact_attributes,
                                               TypeDesc &type,
                                               AttributeDescriptor &desc);
 };
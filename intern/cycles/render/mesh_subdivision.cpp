@@ -163,9 +163,10 @@ class OsdData {
   Far::TopologyRefiner *refiner;
   Far::PatchTable *patch_table;
   Far::PatchMap *patch_map;
+  int max_isolation;
 
  public:
-  OsdData() : mesh(NULL), refiner(NULL), patch_table(NULL), patch_map(NULL)
+  OsdData() : mesh(NULL), refiner(NULL), patch_table(NULL), patch_map(NULL), max_isolation(0)
   {
   }
 
@@ -191,7 +192,7 @@ class OsdData {
         *mesh, Far::TopologyRefinerFactory<Mesh>::Options(type, options));
 
     /* adaptive refinement */
-    int max_isolation = calculate_max_isolation();
+    max_isolation = calculate_max_isolation();
     refiner->RefineAdaptive(Far::TopologyRefiner::AdaptiveOptions(max_isolation));
 
     /* create patch table */
@@ -442,6 +443,7 @@ void Mesh::tessellate(DiagSplit *split)
     }
 
     /* split patches */
+    split->set_isolation_level(osd_data.max_isolation);
     split->split_patches(osd_patches.data(), sizeof(OsdPatch));
   }
   else
@@ -110,6 +110,7 @@ class DeviceScene {
   device_vector<float2> attributes_float2;
   device_vector<float4> attributes_float3;
   device_vector<uchar4> attributes_uchar4;
+  device_vector<uint> attributes_uint;
 
   /* lights */
   device_vector<KernelLightDistribution> light_distribution;
@@ -180,6 +181,7 @@ class SceneParams {
   CurveShapeType hair_shape;
   bool persistent_data;
   int texture_limit;
+  bool use_compact_attributes;
 
   bool background;
 
@@ -195,6 +197,7 @@ class SceneParams {
     hair_shape = CURVE_RIBBON;
     persistent_data = false;
     texture_limit = 0;
+    use_compact_attributes = false;
     background = true;
   }
 
@@ -206,7 +209,8 @@ class SceneParams {
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             use_compact_attributes == params.use_compact_attributes);
   }
 
   int curve_subdivisions()
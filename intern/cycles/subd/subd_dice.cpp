@@ -22,6 +22,52 @@
 
 CCL_NAMESPACE_BEGIN
 
+/* Dice Cache */
+
+/* Upper bound on memory used by cached dicing results of a scene, least recently
+ * used results are freed first. */
+static const size_t DICE_CACHE_MAX_MEMORY = (size_t)512 * 1024 * 1024;
+
+struct DiceCache::Entry {
+  DiceCacheKey key;
+  uint64_t last_used;
+
+  vector<float3> P;
+  vector<float3> N;
+  vector<float2> uv;
+  vector<int> triangles;
+  vector<int> shader;
+  vector<int> triangle_patch;
+
+  size_t memory_size() const
+  {
+    return P.size() * sizeof(float3) + N.size() * sizeof(float3) + uv.size() * sizeof(float2) +
+           (triangles.size() + shader.size() + triangle_patch.size()) * sizeof(int) +
+           key.data.size() * sizeof(uint);
+  }
+};
+
+static uint64_t dice_cache_hash(const DiceCacheKey &key)
+{
+  return ((uint64_t)key.h0 << 32) | key.h1;
+}
+
+DiceCache::DiceCache() : memory(0), use_counter(0)
+{
+}
+
+DiceCache::~DiceCache()
+{
+}
+
+void DiceCache::clear()
+{
+  thread_scoped_lock lock(mutex);
+
+  entries.clear();
+  memory = 0;
+}
+
 /* EdgeDice Base */
 
 EdgeDice::EdgeDice(const SubdParams &params_) : params(params_)
@@ -45,8 +91,19 @@ void EdgeDice::reserve(int num_verts, int num_triangles)
   vert_offset = mesh->get_verts().size();
   tri_offset = mesh->num_triangles();
 
-  mesh->resize_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles());
-  mesh->reserve_mesh(mesh->get_verts().size() + num_verts, mesh->num_triangles() + num_triangles);
+  /* Resize rather than reserve, subpatches write their triangles at known offsets so
+   * they can be diced in parallel. */
+  mesh->resize_mesh(vert_offset + num_verts, tri_offset + num_triangles);
+
+  bool *smooth = mesh->smooth.data() + tri_offset;
+  for (int i = 0; i < num_triangles; i++) {
+    smooth[i] = true;
+  }
+
+  mesh->tag_triangles_modified();
+  mesh->tag_shader_modified();
+  mesh->tag_smooth_modified();
+  mesh->tag_triangle_patch_modified();
 
   Attribute *attr_vN = mesh->attributes.add(ATTR_STD_VERTEX_NORMAL);
 
@@ -69,14 +126,20 @@ void EdgeDice::set_vert(Patch *patch, int index, float2 uv)
   params.mesh->vert_patch_uv[index + vert_offset] = make_float2(uv.x, uv.y);
 }
 
-void EdgeDice::add_triangle(Patch *patch, int v0, int v1, int v2)
+void EdgeDice::add_triangle(Subpatch &sub, int v0, int v1, int v2)
 {
   Mesh *mesh = params.mesh;
+  size_t index = tri_offset + sub.triangle_offset++;
 
-  mesh->add_triangle(v0 + vert_offset, v1 + vert_offset, v2 + vert_offset, patch->shader, true);
-  params.mesh->triangle_patch[params.mesh->num_triangles() - 1] = patch->patch_index;
+  assert(index < mesh->num_triangles());
 
-  tri_offset++;
+  int *triangle = mesh->triangles.data() + index * 3;
+  triangle[0] = v0 + vert_offset;
+  triangle[1] = v1 + vert_offset;
+  triangle[2] = v2 + vert_offset;
+
+  mesh->shader[index] = sub.patch->shader;
+  mesh->triangle_patch[index] = sub.patch->patch_index;
 }
 
 void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
@@ -122,7 +185,99 @@ void EdgeDice::stitch_triangles(Subpatch &sub, int edge)
         v2 = sub.get_vert_along_grid_edge(edge, ++i);
     }
 
-    add_triangle(sub.patch, v1, v0, v2);
+    add_triangle(sub, v1, v0, v2);
+  }
+}
+
+bool EdgeDice::load_cached(const DiceCacheKey &key)
+{
+  DiceCache *cache = params.dice_cache;
+  if (cache == NULL) {
+    return false;
+  }
+
+  thread_scoped_lock lock(cache->mutex);
+
+  auto it = cache->entries.find(dice_cache_hash(key));
+  if (it == cache->entries.end() || !(it->second->key == key)) {
+    return false;
+  }
+
+  DiceCache::Entry *entry = it->second.get();
+  entry->last_used = ++cache->use_counter;
+
+  Mesh *mesh = params.mesh;
+  const size_t num_verts = key.num_verts;
+  const size_t num_triangles = key.num_triangles;
+
+  memcpy(mesh_P, entry->P.data(), sizeof(float3) * num_verts);
+  memcpy(mesh_N, entry->N.data(), sizeof(float3) * num_verts);
+  memcpy(mesh->vert_patch_uv.data() + vert_offset, entry->uv.data(), sizeof(float2) * num_verts);
+  memcpy(mesh->triangles.data() + tri_offset * 3,
+         entry->triangles.data(),
+         sizeof(int) * num_triangles * 3);
+  memcpy(mesh->shader.data() + tri_offset, entry->shader.data(), sizeof(int) * num_triangles);
+  memcpy(mesh->triangle_patch.data() + tri_offset,
+         entry->triangle_patch.data(),
+         sizeof(int) * num_triangles);
+
+  return true;
+}
+
+void EdgeDice::store_cached(DiceCacheKey &key)
+{
+  DiceCache *cache = params.dice_cache;
+  if (cache == NULL) {
+    return;
+  }
+
+  Mesh *mesh = params.mesh;
+  const size_t num_verts = key.num_verts;
+  const size_t num_triangles = key.num_triangles;
+  const uint64_t hash = dice_cache_hash(key);
+
+  /* Copy outside of the lock, other meshes may be tessellating at the same time. The key
+   * data is not needed by the caller anymore. */
+  unique_ptr<DiceCache::Entry> entry(new DiceCache::Entry());
+  entry->key = std::move(key);
+  entry->P.assign(mesh_P, mesh_P + num_verts);
+  entry->N.assign(mesh_N, mesh_N + num_verts);
+  entry->uv.assign(mesh->vert_patch_uv.data() + vert_offset,
+                   mesh->vert_patch_uv.data() + vert_offset + num_verts);
+  entry->triangles.assign(mesh->triangles.data() + tri_offset * 3,
+                          mesh->triangles.data() + (tri_offset + num_triangles) * 3);
+  entry->shader.assign(mesh->shader.data() + tri_offset,
+                       mesh->shader.data() + tri_offset + num_triangles);
+  entry->triangle_patch.assign(mesh->triangle_patch.data() + tri_offset,
+                               mesh->triangle_patch.data() + tri_offset + num_triangles);
+
+  const size_t entry_memory = entry->memory_size();
+  if (entry_memory > DICE_CACHE_MAX_MEMORY) {
+    return;
+  }
+
+  thread_scoped_lock lock(cache->mutex);
+
+  entry->last_used = ++cache->use_counter;
+
+  unique_ptr<DiceCache::Entry> &slot = cache->entries[hash];
+  if (slot) {
+    cache->memory -= slot->memory_size();
+  }
+  slot.swap(entry);
+  cache->memory += entry_memory;
+
+  /* Evict least recently used results until under budget. */
+  while (cache->memory > DICE_CACHE_MAX_MEMORY) {
+    auto oldest = cache->entries.begin();
+    for (auto it = cache->entries.begin(); it != cache->entries.end(); ++it) {
+      if (it->second->last_used < oldest->second->last_used) {
+        oldest = it;
+      }
+    }
+
+    cache->memory -= oldest->second->memory_size();
+    cache->entries.erase(oldest);
   }
 }
 
@@ -243,14 +398,14 @@ void QuadDice::add_grid(Subpatch &sub, int Mu, int Mv, int offset)
         int i3 = offset + i + j * (Mu - 1);
         int i4 = offset + (i - 1) + j * (Mu - 1);
 
-        add_triangle(sub.patch, i1, i2, i3);
-        add_triangle(sub.patch, i1, i3, i4);
+        add_triangle(sub, i1, i2, i3);
+        add_triangle(sub, i1, i3, i4);
       }
     }
   }
 }
 
-void QuadDice::dice(Subpatch &sub)
+void QuadDice::dice_grid(Subpatch &sub)
 {
   /* compute inner grid size with scale factor */
   int Mu = max(sub.edge_u0.T, sub.edge_u1.T);
@@ -267,13 +422,18 @@ void QuadDice::dice(Subpatch &sub)
 
   /* inner grid */
   add_grid(sub, Mu, Mv, sub.inner_grid_vert_offset);
+}
 
-  /* sides */
+void QuadDice::dice_sides(Subpatch &sub)
+{
   set_side(sub, 0);
   set_side(sub, 1);
   set_side(sub, 2);
   set_side(sub, 3);
+}
 
+void QuadDice::dice_stitch(Subpatch &sub)
+{
   stitch_triangles(sub, 0);
   stitch_triangles(sub, 1);
   stitch_triangles(sub, 2);
@@ -22,7 +22,12 @@
  * DiagSplit. For more algorithm details, see the DiagSplit paper or the
  * ARB_tessellation_shader OpenGL extension, Section 2.X.2. */
 
+#include "util/util_hash.h"
+#include "util/util_map.h"
+#include "util/util_math.h"
+#include "util/util_thread.h"
 #include "util/util_types.h"
+#include "util/util_unique_ptr.h"
 #include "util/util_vector.h"
 
 #include "subd/subd_subpatch.h"
@@ -30,6 +35,7 @@
 CCL_NAMESPACE_BEGIN
 
 class Camera;
+class DiceCache;
 class Mesh;
 class Patch;
 
@@ -43,6 +49,8 @@ struct SubdParams {
   int max_level;
   Camera *camera;
   Transform objecttoworld;
+  /* Optional, dicing results are reused from and stored in this cache. */
+  DiceCache *dice_cache;
 
   SubdParams(Mesh *mesh_, bool ptex_ = false)
   {
@@ -54,9 +62,88 @@ struct SubdParams {
     dicing_rate = 1.0f;
     max_level = 12;
     camera = NULL;
+    dice_cache = NULL;
   }
 };
 
+/* Dice Cache Key
+ *
+ * Everything the dicing result depends on: the control mesh, the isolation level
+ * of its patches and, per subpatch, the edge factors and vertex indices found by
+ * the split. The hash is used for lookup, the data itself to confirm a match. */
+
+class DiceCacheKey {
+ public:
+  uint h0, h1;
+  int num_verts;
+  int num_triangles;
+  vector<uint> data;
+
+  DiceCacheKey() : h0(0), h1(0x9e3779b9), num_verts(0), num_triangles(0)
+  {
+  }
+
+  void add(uint v)
+  {
+    h0 = hash_uint2(h0, v);
+    h1 = hash_uint2(h1, v ^ 0x5bd1e995);
+    data.push_back(v);
+  }
+
+  void add(int v)
+  {
+    add((uint)v);
+  }
+
+  void add(float v)
+  {
+    add(__float_as_uint(v));
+  }
+
+  void add(float2 v)
+  {
+    add(v.x);
+    add(v.y);
+  }
+
+  void add(float3 v)
+  {
+    add(v.x);
+    add(v.y);
+    add(v.z);
+  }
+
+  bool operator==(const DiceCacheKey &other) const
+  {
+    return h0 == other.h0 && h1 == other.h1 && num_verts == other.num_verts &&
+           num_triangles == other.num_triangles && data == other.data;
+  }
+};
+
+/* Dice Cache
+ *
+ * Dicing results kept for reuse by later tessellations with the same key, which
+ * happens when re-syncing a mesh for a camera that barely moved. Owned by the
+ * geometry manager, so results are freed along with the scene. */
+
+class DiceCache {
+ public:
+  DiceCache();
+  ~DiceCache();
+
+  void clear();
+
+ protected:
+  struct Entry;
+
+  thread_mutex mutex;
+  unordered_map<uint64_t, unique_ptr<Entry>> entries;
+  size_t memory;
+  uint64_t use_counter;
+
+  friend class EdgeDice;
+};
+
 /* EdgeDice Base */
 
 class EdgeDice {
@@ -72,9 +159,13 @@ class EdgeDice {
   void reserve(int num_verts, int num_triangles);
 
   void set_vert(Patch *patch, int index, float2 uv);
-  void add_triangle(Patch *patch, int v0, int v1, int v2);
+  void add_triangle(Subpatch &sub, int v0, int v1, int v2);
 
   void stitch_triangles(Subpatch &sub, int edge);
+
+  /* Reuse dicing results from #SubdParams.dice_cache. */
+  bool load_cached(const DiceCacheKey &key);
+  void store_cached(DiceCacheKey &key);
 };
 
 /* Quad EdgeDice */
@@ -95,7 +186,12 @@ class QuadDice : public EdgeDice {
   float quad_area(const float3 &a, const float3 &b, const float3 &c, const float3 &d);
   float scale_factor(Subpatch &sub, int Mu, int Mv);
 
-  void dice(Subpatch &sub);
+  /* Dicing is done in three passes over all subpatches: the inner grids and the
+   * stitching triangles only touch data owned by a single subpatch and may run in
+   * parallel, the sides write verts shared with neighboring subpatches. */
+  void dice_grid(Subpatch &sub);
+  void dice_sides(Subpatch &sub);
+  void dice_stitch(Subpatch &sub);
 };
 
 CCL_NAMESPACE_END
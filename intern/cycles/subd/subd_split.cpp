@@ -25,6 +25,7 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_math.h"
+#include "util/util_tbb.h"
 #include "util/util_types.h"
 
 CCL_NAMESPACE_BEGIN
@@ -35,6 +36,9 @@ CCL_NAMESPACE_BEGIN
 #define STITCH_NGON_CENTER_VERT_INDEX_OFFSET 0x60000000
 #define STITCH_NGON_SPLIT_EDGE_CENTER_VERT_TAG (0x60000000 - 1)
 
+/* Number of subpatches diced by a single task. */
+#define SUBPATCHES_PER_TASK 16
+
 DiagSplit::DiagSplit(const SubdParams &params_) : params(params_)
 {
 }
@@ -601,6 +605,65 @@ void DiagSplit::split_ngon(const Mesh::SubdFace &face, Patch *patches, size_t pa
   }
 }
 
+void DiagSplit::add_dice_cache_key(DiceCacheKey &key)
+{
+  const Mesh *mesh = params.mesh;
+
+  /* Control mesh. */
+  key.add((int)mesh->subdivision_type);
+  key.add(params.ptex ? 1 : 0);
+  key.add(isolation_level);
+
+  const size_t num_verts = mesh->verts.size();
+  key.add((int)num_verts);
+  for (size_t i = 0; i < num_verts; i++) {
+    key.add(mesh->verts[i]);
+  }
+
+  const Attribute *attr_vN = mesh->subd_attributes.find(ATTR_STD_VERTEX_NORMAL);
+  if (attr_vN) {
+    const float3 *vN = attr_vN->data_float3();
+    for (size_t i = 0; i < num_verts; i++) {
+      key.add(vN[i]);
+    }
+  }
+
+  for (size_t i = 0; i < mesh->subd_num_corners.size(); i++) {
+    key.add(mesh->subd_num_corners[i]);
+    key.add(mesh->subd_smooth[i] ? 1 : 0);
+  }
+
+  for (size_t i = 0; i < mesh->subd_face_corners.size(); i++) {
+    key.add(mesh->subd_face_corners[i]);
+  }
+
+  for (size_t i = 0; i < mesh->subd_creases_edge.size(); i++) {
+    key.add(mesh->subd_creases_edge[i]);
+  }
+
+  for (size_t i = 0; i < mesh->subd_creases_weight.size(); i++) {
+    key.add(mesh->subd_creases_weight[i]);
+  }
+
+  /* Subpatches, with the edge factors and vertex indices found by the split. */
+  foreach (const Subpatch &sub, subpatches) {
+    key.add(sub.patch->patch_index);
+    key.add(sub.patch->shader);
+
+    for (int i = 0; i < 4; i++) {
+      key.add(sub.corners[i]);
+    }
+
+    for (int edge = 0; edge < 4; edge++) {
+      key.add(sub.edges[edge].T);
+
+      for (int n = 0; n <= sub.edges[edge].T; n++) {
+        key.add(sub.get_vert_along_edge(edge, n));
+      }
+    }
+  }
+}
+
 void DiagSplit::post_split()
 {
   int num_stitch_verts = 0;
@@ -721,14 +784,6 @@ void DiagSplit::post_split()
   int num_verts = num_alloced_verts;
   int num_triangles = 0;
 
-  for (size_t i = 0; i < subpatches.size(); i++) {
-    subpatches[i].inner_grid_vert_offset = num_verts;
-    num_verts += subpatches[i].calc_num_inner_verts();
-    num_triangles += subpatches[i].calc_num_triangles();
-  }
-
-  dice.reserve(num_verts, num_triangles);
-
   for (size_t i = 0; i < subpatches.size(); i++) {
     Subpatch &sub = subpatches[i];
 
@@ -737,7 +792,42 @@ void DiagSplit::post_split()
     sub.edge_v0.T = max(sub.edge_v0.T, 1);
     sub.edge_v1.T = max(sub.edge_v1.T, 1);
 
-    dice.dice(sub);
+    sub.inner_grid_vert_offset = num_verts;
+    sub.triangle_offset = num_triangles;
+    num_verts += sub.calc_num_inner_verts();
+    num_triangles += sub.calc_num_triangles();
+  }
+
+  DiceCacheKey key;
+  key.num_verts = num_verts;
+  key.num_triangles = num_triangles;
+  add_dice_cache_key(key);
+
+  dice.reserve(num_verts, num_triangles);
+
+  if (!dice.load_cached(key)) {
+    /* Inner grids only write verts and triangles of their own subpatch. */
+    parallel_for(blocked_range<size_t>(0, subpatches.size(), SUBPATCHES_PER_TASK),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     dice.dice_grid(subpatches[i]);
+                   }
+                 });
+
+    /* Verts along edges are shared with neighboring subpatches, set them in order so
+     * the result does not depend on scheduling. */
+    for (size_t i = 0; i < subpatches.size(); i++) {
+      dice.dice_sides(subpatches[i]);
+    }
+
+    parallel_for(blocked_range<size_t>(0, subpatches.size(), SUBPATCHES_PER_TASK),
+                 [&](const blocked_range<size_t> &r) {
+                   for (size_t i = r.begin(); i != r.end(); i++) {
+                     dice.dice_stitch(subpatches[i]);
+                   }
+                 });
+
+    dice.store_cached(key);
   }
 
   /* Cleanup */
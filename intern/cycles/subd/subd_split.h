@@ -57,11 +57,21 @@ class DiagSplit {
   int num_alloced_verts = 0;
   int alloc_verts(int n); /* Returns start index of new verts. */
 
+  /* Adaptive isolation level the patches were refined with, changes their limit surface. */
+  int isolation_level = 0;
+
+  void add_dice_cache_key(DiceCacheKey &key);
+
  public:
   Edge *alloc_edge();
 
   explicit DiagSplit(const SubdParams &params);
 
+  void set_isolation_level(int level)
+  {
+    isolation_level = level;
+  }
+
   void split_patches(Patch *patches, size_t patches_byte_stride);
 
   void split_quad(const Mesh::SubdFace &face, Patch *patch);
@@ -28,6 +28,9 @@ class Subpatch {
  public:
   class Patch *patch; /* Patch this is a subpatch of. */
   int inner_grid_vert_offset;
+  /* Index of the next triangle to write for this subpatch while dicing, starts out at the
+   * offset of its first triangle so subpatches can be diced independently of each other. */
+  int triangle_offset;
 
   struct edge_t {
     int T;
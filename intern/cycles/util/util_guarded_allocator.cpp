@@ -45,4 +45,9 @@ size_t util_guarded_get_mem_peak()
   return global_stats.mem_peak;
 }
 
+void util_guarded_reset_mem_peak()
+{
+  global_stats.mem_peak = global_stats.mem_used;
+}
+
 CCL_NAMESPACE_END
@@ -160,6 +160,9 @@ template<typename T> class GuardedAllocator {
 size_t util_guarded_get_mem_used();
 size_t util_guarded_get_mem_peak();
 
+/* Reset the peak to the current usage, to measure the peak of a following section. */
+void util_guarded_reset_mem_peak();
+
 /* Call given function and keep track if it runs out of memory.
  *
  * If it does run out f memory, stop execution and set progress
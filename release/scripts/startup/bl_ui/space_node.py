@@ -188,6 +188,10 @@ class NODE_HT_header(Header):
 
         layout.operator("node.tree_path_parent", text="", icon='FILE_PARENT')
 
+        # Overlays
+        if snode.tree_type == 'GeometryNodeTree':
+            layout.popover(panel="NODE_PT_overlay", text="", icon='OVERLAY')
+
         # Backdrop
         if is_compositor:
             row = layout.row(align=True)
@@ -359,6 +363,22 @@ class NODE_PT_active_tool(ToolActivePanelHelper, Panel):
     bl_category = "Tool"
 
 
+class NODE_PT_overlay(Panel):
+    bl_space_type = 'NODE_EDITOR'
+    bl_region_type = 'HEADER'
+    bl_label = "Overlays"
+    bl_ui_units_x = 7
+
+    def draw(self, context):
+        layout = self.layout
+        snode = context.space_data
+
+        layout.label(text="Node Editor Overlays")
+
+        col = layout.column()
+        col.prop(snode, "show_node_profile", text="Profile")
+
+
 class NODE_PT_material_slots(Panel):
     bl_space_type = 'NODE_EDITOR'
     bl_region_type = 'HEADER'
@@ -732,6 +752,7 @@ classes = (
     NODE_MT_node,
     NODE_MT_node_color_context_menu,
     NODE_MT_context_menu,
+    NODE_PT_overlay,
     NODE_PT_material_slots,
     NODE_PT_node_color_presets,
     NODE_PT_active_node_generic,
@@ -106,6 +106,10 @@ class ReadAttribute {
     return this->get_span().typed<T>();
   }
 
+  /* Get a virtual span that contains all attribute values. Other than #get_span, this does not
+   * allocate an array when all elements have the same value. */
+  virtual fn::GVSpan get_virtual_span() const;
+
  protected:
   /* r_value is expected to be uninitialized. */
   virtual void get_internal(const int64_t index, void *r_value) const = 0;
@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "BLI_hash_mm2a.h"
 #include "BLI_sys_types.h"
 #include "BLI_utildefines.h"
 
@@ -568,6 +569,21 @@ typedef struct CustomDataTransferLayerMap {
 void CustomData_data_transfer(const struct MeshPairRemap *me_remap,
                               const CustomDataTransferLayerMap *laymap);
 
+/* Hashing of the content, used to find out whether data changed since an earlier evaluation. */
+typedef struct CustomDataHash {
+  /** Four seeds give a 128 bit hash, so that different data practically never has the same. */
+  BLI_HashMurmur2A mm2[4];
+} CustomDataHash;
+
+void CustomData_hash_init(CustomDataHash *hash);
+void CustomData_hash_add(CustomDataHash *hash, const void *data, size_t len);
+void CustomData_hash_add_int(CustomDataHash *hash, int value);
+void CustomData_hash_end(CustomDataHash *hash, uint64_t r_hash[2]);
+bool CustomData_hash_add_layers(CustomDataHash *hash,
+                                const struct CustomData *data,
+                                const int totelem);
+size_t CustomData_layers_memory_size(const struct CustomData *data, const int totelem);
+
 /* .blend file I/O */
 void CustomData_blend_write_prepare(struct CustomData *data,
                                     struct CustomDataLayer **r_write_layers,
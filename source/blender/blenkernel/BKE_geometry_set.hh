@@ -188,6 +188,13 @@ class GeometryComponent {
   virtual blender::Set<std::string> attribute_names() const;
   virtual bool is_empty() const;
 
+  /* Returns false when the component only references data it does not own, e.g. the input mesh
+   * of a modifier that is wrapped with #GeometryOwnershipType::Editable. */
+  virtual bool owns_direct_data() const;
+  /* Make a copy of referenced data that is not owned by this component. Can only be used when
+   * the component is mutable. */
+  virtual void ensure_owns_direct_data();
+
   /* Get a read-only attribute for the given domain and data type.
    * Returns null when it does not exist. */
   blender::bke::ReadAttributePtr attribute_try_get_for_read(
@@ -308,6 +315,8 @@ struct GeometrySet {
 
   void compute_boundbox_without_instances(blender::float3 *r_min, blender::float3 *r_max) const;
 
+  void ensure_owns_direct_data();
+
   friend std::ostream &operator<<(std::ostream &stream, const GeometrySet &geometry_set);
   friend bool operator==(const GeometrySet &a, const GeometrySet &b);
   uint64_t hash() const;
@@ -359,6 +368,7 @@ class MeshComponent : public GeometryComponent {
   Mesh *release();
 
   void copy_vertex_group_names_from_object(const struct Object &object);
+  const blender::Map<std::string, int> &vertex_group_names() const;
 
   const Mesh *get_for_read() const;
   Mesh *get_for_write();
@@ -381,6 +391,8 @@ class MeshComponent : public GeometryComponent {
 
   blender::Set<std::string> attribute_names() const final;
   bool is_empty() const final;
+  bool owns_direct_data() const final;
+  void ensure_owns_direct_data() final;
 
   static constexpr inline GeometryComponentType static_type = GeometryComponentType::Mesh;
 };
@@ -423,6 +435,8 @@ class PointCloudComponent : public GeometryComponent {
 
   blender::Set<std::string> attribute_names() const final;
   bool is_empty() const final;
+  bool owns_direct_data() const final;
+  void ensure_owns_direct_data() final;
 
   static constexpr inline GeometryComponentType static_type = GeometryComponentType::PointCloud;
 };
@@ -443,6 +457,9 @@ class InstancesComponent : public GeometryComponent {
   void add_instance(Object *object, blender::float4x4 transform, const int id = -1);
   void add_instance(Collection *collection, blender::float4x4 transform, const int id = -1);
   void add_instance(InstancedData data, blender::float4x4 transform, const int id = -1);
+  void add_instances(const InstancesComponent &other);
+  void add_instances(const InstancesComponent &other, const blender::float4x4 &transform);
+  void reserve(const int amount);
 
   blender::Span<InstancedData> instanced_data() const;
   blender::Span<blender::float4x4> transforms() const;
@@ -474,5 +491,8 @@ class VolumeComponent : public GeometryComponent {
   const Volume *get_for_read() const;
   Volume *get_for_write();
 
+  bool owns_direct_data() const final;
+  void ensure_owns_direct_data() final;
+
   static constexpr inline GeometryComponentType static_type = GeometryComponentType::Volume;
 };
@@ -32,6 +32,7 @@ struct BMeshFromMeshParams;
 struct BMeshToMeshParams;
 struct BoundBox;
 struct CustomData;
+struct CustomDataHash;
 struct CustomData_MeshMasks;
 struct Depsgraph;
 struct EdgeHash;
@@ -192,6 +193,9 @@ void BKE_mesh_edges_set_draw_render(struct Mesh *me);
 
 const char *BKE_mesh_cmp(struct Mesh *me1, struct Mesh *me2, float thresh);
 
+bool BKE_mesh_hash_add_content(struct CustomDataHash *hash, const struct Mesh *mesh);
+size_t BKE_mesh_memory_size(const struct Mesh *mesh);
+
 struct BoundBox *BKE_mesh_boundbox_get(struct Object *ob);
 
 void BKE_mesh_texspace_calc(struct Mesh *me);
@@ -190,6 +190,9 @@ typedef struct Subdiv {
     /* Indexed by base face index, element indicates total number of ptex
      * faces created for preceding base faces. */
     int *face_ptex_offset;
+    /* Copy of the mesh topology the topology refiner was last verified against, used to avoid
+     * comparing the refiner with a new converter when the mesh topology did not change. */
+    struct SubdivMeshTopology *mesh_topology;
   } cache_;
 } Subdiv;
 
@@ -76,6 +76,11 @@ fn::GSpan ReadAttribute::get_span() const
   return fn::GSpan(cpp_type_, array_buffer_, size_);
 }
 
+fn::GVSpan ReadAttribute::get_virtual_span() const
+{
+  return fn::GVSpan(this->get_span());
+}
+
 void ReadAttribute::initialize_span() const
 {
   const int element_size = cpp_type_.size();
@@ -405,6 +410,11 @@ class ConstantReadAttribute final : public ReadAttribute {
     this->cpp_type_.copy_to_uninitialized(value_, r_value);
   }
 
+  fn::GVSpan get_virtual_span() const override
+  {
+    return fn::GVSpan::FromSingle(cpp_type_, value_, size_);
+  }
+
   void initialize_span() const override
   {
     const int element_size = cpp_type_.size();
@@ -5189,3 +5189,91 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
 
   CustomData_update_typemap(data);
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Content Hash
+ *
+ * Modifiers keep results of expensive evaluations around, identified by a hash of their inputs.
+ * Everything that can change the result is hashed, the layer settings as well as the data.
+ * \{ */
+
+void CustomData_hash_init(CustomDataHash *hash)
+{
+  for (int i = 0; i < ARRAY_SIZE(hash->mm2); i++) {
+    BLI_hash_mm2a_init(&hash->mm2[i], (uint32_t)i * 0x9e3779b9);
+  }
+}
+
+void CustomData_hash_add(CustomDataHash *hash, const void *data, size_t len)
+{
+  for (int i = 0; i < ARRAY_SIZE(hash->mm2); i++) {
+    BLI_hash_mm2a_add(&hash->mm2[i], (const unsigned char *)data, len);
+  }
+}
+
+void CustomData_hash_add_int(CustomDataHash *hash, int value)
+{
+  for (int i = 0; i < ARRAY_SIZE(hash->mm2); i++) {
+    BLI_hash_mm2a_add_int(&hash->mm2[i], value);
+  }
+}
+
+void CustomData_hash_end(CustomDataHash *hash, uint64_t r_hash[2])
+{
+  r_hash[0] = ((uint64_t)BLI_hash_mm2a_end(&hash->mm2[0]) << 32) |
+              BLI_hash_mm2a_end(&hash->mm2[1]);
+  r_hash[1] = ((uint64_t)BLI_hash_mm2a_end(&hash->mm2[2]) << 32) |
+              BLI_hash_mm2a_end(&hash->mm2[3]);
+}
+
+/**
+ * Add the layers and their data to the hash. Returns false when the data can't be hashed,
+ * because the elements of a layer point to more data.
+ */
+bool CustomData_hash_add_layers(CustomDataHash *hash, const CustomData *data, const int totelem)
+{
+  CustomData_hash_add_int(hash, totelem);
+  CustomData_hash_add_int(hash, data->totlayer);
+  for (int i = 0; i < data->totlayer; i++) {
+    const CustomDataLayer *layer = &data->layers[i];
+    CustomData_hash_add_int(hash, layer->type);
+    CustomData_hash_add_int(hash, layer->flag);
+    CustomData_hash_add_int(hash, layer->active);
+    CustomData_hash_add_int(hash, layer->active_rnd);
+    CustomData_hash_add_int(hash, layer->active_clone);
+    CustomData_hash_add_int(hash, layer->active_mask);
+    CustomData_hash_add(hash, layer->name, strlen(layer->name) + 1);
+    if (layer->data == NULL) {
+      continue;
+    }
+    if (layer->type == CD_MDEFORMVERT) {
+      /* The weights are stored in separate arrays. */
+      const MDeformVert *dvert = layer->data;
+      for (int j = 0; j < totelem; j++) {
+        CustomData_hash_add_int(hash, dvert[j].totweight);
+        if (dvert[j].dw != NULL) {
+          CustomData_hash_add(hash, dvert[j].dw, sizeof(*dvert[j].dw) * dvert[j].totweight);
+        }
+      }
+    }
+    else if (ELEM(layer->type, CD_MDISPS, CD_GRID_PAINT_MASK, CD_BM_ELEM_PYPTR)) {
+      return false;
+    }
+    else {
+      CustomData_hash_add(hash, layer->data, (size_t)CustomData_sizeof(layer->type) * totelem);
+    }
+  }
+  return true;
+}
+
+/** Memory used by the arrays of the layers, not including data they point to. */
+size_t CustomData_layers_memory_size(const CustomData *data, const int totelem)
+{
+  size_t size = 0;
+  for (int i = 0; i < data->totlayer; i++) {
+    size += (size_t)CustomData_sizeof(data->layers[i].type) * totelem;
+  }
+  return size;
+}
+
+/** \} */
@@ -90,6 +90,16 @@ bool GeometryComponent::is_empty() const
   return false;
 }
 
+bool GeometryComponent::owns_direct_data() const
+{
+  return true;
+}
+
+void GeometryComponent::ensure_owns_direct_data()
+{
+  BLI_assert(this->is_mutable());
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -151,6 +161,22 @@ void GeometrySet::add(const GeometryComponent &component)
   components_.add_new(component.type(), std::move(component_ptr));
 }
 
+/* Make sure the geometry set does not reference data that it does not own, so that it can outlive
+ * the data it was created from. Shared components are copied before they are modified. */
+void GeometrySet::ensure_owns_direct_data()
+{
+  Vector<GeometryComponentType> types_to_own;
+  for (GeometryComponentPtr &ptr : components_.values()) {
+    if (!ptr->owns_direct_data()) {
+      types_to_own.append(ptr->type());
+    }
+  }
+  for (const GeometryComponentType type : types_to_own) {
+    GeometryComponent &component = this->get_component_for_write(type);
+    component.ensure_owns_direct_data();
+  }
+}
+
 void GeometrySet::compute_boundbox_without_instances(float3 *r_min, float3 *r_max) const
 {
   const PointCloud *pointcloud = this->get_pointcloud_for_read();
@@ -377,6 +403,11 @@ void MeshComponent::copy_vertex_group_names_from_object(const Object &object)
   }
 }
 
+const blender::Map<std::string, int> &MeshComponent::vertex_group_names() const
+{
+  return vertex_group_names_;
+}
+
 /* Get the mesh from this component. This method can be used by multiple threads at the same
  * time. Therefore, the returned mesh should not be modified. No ownership is transferred. */
 const Mesh *MeshComponent::get_for_read() const
@@ -401,6 +432,20 @@ bool MeshComponent::is_empty() const
   return mesh_ == nullptr;
 }
 
+bool MeshComponent::owns_direct_data() const
+{
+  return mesh_ == nullptr || ownership_ == GeometryOwnershipType::Owned;
+}
+
+void MeshComponent::ensure_owns_direct_data()
+{
+  BLI_assert(this->is_mutable());
+  if (mesh_ != nullptr && ownership_ != GeometryOwnershipType::Owned) {
+    mesh_ = BKE_mesh_copy_for_eval(mesh_, false);
+    ownership_ = GeometryOwnershipType::Owned;
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -487,6 +532,20 @@ bool PointCloudComponent::is_empty() const
   return pointcloud_ == nullptr;
 }
 
+bool PointCloudComponent::owns_direct_data() const
+{
+  return pointcloud_ == nullptr || ownership_ == GeometryOwnershipType::Owned;
+}
+
+void PointCloudComponent::ensure_owns_direct_data()
+{
+  BLI_assert(this->is_mutable());
+  if (pointcloud_ != nullptr && ownership_ != GeometryOwnershipType::Owned) {
+    pointcloud_ = BKE_pointcloud_copy_for_eval(pointcloud_, false);
+    ownership_ = GeometryOwnershipType::Owned;
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -501,6 +560,7 @@ GeometryComponent *InstancesComponent::copy() const
 {
   InstancesComponent *new_component = new InstancesComponent();
   new_component->transforms_ = transforms_;
+  new_component->ids_ = ids_;
   new_component->instanced_data_ = instanced_data_;
   return new_component;
 }
@@ -509,6 +569,7 @@ void InstancesComponent::clear()
 {
   instanced_data_.clear();
   transforms_.clear();
+  ids_.clear();
 }
 
 void InstancesComponent::add_instance(Object *object, float4x4 transform, const int id)
@@ -534,6 +595,32 @@ void InstancesComponent::add_instance(InstancedData data, float4x4 transform, co
   ids_.append(id);
 }
 
+/* Add all instances of the other component, without realizing or copying the instanced data. */
+void InstancesComponent::add_instances(const InstancesComponent &other)
+{
+  instanced_data_.extend(other.instanced_data_);
+  transforms_.extend(other.transforms_);
+  ids_.extend(other.ids_);
+}
+
+/* Add all instances of the other component, with the given transform applied on top of their own
+ * transforms. This allows nesting instances without realizing them. */
+void InstancesComponent::add_instances(const InstancesComponent &other, const float4x4 &transform)
+{
+  const int64_t start = transforms_.size();
+  this->add_instances(other);
+  for (float4x4 &instance_transform : transforms_.as_mutable_span().drop_front(start)) {
+    instance_transform = transform * instance_transform;
+  }
+}
+
+void InstancesComponent::reserve(const int amount)
+{
+  instanced_data_.reserve(amount);
+  transforms_.reserve(amount);
+  ids_.reserve(amount);
+}
+
 Span<InstancedData> InstancesComponent::instanced_data() const
 {
   return instanced_data_;
@@ -645,6 +732,20 @@ Volume *VolumeComponent::get_for_write()
   return volume_;
 }
 
+bool VolumeComponent::owns_direct_data() const
+{
+  return volume_ == nullptr || ownership_ == GeometryOwnershipType::Owned;
+}
+
+void VolumeComponent::ensure_owns_direct_data()
+{
+  BLI_assert(this->is_mutable());
+  if (volume_ != nullptr && ownership_ != GeometryOwnershipType::Owned) {
+    volume_ = BKE_volume_copy_for_eval(volume_, false);
+    ownership_ = GeometryOwnershipType::Owned;
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -47,6 +47,7 @@
 #include "BLT_translation.h"
 
 #include "BKE_anim_data.h"
+#include "BKE_customdata.h"
 #include "BKE_deform.h"
 #include "BKE_editmesh.h"
 #include "BKE_global.h"
@@ -637,6 +638,39 @@ const char *BKE_mesh_cmp(Mesh *me1, Mesh *me2, float thresh)
   return NULL;
 }
 
+/**
+ * Add everything that defines the mesh to the hash, see #CustomDataHash. Returns false when the
+ * mesh can't be hashed, then it has to be treated as changed.
+ */
+bool BKE_mesh_hash_add_content(CustomDataHash *hash, const Mesh *mesh)
+{
+  if (mesh->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+    return false;
+  }
+  if (!CustomData_hash_add_layers(hash, &mesh->vdata, mesh->totvert) ||
+      !CustomData_hash_add_layers(hash, &mesh->edata, mesh->totedge) ||
+      !CustomData_hash_add_layers(hash, &mesh->ldata, mesh->totloop) ||
+      !CustomData_hash_add_layers(hash, &mesh->pdata, mesh->totpoly)) {
+    return false;
+  }
+  CustomData_hash_add_int(hash, mesh->flag);
+  CustomData_hash_add(hash, &mesh->smoothresh, sizeof(mesh->smoothresh));
+  CustomData_hash_add_int(hash, mesh->totcol);
+  if (mesh->totcol > 0) {
+    CustomData_hash_add(hash, mesh->mat, sizeof(*mesh->mat) * mesh->totcol);
+  }
+  return true;
+}
+
+/** Memory used by the geometry of the mesh, not including caches. */
+size_t BKE_mesh_memory_size(const Mesh *mesh)
+{
+  return sizeof(Mesh) + CustomData_layers_memory_size(&mesh->vdata, mesh->totvert) +
+         CustomData_layers_memory_size(&mesh->edata, mesh->totedge) +
+         CustomData_layers_memory_size(&mesh->ldata, mesh->totloop) +
+         CustomData_layers_memory_size(&mesh->pdata, mesh->totpoly);
+}
+
 static void mesh_ensure_tessellation_customdata(Mesh *me)
 {
   if (UNLIKELY((me->totface != 0) && (me->totpoly == 0))) {
@@ -27,8 +27,11 @@
 #include "DNA_meshdata_types.h"
 #include "DNA_modifier_types.h"
 
+#include "BLI_math_vector.h"
 #include "BLI_utildefines.h"
 
+#include "BKE_customdata.h"
+
 #include "MEM_guardedalloc.h"
 
 #include "subdiv_converter.h"
@@ -173,14 +176,131 @@ Subdiv *BKE_subdiv_update_from_converter(Subdiv *subdiv,
   return BKE_subdiv_new_from_converter(settings, converter);
 }
 
+/* Topology related data of the mesh, only fields which are used by the mesh converter are
+ * compared. This allows to skip creation of the converter and comparison with the topology
+ * refiner when only vertex positions changed, which is the common case for animated meshes. */
+typedef struct SubdivMeshTopology {
+  SubdivSettings settings;
+  int totvert, totedge, totpoly, totloop;
+  MEdge *medge;
+  MPoly *mpoly;
+  MLoop *mloop;
+  int num_uv_layers;
+  MLoopUV **mloopuv;
+} SubdivMeshTopology;
+
+static void subdiv_mesh_topology_free(SubdivMeshTopology *topology)
+{
+  MEM_SAFE_FREE(topology->medge);
+  MEM_SAFE_FREE(topology->mpoly);
+  MEM_SAFE_FREE(topology->mloop);
+  for (int layer_index = 0; layer_index < topology->num_uv_layers; layer_index++) {
+    MEM_SAFE_FREE(topology->mloopuv[layer_index]);
+  }
+  MEM_SAFE_FREE(topology->mloopuv);
+  MEM_freeN(topology);
+}
+
+static SubdivMeshTopology *subdiv_mesh_topology_new(const SubdivSettings *settings,
+                                                    const Mesh *mesh)
+{
+  SubdivMeshTopology *topology = MEM_callocN(sizeof(SubdivMeshTopology), __func__);
+  topology->settings = *settings;
+  topology->totvert = mesh->totvert;
+  topology->totedge = mesh->totedge;
+  topology->totpoly = mesh->totpoly;
+  topology->totloop = mesh->totloop;
+  topology->medge = MEM_dupallocN(mesh->medge);
+  topology->mpoly = MEM_dupallocN(mesh->mpoly);
+  topology->mloop = MEM_dupallocN(mesh->mloop);
+  topology->num_uv_layers = CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV);
+  if (topology->num_uv_layers != 0) {
+    topology->mloopuv = MEM_calloc_arrayN(
+        topology->num_uv_layers, sizeof(MLoopUV *), "subdiv topology uv layers");
+    for (int layer_index = 0; layer_index < topology->num_uv_layers; layer_index++) {
+      topology->mloopuv[layer_index] = MEM_dupallocN(
+          CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index));
+    }
+  }
+  return topology;
+}
+
+static bool subdiv_mesh_topology_equal(const SubdivMeshTopology *topology,
+                                       const SubdivSettings *settings,
+                                       const Mesh *mesh)
+{
+  if (!BKE_subdiv_settings_equal(&topology->settings, settings) ||
+      topology->settings.use_creases != settings->use_creases) {
+    return false;
+  }
+  if (topology->totvert != mesh->totvert || topology->totedge != mesh->totedge ||
+      topology->totpoly != mesh->totpoly || topology->totloop != mesh->totloop) {
+    return false;
+  }
+  for (int edge_index = 0; edge_index < mesh->totedge; edge_index++) {
+    const MEdge *edge_a = &topology->medge[edge_index];
+    const MEdge *edge_b = &mesh->medge[edge_index];
+    if (edge_a->v1 != edge_b->v1 || edge_a->v2 != edge_b->v2) {
+      return false;
+    }
+    if (settings->use_creases && edge_a->crease != edge_b->crease) {
+      return false;
+    }
+  }
+  for (int poly_index = 0; poly_index < mesh->totpoly; poly_index++) {
+    const MPoly *poly_a = &topology->mpoly[poly_index];
+    const MPoly *poly_b = &mesh->mpoly[poly_index];
+    if (poly_a->loopstart != poly_b->loopstart || poly_a->totloop != poly_b->totloop) {
+      return false;
+    }
+  }
+  if (mesh->totloop != 0 && memcmp(topology->mloop, mesh->mloop, sizeof(MLoop) * mesh->totloop)) {
+    return false;
+  }
+  /* UV islands are detected from the UV coordinates, so any change of those might change the
+   * face-varying topology. */
+  if (topology->num_uv_layers != CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV)) {
+    return false;
+  }
+  for (int layer_index = 0; layer_index < topology->num_uv_layers; layer_index++) {
+    const MLoopUV *mloopuv_a = topology->mloopuv[layer_index];
+    const MLoopUV *mloopuv_b = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+    for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+      if (!equals_v2v2(mloopuv_a[loop_index].uv, mloopuv_b[loop_index].uv)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
                                     const SubdivSettings *settings,
                                     const Mesh *mesh)
 {
+  if (subdiv != NULL && subdiv->topology_refiner != NULL &&
+      subdiv->cache_.mesh_topology != NULL) {
+    BKE_subdiv_stats_begin(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_COMPARE);
+    const bool is_topology_equal = subdiv_mesh_topology_equal(
+        subdiv->cache_.mesh_topology, settings, mesh);
+    BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_TOPOLOGY_COMPARE);
+    if (is_topology_equal) {
+      return subdiv;
+    }
+  }
+  /* Only keep a copy of the topology when the descriptor is being re-used across updates, there
+   * is no need for it when the caller creates a new descriptor every time. */
+  const bool use_mesh_topology = (subdiv != NULL);
   OpenSubdiv_Converter converter;
   BKE_subdiv_converter_init_for_mesh(&converter, settings, mesh);
   subdiv = BKE_subdiv_update_from_converter(subdiv, settings, &converter);
   BKE_subdiv_converter_free(&converter);
+  if (subdiv != NULL && use_mesh_topology) {
+    if (subdiv->cache_.mesh_topology != NULL) {
+      subdiv_mesh_topology_free(subdiv->cache_.mesh_topology);
+    }
+    subdiv->cache_.mesh_topology = subdiv_mesh_topology_new(settings, mesh);
+  }
   return subdiv;
 }
 
@@ -198,6 +318,9 @@ void BKE_subdiv_free(Subdiv *subdiv)
   if (subdiv->cache_.face_ptex_offset != NULL) {
     MEM_freeN(subdiv->cache_.face_ptex_offset);
   }
+  if (subdiv->cache_.mesh_topology != NULL) {
+    subdiv_mesh_topology_free(subdiv->cache_.mesh_topology);
+  }
   MEM_freeN(subdiv);
 }
 
@@ -65,13 +65,26 @@ static void set_coarse_positions(Subdiv *subdiv,
                                  const Mesh *mesh,
                                  const float (*coarse_vertex_cos)[3])
 {
+  OpenSubdiv_TopologyRefiner *topology_refiner = subdiv->topology_refiner;
+  OpenSubdiv_Evaluator *evaluator = subdiv->evaluator;
   const MVert *mvert = mesh->mvert;
   const MLoop *mloop = mesh->mloop;
   const MPoly *mpoly = mesh->mpoly;
+  const int num_manifold_vertices = topology_refiner->getNumVertices(topology_refiner);
+  /* When every vertex is used by a face the OpenSubdiv vertices match the mesh ones, and the
+   * positions can be passed in a single call. This is the common case for meshes without loose
+   * geometry. */
+  if (num_manifold_vertices == mesh->totvert) {
+    if (coarse_vertex_cos != NULL) {
+      evaluator->setCoarsePositions(evaluator, coarse_vertex_cos[0], 0, mesh->totvert);
+    }
+    else {
+      evaluator->setCoarsePositionsFromBuffer(
+          evaluator, mvert, offsetof(MVert, co), sizeof(MVert), 0, mesh->totvert);
+    }
+    return;
+  }
   /* Mark vertices which needs new coordinates. */
-  /* TODO(sergey): This is annoying to calculate this on every update,
-   * maybe it's better to cache this mapping. Or make it possible to have
-   * OpenSubdiv's vertices match mesh ones? */
   BLI_bitmap *vertex_used_map = BLI_BITMAP_NEW(mesh->totvert, "vert used map");
   for (int poly_index = 0; poly_index < mesh->totpoly; poly_index++) {
     const MPoly *poly = &mpoly[poly_index];
@@ -80,11 +93,15 @@ static void set_coarse_positions(Subdiv *subdiv,
       BLI_BITMAP_ENABLE(vertex_used_map, loop->v);
     }
   }
-  for (int vertex_index = 0, manifold_vertex_index = 0; vertex_index < mesh->totvert;
-       vertex_index++) {
+  /* Gather coordinates of used vertices, so they are passed to the evaluator at once. */
+  float(*manifold_vertex_cos)[3] = MEM_malloc_arrayN(
+      num_manifold_vertices, sizeof(float[3]), "manifold vertex cos");
+  int manifold_vertex_index = 0;
+  for (int vertex_index = 0; vertex_index < mesh->totvert; vertex_index++) {
     if (!BLI_BITMAP_TEST_BOOL(vertex_used_map, vertex_index)) {
       continue;
     }
+    BLI_assert(manifold_vertex_index < num_manifold_vertices);
     const float *vertex_co;
     if (coarse_vertex_cos != NULL) {
       vertex_co = coarse_vertex_cos[vertex_index];
@@ -93,9 +110,12 @@ static void set_coarse_positions(Subdiv *subdiv,
       const MVert *vertex = &mvert[vertex_index];
       vertex_co = vertex->co;
     }
-    subdiv->evaluator->setCoarsePositions(subdiv->evaluator, vertex_co, manifold_vertex_index, 1);
+    copy_v3_v3(manifold_vertex_cos[manifold_vertex_index], vertex_co);
     manifold_vertex_index++;
   }
+  BLI_assert(manifold_vertex_index == num_manifold_vertices);
+  evaluator->setCoarsePositions(evaluator, manifold_vertex_cos[0], 0, manifold_vertex_index);
+  MEM_freeN(manifold_vertex_cos);
   MEM_freeN(vertex_used_map);
 }
 
@@ -106,6 +126,9 @@ static void set_face_varying_data_from_uv(Subdiv *subdiv,
   OpenSubdiv_TopologyRefiner *topology_refiner = subdiv->topology_refiner;
   OpenSubdiv_Evaluator *evaluator = subdiv->evaluator;
   const int num_faces = topology_refiner->getNumFaces(topology_refiner);
+  const int num_fvar_values = topology_refiner->getNumFVarValues(topology_refiner, layer_index);
+  /* Scatter UVs to their face-varying values, so they are passed to the evaluator at once. */
+  float(*fvar_data)[2] = MEM_malloc_arrayN(num_fvar_values, sizeof(float[2]), "fvar uv data");
   const MLoopUV *mluv = mloopuv;
   /* TODO(sergey): OpenSubdiv's C-API converter can change winding of
    * loops of a face, need to watch for that, to prevent wrong UVs assigned.
@@ -116,9 +139,12 @@ static void set_face_varying_data_from_uv(Subdiv *subdiv,
     const int *uv_indices = topology_refiner->getFaceFVarValueIndices(
         topology_refiner, face_index, layer_index);
     for (int vertex_index = 0; vertex_index < num_face_vertices; vertex_index++, mluv++) {
-      evaluator->setFaceVaryingData(evaluator, layer_index, mluv->uv, uv_indices[vertex_index], 1);
+      BLI_assert(uv_indices[vertex_index] < num_fvar_values);
+      copy_v2_v2(fvar_data[uv_indices[vertex_index]], mluv->uv);
     }
   }
+  evaluator->setFaceVaryingData(evaluator, layer_index, fvar_data[0], 0, num_fvar_values);
+  MEM_freeN(fvar_data);
 }
 
 bool BKE_subdiv_eval_begin_from_mesh(Subdiv *subdiv,
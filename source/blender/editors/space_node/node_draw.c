@@ -25,7 +25,9 @@
 #include "DNA_light_types.h"
 #include "DNA_linestyle_types.h"
 #include "DNA_material_types.h"
+#include "DNA_modifier_types.h"
 #include "DNA_node_types.h"
+#include "DNA_object_types.h"
 #include "DNA_screen_types.h"
 #include "DNA_space_types.h"
 #include "DNA_texture_types.h"
@@ -39,7 +41,9 @@
 #include "BKE_context.h"
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
+#include "BKE_modifier.h"
 #include "BKE_node.h"
+#include "BKE_object.h"
 
 #include "DEG_depsgraph.h"
 
@@ -66,6 +70,8 @@
 
 #include "RNA_access.h"
 
+#include "MOD_nodes.h"
+
 #include "node_intern.h" /* own include */
 
 #ifdef WITH_COMPOSITOR
@@ -1117,6 +1123,97 @@ void node_draw_sockets(const View2D *v2d,
   GPU_blend(GPU_BLEND_NONE);
 }
 
+/**
+ * Statistics recorded for the node by the last evaluation of the nodes modifier that uses the
+ * edited geometry node tree, or null when there is none.
+ */
+static const NodesModifierNodeProfile *node_geometry_profile_get(const bContext *C,
+                                                                 const SpaceNode *snode,
+                                                                 bNodeInstanceKey key)
+{
+  if (snode->nodetree == NULL || snode->nodetree->type != NTREE_GEOMETRY) {
+    return NULL;
+  }
+  if (snode->id == NULL || GS(snode->id->name) != ID_OB) {
+    return NULL;
+  }
+  Object *ob = (Object *)snode->id;
+
+  /* Prefer the active modifier, like the node editor does to find the tree to edit. */
+  ModifierData *md = BKE_object_active_modifier(ob);
+  if (md == NULL || md->type != eModifierType_Nodes ||
+      ((NodesModifierData *)md)->node_group != snode->nodetree) {
+    md = NULL;
+    LISTBASE_FOREACH (ModifierData *, md_iter, &ob->modifiers) {
+      if (md_iter->type == eModifierType_Nodes &&
+          ((NodesModifierData *)md_iter)->node_group == snode->nodetree) {
+        md = md_iter;
+        break;
+      }
+    }
+  }
+  if (md == NULL) {
+    return NULL;
+  }
+
+  Depsgraph *depsgraph = CTX_data_depsgraph_pointer(C);
+  if (depsgraph == NULL) {
+    return NULL;
+  }
+  const ModifierData *md_eval = BKE_modifier_get_evaluated(depsgraph, ob, md);
+  if (md_eval == NULL) {
+    return NULL;
+  }
+  return MOD_nodes_profile_lookup((const NodesModifierData *)md_eval, key.value);
+}
+
+/* Draw the time, output size and memory of the last evaluation above the node header. */
+static void node_draw_profile(const bContext *C,
+                              const SpaceNode *snode,
+                              bNode *node,
+                              bNodeInstanceKey key)
+{
+  const NodesModifierNodeProfile *profile = node_geometry_profile_get(C, snode, key);
+  if (profile == NULL) {
+    return;
+  }
+
+  char info[128];
+  int len = BLI_snprintf_rlen(info, sizeof(info), "%.2f ms", profile->time * 1000.0);
+  if (profile->elements > 0) {
+    char elements_str[16];
+    BLI_str_format_int_grouped(elements_str, (int)MIN2(profile->elements, INT_MAX));
+    len += BLI_snprintf_rlen(info + len, sizeof(info) - len, " | %s", elements_str);
+  }
+  if (profile->memory > 0) {
+    char memory_str[15];
+    BLI_str_format_byte_unit(memory_str, profile->memory, false);
+    len += BLI_snprintf_rlen(info + len, sizeof(info) - len, " | %s", memory_str);
+  }
+  if (profile->is_cached) {
+    BLI_snprintf(info + len, sizeof(info) - len, " (%s)", IFACE_("cached"));
+  }
+
+  const rctf *rct = &node->totr;
+  uiBut *but = uiDefBut(node->block,
+                        UI_BTYPE_LABEL,
+                        0,
+                        info,
+                        (int)rct->xmin,
+                        (int)rct->ymax,
+                        (short)BLI_rctf_size_x(rct),
+                        (short)NODE_DY,
+                        NULL,
+                        0,
+                        0,
+                        0,
+                        0,
+                        "");
+  if (profile->is_cached) {
+    UI_but_flag_enable(but, UI_BUT_INACTIVE);
+  }
+}
+
 static void node_draw_basis(const bContext *C,
                             const View2D *v2d,
                             const SpaceNode *snode,
@@ -1360,6 +1457,10 @@ static void node_draw_basis(const bContext *C,
     }
   }
 
+  if (snode->flag & SNODE_SHOW_NODE_PROFILE) {
+    node_draw_profile(C, snode, node, key);
+  }
+
   UI_block_end(C, node->block);
   UI_block_draw(C, node->block);
   node->block = NULL;
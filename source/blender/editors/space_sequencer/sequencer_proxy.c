@@ -25,8 +25,14 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_timecode.h"
 
+#include "PIL_time.h"
+
+#include "atomic_ops.h"
+
 #include "DNA_scene_types.h"
 
 #include "BKE_context.h"
@@ -71,22 +77,101 @@ static void proxy_freejob(void *pjv)
   MEM_freeN(pj);
 }
 
+/* Strips are built concurrently, each worker takes the next context from the queue. */
+typedef struct ProxyJobQueue {
+  SpinLock spin;
+  LinkData *next_link;
+  int next_index;
+
+  short *stop;
+  /* Progress of every context, summed up by the job thread. */
+  float *progress;
+  unsigned int running_num;
+} ProxyJobQueue;
+
+static struct SeqIndexBuildContext *proxy_queue_next_context(ProxyJobQueue *queue, int *r_index)
+{
+  struct SeqIndexBuildContext *context = NULL;
+
+  BLI_spin_lock(&queue->spin);
+  if (!*queue->stop && !G.is_break && queue->next_link) {
+    context = queue->next_link->data;
+    *r_index = queue->next_index;
+    queue->next_link = queue->next_link->next;
+    queue->next_index++;
+  }
+  BLI_spin_unlock(&queue->spin);
+
+  return context;
+}
+
+static void proxy_task_func(TaskPool *__restrict pool, void *UNUSED(task_data))
+{
+  ProxyJobQueue *queue = (ProxyJobQueue *)BLI_task_pool_user_data(pool);
+  struct SeqIndexBuildContext *context;
+  int index;
+
+  while ((context = proxy_queue_next_context(queue, &index))) {
+    short do_update = false;
+
+    SEQ_proxy_rebuild(context, queue->stop, &do_update, &queue->progress[index]);
+
+    if (!*queue->stop) {
+      queue->progress[index] = 1.0f;
+    }
+  }
+
+  atomic_sub_and_fetch_u(&queue->running_num, 1);
+}
+
 /* Only this runs inside thread. */
 static void proxy_startjob(void *pjv, short *stop, short *do_update, float *progress)
 {
   ProxyJob *pj = pjv;
-  LinkData *link;
+  const int contexts_num = BLI_listbase_count(&pj->queue);
 
-  for (link = pj->queue.first; link; link = link->next) {
-    struct SeqIndexBuildContext *context = link->data;
+  if (contexts_num == 0) {
+    return;
+  }
 
-    SEQ_proxy_rebuild(context, stop, do_update, progress);
+  ProxyJobQueue queue;
+  BLI_spin_init(&queue.spin);
+  queue.next_link = pj->queue.first;
+  queue.next_index = 0;
+  queue.stop = stop;
+  queue.progress = MEM_callocN(sizeof(float) * contexts_num, "proxy job progress");
+  queue.running_num = MIN2(BLI_task_scheduler_num_threads(), contexts_num);
+
+  /* Background pool, so building starts right away and this thread can report progress. */
+  TaskPool *task_pool = BLI_task_pool_create_background(&queue, TASK_PRIORITY_LOW);
+  const int tot_thread = queue.running_num;
+  for (int i = 0; i < tot_thread; i++) {
+    BLI_task_pool_push(task_pool, proxy_task_func, NULL, false, NULL);
+  }
+
+  while (atomic_add_and_fetch_u(&queue.running_num, 0) != 0) {
+    PIL_sleep_ms(50);
 
-    if (*stop) {
-      pj->stop = 1;
-      fprintf(stderr, "Canceling proxy rebuild on users request...\n");
-      break;
+    float progress_sum = 0.0f;
+    for (int i = 0; i < contexts_num; i++) {
+      progress_sum += queue.progress[i];
     }
+    const float next_progress = progress_sum / contexts_num;
+    if (*progress != next_progress) {
+      *progress = next_progress;
+      *do_update = true;
+    }
+  }
+
+  BLI_task_pool_work_and_wait(task_pool);
+  BLI_task_pool_free(task_pool);
+
+  BLI_spin_end(&queue.spin);
+  MEM_freeN(queue.progress);
+
+  if (*stop) {
+    pj->stop = 1;
+    fprintf(stderr, "Canceling proxy rebuild on users request...\n");
   }
 }
 
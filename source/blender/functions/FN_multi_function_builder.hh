@@ -28,6 +28,51 @@
 
 namespace blender::fn {
 
+namespace devirtualize {
+
+/* Accessors that tell the compiler how the values of a #VSpan are stored, so that the loops in
+ * the functions below can be optimized (e.g. vectorized) for that case. */
+
+template<typename T> struct SingleValue {
+  const T &value;
+
+  const T &operator[](const int64_t UNUSED(index)) const
+  {
+    return value;
+  }
+};
+
+template<typename T> struct ArrayValues {
+  const T *data;
+
+  const T &operator[](const int64_t index) const
+  {
+    return data[index];
+  }
+};
+
+template<typename T> inline bool is_devirtualizable(const VSpan<T> &span)
+{
+  return span.is_single_element() || span.is_full_array();
+}
+
+/**
+ * Call the function with an accessor that matches how the values of the span are stored. The span
+ * is expected to be #is_devirtualizable.
+ */
+template<typename T, typename Func>
+inline void with_accessor(const VSpan<T> &span, const Func &func)
+{
+  if (span.is_single_element()) {
+    func(SingleValue<T>{span.as_single_element()});
+  }
+  else {
+    func(ArrayValues<T>{span.as_full_array().data()});
+  }
+}
+
+}  // namespace devirtualize
+
 /**
  * Generates a multi-function with the following parameters:
  * 1. single input (SI) of type In1
@@ -58,6 +103,16 @@ template<typename In1, typename Out1> class CustomMF_SI_SO : public MultiFunctio
   template<typename ElementFuncT> static FunctionT create_function(ElementFuncT element_fn)
   {
     return [=](IndexMask mask, VSpan<In1> in1, MutableSpan<Out1> out1) {
+      if (mask.is_range() && devirtualize::is_devirtualizable(in1)) {
+        const IndexRange range = mask.as_range();
+        Out1 *out1_data = out1.data();
+        devirtualize::with_accessor(in1, [&](const auto in1) {
+          for (int64_t i = range.start(); i < range.one_after_last(); i++) {
+            new (static_cast<void *>(out1_data + i)) Out1(element_fn(in1[i]));
+          }
+        });
+        return;
+      }
       mask.foreach_index(
           [&](int i) { new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i])); });
     };
@@ -101,6 +156,19 @@ class CustomMF_SI_SI_SO : public MultiFunction {
   template<typename ElementFuncT> static FunctionT create_function(ElementFuncT element_fn)
   {
     return [=](IndexMask mask, VSpan<In1> in1, VSpan<In2> in2, MutableSpan<Out1> out1) {
+      if (mask.is_range() && devirtualize::is_devirtualizable(in1) &&
+          devirtualize::is_devirtualizable(in2)) {
+        const IndexRange range = mask.as_range();
+        Out1 *out1_data = out1.data();
+        devirtualize::with_accessor(in1, [&](const auto in1) {
+          devirtualize::with_accessor(in2, [&](const auto in2) {
+            for (int64_t i = range.start(); i < range.one_after_last(); i++) {
+              new (static_cast<void *>(out1_data + i)) Out1(element_fn(in1[i], in2[i]));
+            }
+          });
+        });
+        return;
+      }
       mask.foreach_index(
           [&](int i) { new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i], in2[i])); });
     };
@@ -152,6 +220,22 @@ class CustomMF_SI_SI_SI_SO : public MultiFunction {
                VSpan<In2> in2,
                VSpan<In3> in3,
                MutableSpan<Out1> out1) {
+      if (mask.is_range() && devirtualize::is_devirtualizable(in1) &&
+          devirtualize::is_devirtualizable(in2) && devirtualize::is_devirtualizable(in3)) {
+        const IndexRange range = mask.as_range();
+        Out1 *out1_data = out1.data();
+        devirtualize::with_accessor(in1, [&](const auto in1) {
+          devirtualize::with_accessor(in2, [&](const auto in2) {
+            devirtualize::with_accessor(in3, [&](const auto in3) {
+              for (int64_t i = range.start(); i < range.one_after_last(); i++) {
+                new (static_cast<void *>(out1_data + i))
+                    Out1(element_fn(in1[i], in2[i], in3[i]));
+              }
+            });
+          });
+        });
+        return;
+      }
       mask.foreach_index([&](int i) {
         new (static_cast<void *>(&out1[i])) Out1(element_fn(in1[i], in2[i], in3[i]));
       });
@@ -30,6 +30,9 @@ class MFNetworkEvaluator : public MultiFunction {
  private:
   Vector<const MFOutputSocket *> inputs_;
   Vector<const MFInputSocket *> outputs_;
+  /* Amount of elements that are evaluated at once. When zero, the network is always evaluated on
+   * the entire mask. */
+  int64_t chunk_size_ = 0;
 
  public:
   MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs, Vector<const MFInputSocket *> outputs);
@@ -39,6 +42,10 @@ class MFNetworkEvaluator : public MultiFunction {
  private:
   using Storage = MFNetworkEvaluationStorage;
 
+  int64_t compute_chunk_size() const;
+  void call_chunked(IndexMask mask, MFParams params, MFContext context) const;
+  void evaluate_network(IndexMask mask, MFParams params, MFContext context) const;
+
   void copy_inputs_to_storage(MFParams params, Storage &storage) const;
   void copy_outputs_to_storage(
       MFParams params,
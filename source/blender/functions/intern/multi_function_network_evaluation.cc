@@ -29,14 +29,20 @@
  * - Every node is executed at most once.
  * - Can compute sub-functions on a single element, when the result is the same for all elements.
  *
+ * - Large masks are split into chunks that are evaluated one after the other. That way the
+ *   temporary buffers that pass values between nodes stay small enough to remain in the cache.
+ *
  * Possible improvements:
  * - Cache and reuse buffers.
  * - Use "deepest depth first" heuristic to decide which order the inputs of a node should be
  *   computed. This reduces the number of required temporary buffers when they are reused.
  */
 
+#include <algorithm>
+
 #include "FN_multi_function_network_evaluation.hh"
 
+#include "BLI_set.hh"
 #include "BLI_stack.hh"
 
 namespace blender::fn {
@@ -133,6 +139,56 @@ MFNetworkEvaluator::MFNetworkEvaluator(Vector<const MFOutputSocket *> inputs,
         break;
     }
   }
+
+  chunk_size_ = this->compute_chunk_size();
+}
+
+/* The temporary buffers of all nodes that are evaluated for a chunk should fit into the L2 cache
+ * of common CPUs. */
+static constexpr int64_t chunk_buffers_max_size = 256 * 1024;
+static constexpr int64_t chunk_min_size = 512;
+static constexpr int64_t chunk_max_size = 16384;
+
+int64_t MFNetworkEvaluator::compute_chunk_size() const
+{
+  /* Vector parameters can't be split into chunks cheaply. */
+  for (const MFOutputSocket *socket : inputs_) {
+    if (socket->data_type().is_vector()) {
+      return 0;
+    }
+  }
+  for (const MFInputSocket *socket : outputs_) {
+    if (socket->data_type().is_vector()) {
+      return 0;
+    }
+  }
+
+  /* Estimate how much memory is needed to store all values computed for a single element. */
+  int64_t element_size = 0;
+  Set<const MFNode *> visited_nodes;
+  Stack<const MFNode *> nodes_to_check;
+  for (const MFInputSocket *socket : outputs_) {
+    nodes_to_check.push(&socket->origin()->node());
+  }
+  while (!nodes_to_check.is_empty()) {
+    const MFNode &node = *nodes_to_check.pop();
+    if (!visited_nodes.add(&node)) {
+      continue;
+    }
+    for (const MFOutputSocket *socket : node.outputs()) {
+      const MFDataType type = socket->data_type();
+      element_size += type.is_single() ? type.single_type().size() :
+                                         type.vector_base_type().size();
+    }
+    for (const MFInputSocket *socket : node.inputs()) {
+      if (socket->origin() != nullptr) {
+        nodes_to_check.push(&socket->origin()->node());
+      }
+    }
+  }
+
+  return std::clamp(
+      chunk_buffers_max_size / std::max<int64_t>(element_size, 1), chunk_min_size, chunk_max_size);
 }
 
 void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context) const
@@ -140,7 +196,74 @@ void MFNetworkEvaluator::call(IndexMask mask, MFParams params, MFContext context
   if (mask.size() == 0) {
     return;
   }
+  if (chunk_size_ > 0 && mask.size() > chunk_size_) {
+    this->call_chunked(mask, params, context);
+    return;
+  }
+  this->evaluate_network(mask, params, context);
+}
 
+/**
+ * Evaluate the entire network for one chunk of the mask at a time, instead of evaluating every
+ * node for the entire mask. The indices of every chunk are shifted to start at zero, so that the
+ * temporary buffers only have to be as large as the chunk.
+ */
+BLI_NOINLINE void MFNetworkEvaluator::call_chunked(IndexMask mask,
+                                                   MFParams params,
+                                                   MFContext context) const
+{
+  Vector<int64_t> shifted_indices;
+  for (int64_t chunk_start = 0; chunk_start < mask.size(); chunk_start += chunk_size_) {
+    const int64_t chunk_len = std::min(chunk_size_, mask.size() - chunk_start);
+    const Span<int64_t> chunk_indices = mask.indices().slice(chunk_start, chunk_len);
+    const int64_t offset = chunk_indices.first();
+    const int64_t chunk_array_size = chunk_indices.last() - offset + 1;
+
+    IndexMask chunk_mask;
+    if (chunk_array_size == chunk_len) {
+      chunk_mask = IndexRange(chunk_len);
+    }
+    else {
+      shifted_indices.clear();
+      for (const int64_t index : chunk_indices) {
+        shifted_indices.append(index - offset);
+      }
+      chunk_mask = shifted_indices.as_span();
+    }
+
+    MFParamsBuilder chunk_params{*this, chunk_array_size};
+    for (const int param_index : this->param_indices()) {
+      const MFParamType param_type = this->param_type(param_index);
+      switch (param_type.category()) {
+        case MFParamType::SingleInput: {
+          const GVSpan values = params.readonly_single_input(param_index);
+          chunk_params.add_readonly_single_input(values.slice(offset, chunk_array_size));
+          break;
+        }
+        case MFParamType::SingleOutput: {
+          const GMutableSpan values = params.uninitialized_single_output(param_index);
+          chunk_params.add_uninitialized_single_output(values.slice(offset, chunk_array_size));
+          break;
+        }
+        case MFParamType::VectorInput:
+        case MFParamType::VectorOutput:
+        case MFParamType::SingleMutable:
+        case MFParamType::VectorMutable: {
+          /* Networks with these parameters are not evaluated in chunks. */
+          BLI_assert(false);
+          break;
+        }
+      }
+    }
+
+    this->evaluate_network(chunk_mask, chunk_params, context);
+  }
+}
+
+BLI_NOINLINE void MFNetworkEvaluator::evaluate_network(IndexMask mask,
+                                                       MFParams params,
+                                                       MFContext context) const
+{
   const MFNetwork &network = outputs_[0]->node().network();
   Storage storage(mask, network.socket_id_amount());
 
@@ -5,6 +5,8 @@
 #include "FN_multi_function.hh"
 #include "FN_multi_function_builder.hh"
 
+#include "PIL_time.h"
+
 namespace blender::fn::tests {
 namespace {
 
@@ -276,6 +278,77 @@ TEST(multi_function, CustomMF_SI_SI_SI_SO)
   EXPECT_EQ(outputs[3], 13);
 }
 
+TEST(multi_function, CustomMF_SI_SI_SO_Devirtualized)
+{
+  CustomMF_SI_SI_SO<float, float, float> fn{"mul", [](float a, float b) { return a * b; }};
+
+  Array<float> values_a = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f};
+  const float value_b = 3.0f;
+  Array<float> outputs(values_a.size(), 0.0f);
+
+  MFParamsBuilder params(fn, values_a.size());
+  params.add_readonly_single_input(values_a.as_span());
+  params.add_readonly_single_input(&value_b);
+  params.add_uninitialized_single_output(outputs.as_mutable_span());
+
+  MFContextBuilder context;
+
+  fn.call(IndexRange(1, 3), params, context);
+
+  EXPECT_EQ(outputs[0], 0.0f);
+  EXPECT_EQ(outputs[1], 6.0f);
+  EXPECT_EQ(outputs[2], 9.0f);
+  EXPECT_EQ(outputs[3], 12.0f);
+  EXPECT_EQ(outputs[4], 0.0f);
+}
+
+/* Throughput of the different ways custom functions access their inputs,
+ * run with `--gtest_also_run_disabled_tests`. */
+TEST(multi_function, DISABLED_CustomMF_performance)
+{
+  const int64_t size = 10000000;
+  const int num_runs = 5;
+  CustomMF_SI_SI_SO<float, float, float> fn{"mul", [](float a, float b) { return a * b; }};
+
+  Array<float> values_a(size);
+  Array<float> values_b(size);
+  for (const int64_t i : IndexRange(size)) {
+    values_a[i] = (float)(i % 1000);
+    values_b[i] = (float)(i % 17);
+  }
+  const float value_b = 3.0f;
+  Array<float> outputs(size);
+  Vector<int64_t> all_indices;
+  for (const int64_t i : IndexRange(size)) {
+    all_indices.append(i);
+  }
+
+  auto run = [&](const char *name, IndexMask mask, const bool use_single) {
+    MFParamsBuilder params(fn, size);
+    params.add_readonly_single_input(values_a.as_span());
+    if (use_single) {
+      params.add_readonly_single_input(&value_b);
+    }
+    else {
+      params.add_readonly_single_input(values_b.as_span());
+    }
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    MFContextBuilder context;
+
+    const double time_start = PIL_check_seconds_timer();
+    for (int i = 0; i < num_runs; i++) {
+      fn.call(mask, params, context);
+    }
+    const double time = (PIL_check_seconds_timer() - time_start) / num_runs;
+    printf("%s: %.2f ms, %.0f M elements/s\n", name, time * 1000.0, size / time / 1e6);
+  };
+
+  run("range, arrays", IndexRange(size), false);
+  run("range, single value", IndexRange(size), true);
+  run("indices, arrays (generic)", all_indices.as_span(), false);
+  run("indices, single value (generic)", all_indices.as_span(), true);
+}
+
 TEST(multi_function, CustomMF_SM)
 {
   CustomMF_SM<std::string> fn("AddSuffix", [](std::string &value) { value += " test"; });
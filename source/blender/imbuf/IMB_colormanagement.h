@@ -49,6 +49,9 @@ struct ColorSpace;
 
 void IMB_colormanagement_check_file_config(struct Main *bmain);
 
+/* Approximate display transforms of large display buffers with a baked LUT. */
+void IMB_colormanagement_display_lut_use_set(bool use);
+
 void IMB_colormanagement_validate_settings(
     const struct ColorManagedDisplaySettings *display_settings,
     struct ColorManagedViewSettings *view_settings);
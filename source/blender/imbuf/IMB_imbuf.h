@@ -122,6 +122,16 @@ struct ImBuf *IMB_testiffname(const char *filepath, int flags);
  */
 struct ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_SPACE]);
 
+/**
+ * Load an image for a thumbnail of at most `max_thumb_size` pixels, using an embedded preview
+ * or reduced resolution decoding when the file format supports it.
+ *
+ * \attention Defined in readimage.c
+ */
+struct ImBuf *IMB_thumb_load_image(const char *filepath,
+                                   const size_t max_thumb_size,
+                                   char colorspace[IM_MAX_SPACE]);
+
 /**
  *
  * \attention Defined in allocimbuf.c
@@ -169,6 +179,15 @@ struct ImBuf *IMB_allocFromBuffer(const unsigned int *rect,
 void IMB_refImBuf(struct ImBuf *ibuf);
 struct ImBuf *IMB_makeSingleUser(struct ImBuf *ibuf);
 
+/**
+ * Lock around #BLI_mmap_open and #BLI_mmap_free, when mapping files outside of imbuf.
+ * Mapped files are registered for IO error handling, which is not thread-safe.
+ *
+ * \attention Defined in allocimbuf.c
+ */
+void IMB_mmap_lock(void);
+void IMB_mmap_unlock(void);
+
 /**
  *
  * \attention Defined in allocimbuf.c
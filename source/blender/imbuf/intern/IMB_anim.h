@@ -58,6 +58,9 @@
 
 #include "IMB_allocimbuf.h"
 
+#include "BLI_threads.h"
+#include "DNA_listBase.h"
+
 #ifdef WITH_FFMPEG
 #  include <libavcodec/avcodec.h>
 #  include <libavformat/avformat.h>
@@ -136,6 +139,18 @@ struct anim {
   int64_t last_pts;
   int64_t next_pts;
   AVPacket next_packet;
+
+  /* Frames returned recently or decoded ahead of the playhead (AnimCachedFrame). */
+  ListBase frame_cache;
+  size_t frame_cache_size;
+  /* Decoder state is shared with the decode-ahead thread, which is started on sequential
+   * playback. Decoding and the frame cache are protected by decode_mutex. */
+  ThreadMutex decode_mutex;
+  ThreadCondition decode_ahead_cond;
+  ListBase decode_ahead_thread;
+  bool decode_ahead_stop;
+  int playhead_position;
+  IMB_Timecode_Type playhead_tc;
 #endif
 
   char index_dir[768];
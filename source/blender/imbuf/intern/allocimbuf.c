@@ -77,6 +77,16 @@ void imb_mmap_unlock(void)
 }
 #endif
 
+void IMB_mmap_lock(void)
+{
+  imb_mmap_lock();
+}
+
+void IMB_mmap_unlock(void)
+{
+  imb_mmap_unlock();
+}
+
 void imb_freemipmapImBuf(ImBuf *ibuf)
 {
   int a;
@@ -53,10 +53,14 @@
 #  include <io.h>
 #endif
 
+#include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "MEM_CacheLimiterC-Api.h"
 #include "MEM_guardedalloc.h"
 
 #ifdef WITH_AVI
@@ -82,6 +86,29 @@
 #  include <libswscale/swscale.h>
 
 #  include "ffmpeg_compat.h"
+
+/* Number of frames decoded ahead of the playhead during sequential playback. */
+#  define ANIM_DECODE_AHEAD 4
+/* Limits of the per-anim cache of decoded frames. */
+#  define ANIM_FRAME_CACHE_MAX_FRAMES 16
+#  define ANIM_FRAME_CACHE_MAX_BYTES ((size_t)256 * 1024 * 1024)
+/* Limit of the caches of all anims together. It is further bounded by a part of the memory cache
+ * limit from the preferences, which the sequencer cache uses as well. */
+#  define ANIM_FRAME_CACHE_MAX_BYTES_GLOBAL ((size_t)512 * 1024 * 1024)
+/* Every decoder thread holds on to frames of its own with frame threading, and every anim has its
+ * own decoder, so the number of threads is limited. */
+#  define ANIM_DECODE_MAX_THREADS 8
+
+static ThreadMutex frame_cache_global_mutex = BLI_MUTEX_INITIALIZER;
+static size_t frame_cache_size_global = 0;
+
+typedef struct AnimCachedFrame {
+  struct AnimCachedFrame *next, *prev;
+  int position;
+  IMB_Timecode_Type tc;
+  ImBuf *ibuf;
+  size_t size;
+} AnimCachedFrame;
 #endif /* WITH_FFMPEG */
 
 int ismovie(const char *UNUSED(filepath))
@@ -573,6 +600,15 @@ static int startffmpeg(struct anim *anim)
 
   pCodecCtx->workaround_bugs = 1;
 
+  pCodecCtx->thread_count = min_ii(BLI_system_thread_count(), ANIM_DECODE_MAX_THREADS);
+
+  if (pCodec->capabilities & AV_CODEC_CAP_FRAME_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_FRAME;
+  }
+  else if (pCodec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    pCodecCtx->thread_type = FF_THREAD_SLICE;
+  }
+
   if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0) {
     avformat_close_input(&pFormatCtx);
     return -1;
@@ -743,6 +779,15 @@ static int startffmpeg(struct anim *anim)
   }
 #  endif
 
+  BLI_listbase_clear(&anim->frame_cache);
+  anim->frame_cache_size = 0;
+  BLI_mutex_init(&anim->decode_mutex);
+  BLI_condition_init(&anim->decode_ahead_cond);
+  BLI_listbase_clear(&anim->decode_ahead_thread);
+  anim->decode_ahead_stop = false;
+  anim->playhead_position = -1;
+  anim->playhead_tc = IMB_TC_NONE;
+
   return 0;
 }
 
@@ -1045,7 +1090,8 @@ static int ffmpeg_seek_by_byte(AVFormatContext *pFormatCtx)
   return false;
 }
 
-static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
+/* Decode frame at given position, decode_mutex must be held. */
+static ImBuf *ffmpeg_fetchibuf_decode(struct anim *anim, int position, IMB_Timecode_Type tc)
 {
   int64_t pts_to_search = 0;
   double frame_rate;
@@ -1240,6 +1286,173 @@ static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Typ
   return anim->last_frame;
 }
 
+static ImBuf *ffmpeg_frame_cache_get(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+  LISTBASE_FOREACH (AnimCachedFrame *, cached_frame, &anim->frame_cache) {
+    if (cached_frame->position == position && cached_frame->tc == tc) {
+      IMB_refImBuf(cached_frame->ibuf);
+      return cached_frame->ibuf;
+    }
+  }
+  return NULL;
+}
+
+static bool ffmpeg_frame_cache_is_over_budget(const struct anim *anim, const int num_frames)
+{
+  if (num_frames > ANIM_FRAME_CACHE_MAX_FRAMES ||
+      anim->frame_cache_size > ANIM_FRAME_CACHE_MAX_BYTES) {
+    return true;
+  }
+  /* Leave room for the frames decoded ahead with a low memory cache limit. */
+  const size_t max_size_global = min_zz(
+      ANIM_FRAME_CACHE_MAX_BYTES_GLOBAL,
+      max_zz(MEM_CacheLimiter_get_maximum() / 4, ANIM_FRAME_CACHE_MAX_BYTES_GLOBAL / 8));
+  BLI_mutex_lock(&frame_cache_global_mutex);
+  const bool is_over_budget = frame_cache_size_global > max_size_global;
+  BLI_mutex_unlock(&frame_cache_global_mutex);
+  return is_over_budget;
+}
+
+static void ffmpeg_frame_cache_remove(struct anim *anim, AnimCachedFrame *cached_frame)
+{
+  anim->frame_cache_size -= cached_frame->size;
+  BLI_mutex_lock(&frame_cache_global_mutex);
+  frame_cache_size_global -= cached_frame->size;
+  BLI_mutex_unlock(&frame_cache_global_mutex);
+  IMB_freeImBuf(cached_frame->ibuf);
+  BLI_freelinkN(&anim->frame_cache, cached_frame);
+}
+
+static void ffmpeg_frame_cache_add(struct anim *anim,
+                                   int position,
+                                   IMB_Timecode_Type tc,
+                                   ImBuf *ibuf)
+{
+  LISTBASE_FOREACH (AnimCachedFrame *, cached_frame, &anim->frame_cache) {
+    if (cached_frame->position == position && cached_frame->tc == tc) {
+      return;
+    }
+  }
+
+  AnimCachedFrame *cached_frame = MEM_callocN(sizeof(AnimCachedFrame), "AnimCachedFrame");
+  cached_frame->position = position;
+  cached_frame->tc = tc;
+  cached_frame->ibuf = ibuf;
+  cached_frame->size = IMB_get_size_in_memory(ibuf);
+  IMB_refImBuf(ibuf);
+  BLI_addtail(&anim->frame_cache, cached_frame);
+  anim->frame_cache_size += cached_frame->size;
+  BLI_mutex_lock(&frame_cache_global_mutex);
+  frame_cache_size_global += cached_frame->size;
+  BLI_mutex_unlock(&frame_cache_global_mutex);
+
+  /* Oldest frames go first, frames decoded ahead are always the most recent ones. When all anims
+   * together use too much memory, the anim that adds a frame gives up its older frames. */
+  int num_frames = BLI_listbase_count(&anim->frame_cache);
+  while (anim->frame_cache.first != cached_frame &&
+         ffmpeg_frame_cache_is_over_budget(anim, num_frames)) {
+    ffmpeg_frame_cache_remove(anim, anim->frame_cache.first);
+    num_frames--;
+  }
+}
+
+static void ffmpeg_frame_cache_free(struct anim *anim)
+{
+  while (anim->frame_cache.first) {
+    ffmpeg_frame_cache_remove(anim, anim->frame_cache.first);
+  }
+}
+
+/* Keep decoding frames following the playhead while it moves forward, so sequential playback
+ * is served from the frame cache. Seeks (jumps of playhead) are left to #ffmpeg_fetchibuf. */
+static void *ffmpeg_decode_ahead_thread(void *data)
+{
+  struct anim *anim = data;
+
+  BLI_mutex_lock(&anim->decode_mutex);
+  while (!anim->decode_ahead_stop) {
+    const int position = anim->curposition + 1;
+    if (anim->curposition < anim->playhead_position - ANIM_DECODE_AHEAD ||
+        position > anim->playhead_position + ANIM_DECODE_AHEAD ||
+        position >= anim->duration_in_frames) {
+      BLI_condition_wait(&anim->decode_ahead_cond, &anim->decode_mutex);
+      continue;
+    }
+
+    ImBuf *ibuf = ffmpeg_fetchibuf_decode(anim, position, anim->playhead_tc);
+    if (ibuf) {
+      ffmpeg_frame_cache_add(anim, position, anim->playhead_tc, ibuf);
+      IMB_freeImBuf(ibuf);
+    }
+
+    /* Give other threads chance to fetch a frame. */
+    BLI_mutex_unlock(&anim->decode_mutex);
+    BLI_mutex_lock(&anim->decode_mutex);
+  }
+  BLI_mutex_unlock(&anim->decode_mutex);
+
+  return NULL;
+}
+
+static void ffmpeg_decode_ahead_start(struct anim *anim)
+{
+  if (!BLI_listbase_is_empty(&anim->decode_ahead_thread)) {
+    return;
+  }
+
+  BLI_threadpool_init(&anim->decode_ahead_thread, ffmpeg_decode_ahead_thread, 1);
+  BLI_threadpool_insert(&anim->decode_ahead_thread, anim);
+}
+
+static void ffmpeg_decode_ahead_stop(struct anim *anim)
+{
+  BLI_mutex_lock(&anim->decode_mutex);
+  anim->decode_ahead_stop = true;
+  BLI_condition_notify_all(&anim->decode_ahead_cond);
+  BLI_mutex_unlock(&anim->decode_mutex);
+
+  BLI_threadpool_end(&anim->decode_ahead_thread);
+}
+
+static ImBuf *ffmpeg_fetchibuf(struct anim *anim, int position, IMB_Timecode_Type tc)
+{
+  if (anim == NULL) {
+    return NULL;
+  }
+
+  BLI_mutex_lock(&anim->decode_mutex);
+
+  const bool is_sequential = (position == anim->playhead_position + 1);
+  anim->playhead_position = position;
+  anim->playhead_tc = tc;
+
+  ImBuf *ibuf = ffmpeg_frame_cache_get(anim, position, tc);
+  if (ibuf == NULL) {
+    ibuf = ffmpeg_fetchibuf_decode(anim, position, tc);
+    if (ibuf) {
+      ffmpeg_frame_cache_add(anim, position, tc, ibuf);
+    }
+  }
+
+  if (is_sequential) {
+    ffmpeg_decode_ahead_start(anim);
+  }
+  BLI_condition_notify_all(&anim->decode_ahead_cond);
+
+  BLI_mutex_unlock(&anim->decode_mutex);
+
+  /* Callers are free to modify the returned frame, e.g. the sequencer converts it to its working
+   * color space in place, so never hand out the frames owned by the cache. The reference keeps
+   * the cached frame alive while it's copied outside of the lock. */
+  if (ibuf) {
+    ImBuf *ibuf_copy = IMB_dupImBuf(ibuf);
+    IMB_freeImBuf(ibuf);
+    ibuf = ibuf_copy;
+  }
+
+  return ibuf;
+}
+
 static void free_anim_ffmpeg(struct anim *anim)
 {
   if (anim == NULL) {
@@ -1247,6 +1460,11 @@ static void free_anim_ffmpeg(struct anim *anim)
   }
 
   if (anim->pCodecCtx) {
+    ffmpeg_decode_ahead_stop(anim);
+    ffmpeg_frame_cache_free(anim);
+    BLI_condition_end(&anim->decode_ahead_cond);
+    BLI_mutex_end(&anim->decode_mutex);
+
     avcodec_close(anim->pCodecCtx);
     avformat_close_input(&anim->pFormatCtx);
 
@@ -1426,10 +1644,8 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
 #endif
 #ifdef WITH_FFMPEG
     case ANIM_FFMPEG:
+      /* Decoder position is managed internally, it may be ahead of the requested frame. */
       ibuf = ffmpeg_fetchibuf(anim, position, tc);
-      if (ibuf) {
-        anim->curposition = position;
-      }
       filter_y = 0; /* done internally */
       break;
 #endif
@@ -1439,7 +1655,7 @@ struct ImBuf *IMB_anim_absolute(struct anim *anim,
     if (filter_y) {
       IMB_filtery(ibuf);
     }
-    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, anim->curposition + 1);
+    BLI_snprintf(ibuf->name, sizeof(ibuf->name), "%s.%04d", anim->name, position + 1);
   }
   return ibuf;
 }
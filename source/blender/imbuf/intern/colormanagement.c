@@ -45,6 +45,7 @@
 #include "BLI_blenlib.h"
 #include "BLI_math.h"
 #include "BLI_math_color.h"
+#include "BLI_rand.h"
 #include "BLI_rect.h"
 #include "BLI_string.h"
 #include "BLI_threads.h"
@@ -86,6 +87,9 @@ static int global_tot_display = 0;
 static int global_tot_view = 0;
 static int global_tot_looks = 0;
 
+/* Use baked LUTs for display buffer transforms, set from the preferences. */
+static bool global_use_display_lut = false;
+
 /* Luma coefficients and XYZ to RGB to be initialized by OCIO. */
 float imbuf_luma_coefficients[3] = {0.0f};
 float imbuf_xyz_to_rgb[3][3] = {{0.0f}};
@@ -103,6 +107,8 @@ static pthread_mutex_t processor_lock = BLI_MUTEX_INITIALIZER;
 typedef struct ColormanageProcessor {
   OCIO_ConstProcessorRcPtr *processor;
   CurveMapping *curve_mapping;
+  /* Baked approximation of the processor, used for large buffers. */
+  struct ColormanageDisplayLUT *display_lut;
   bool is_data_result;
 } ColormanageProcessor;
 
@@ -236,6 +242,7 @@ typedef struct ColormanageCacheData {
   float dither;                /* dither value cached buffer is calculated with */
   CurveMapping *curve_mapping; /* curve mapping used for cached buffer */
   int curve_mapping_timestamp; /* time stamp of curve mapping used for cached buffer */
+  bool use_display_lut;        /* whether the display LUT was enabled for cached buffer */
 } ColormanageCacheData;
 
 typedef struct ColormanageCache {
@@ -402,7 +409,8 @@ static unsigned char *colormanage_cache_get(
         cache_data->exposure != view_settings->exposure ||
         cache_data->gamma != view_settings->gamma || cache_data->dither != view_settings->dither ||
         cache_data->flag != view_settings->flag || cache_data->curve_mapping != curve_mapping ||
-        cache_data->curve_mapping_timestamp != curve_mapping_timestamp) {
+        cache_data->curve_mapping_timestamp != curve_mapping_timestamp ||
+        cache_data->use_display_lut != global_use_display_lut) {
       *cache_handle = NULL;
 
       IMB_freeImBuf(cache_ibuf);
@@ -452,6 +460,7 @@ static void colormanage_cache_put(ImBuf *ibuf,
   cache_data->flag = view_settings->flag;
   cache_data->curve_mapping = curve_mapping;
   cache_data->curve_mapping_timestamp = curve_mapping_timestamp;
+  cache_data->use_display_lut = global_use_display_lut;
 
   colormanage_cachedata_set(cache_ibuf, cache_data);
 
@@ -469,6 +478,414 @@ static void colormanage_cache_handle_release(void *cache_handle)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Display Transform LUT
+ *
+ * Running the full OCIO processor for every pixel of a large display buffer is expensive.
+ * Instead the display transform is baked into a 3D LUT, which is evaluated with tetrahedral
+ * interpolation. The LUT is indexed through a logarithmic shaper covering scene linear values
+ * in [0, #DISPLAY_LUT_DOMAIN_MAX], with a node at exactly 1.0 where many views clip. Pixels
+ * outside of that domain go through the exact processor.
+ *
+ * The LUT is only used when enabled in the preferences, see
+ * #IMB_colormanagement_display_lut_use_set. Baked LUTs are cached per look, view, display and
+ * exposure. After baking, the LUT is compared against the exact processor and only used when its
+ * error stays below #DISPLAY_LUT_MAX_ERROR.
+ * \{ */
+
+/* Number of nodes along each axis of the LUT. */
+#define DISPLAY_LUT_SIZE 33
+/* Shaper is `log2(1 + 127 * x) / 14`, it maps 1.0 to the middle node. */
+#define DISPLAY_LUT_SHAPER_SCALE 127.0f
+#define DISPLAY_LUT_SHAPER_RANGE 14.0f
+#define DISPLAY_LUT_DOMAIN_MAX (16383.0f / 127.0f)
+/* Maximum allowed difference from the exact processor in display space, one 8 bit value. */
+#define DISPLAY_LUT_MAX_ERROR (1.0f / 255.0f)
+/* Number of random samples the error of a baked LUT is measured with. */
+#define DISPLAY_LUT_ERROR_SAMPLES 4096
+/* Buffers smaller than this are not worth baking a LUT for. */
+#define DISPLAY_LUT_MIN_PIXELS (512 * 512)
+/* Number of unused LUTs kept in the cache. */
+#define DISPLAY_LUT_CACHE_SIZE 4
+
+typedef struct ColormanageDisplayLUT {
+  struct ColormanageDisplayLUT *next, *prev;
+
+  /* Settings the LUT is baked for. */
+  char look[MAX_COLORSPACE_NAME];
+  char view[MAX_COLORSPACE_NAME];
+  char display[MAX_COLORSPACE_NAME];
+  float exposure;
+
+  /* RGB values of the nodes, red index varies fastest.
+   * NULL when the LUT is not accurate enough to be used. */
+  float *table;
+  /* Largest difference to the exact processor measured after baking. */
+  float max_error;
+
+  int users;
+} ColormanageDisplayLUT;
+
+static ListBase global_display_luts = {NULL, NULL};
+static pthread_mutex_t display_lut_lock = BLI_MUTEX_INITIALIZER;
+
+/* Polynomial approximation of log2 for values >= 1, accurate to about 1e-5. That is far below
+ * the spacing of the nodes and a lot cheaper than log2f. */
+BLI_INLINE float display_lut_log2(float value)
+{
+  union {
+    float f;
+    uint32_t i;
+  } u = {value};
+  const float exponent = (float)((int)(u.i >> 23) - 127);
+  u.i = (u.i & 0x007FFFFFu) | 0x3F800000u;
+  const float x = u.f - 1.0f;
+  return exponent +
+         (1.43909272e-05f +
+          x * (1.44159208f +
+               x * (-0.707253434f + x * (0.411561485f + x * (-0.189832449f + x * 0.0439286288f)))));
+}
+
+BLI_INLINE float display_lut_shaper(float value)
+{
+  return display_lut_log2(1.0f + value * DISPLAY_LUT_SHAPER_SCALE) *
+         ((DISPLAY_LUT_SIZE - 1) / DISPLAY_LUT_SHAPER_RANGE);
+}
+
+static float display_lut_shaper_inverse(float position)
+{
+  return (exp2f(position * (DISPLAY_LUT_SHAPER_RANGE / (DISPLAY_LUT_SIZE - 1))) - 1.0f) /
+         DISPLAY_LUT_SHAPER_SCALE;
+}
+
+BLI_INLINE bool display_lut_in_domain(const float rgb[3])
+{
+  /* Written so NaN is outside of the domain. */
+  return (rgb[0] >= 0.0f && rgb[0] <= DISPLAY_LUT_DOMAIN_MAX) &&
+         (rgb[1] >= 0.0f && rgb[1] <= DISPLAY_LUT_DOMAIN_MAX) &&
+         (rgb[2] >= 0.0f && rgb[2] <= DISPLAY_LUT_DOMAIN_MAX);
+}
+
+/* Tetrahedral interpolation of the LUT, rgb must be inside of the domain. */
+BLI_INLINE void display_lut_evaluate(const float *table, const float rgb[3], float r_rgb[3])
+{
+  const int stride_r = 3;
+  const int stride_g = 3 * DISPLAY_LUT_SIZE;
+  const int stride_b = 3 * DISPLAY_LUT_SIZE * DISPLAY_LUT_SIZE;
+  int index[3];
+  float fac[3];
+
+  for (int i = 0; i < 3; i++) {
+    const float position = display_lut_shaper(rgb[i]);
+    index[i] = min_ii((int)position, DISPLAY_LUT_SIZE - 2);
+    fac[i] = position - (float)index[i];
+  }
+
+  const float *c000 = table + index[0] * stride_r + index[1] * stride_g + index[2] * stride_b;
+  const float *c111 = c000 + stride_r + stride_g + stride_b;
+  const float *c1, *c2;
+  float w0, w1, w2, w3;
+
+  if (fac[0] >= fac[1]) {
+    if (fac[1] >= fac[2]) {
+      c1 = c000 + stride_r;
+      c2 = c000 + stride_r + stride_g;
+      w0 = 1.0f - fac[0], w1 = fac[0] - fac[1], w2 = fac[1] - fac[2], w3 = fac[2];
+    }
+    else if (fac[0] >= fac[2]) {
+      c1 = c000 + stride_r;
+      c2 = c000 + stride_r + stride_b;
+      w0 = 1.0f - fac[0], w1 = fac[0] - fac[2], w2 = fac[2] - fac[1], w3 = fac[1];
+    }
+    else {
+      c1 = c000 + stride_b;
+      c2 = c000 + stride_r + stride_b;
+      w0 = 1.0f - fac[2], w1 = fac[2] - fac[0], w2 = fac[0] - fac[1], w3 = fac[1];
+    }
+  }
+  else {
+    if (fac[2] >= fac[1]) {
+      c1 = c000 + stride_b;
+      c2 = c000 + stride_g + stride_b;
+      w0 = 1.0f - fac[2], w1 = fac[2] - fac[1], w2 = fac[1] - fac[0], w3 = fac[0];
+    }
+    else if (fac[2] >= fac[0]) {
+      c1 = c000 + stride_g;
+      c2 = c000 + stride_g + stride_b;
+      w0 = 1.0f - fac[1], w1 = fac[1] - fac[2], w2 = fac[2] - fac[0], w3 = fac[0];
+    }
+    else {
+      c1 = c000 + stride_g;
+      c2 = c000 + stride_r + stride_g;
+      w0 = 1.0f - fac[1], w1 = fac[1] - fac[0], w2 = fac[0] - fac[2], w3 = fac[2];
+    }
+  }
+
+  r_rgb[0] = w0 * c000[0] + w1 * c1[0] + w2 * c2[0] + w3 * c111[0];
+  r_rgb[1] = w0 * c000[1] + w1 * c1[1] + w2 * c2[1] + w3 * c111[1];
+  r_rgb[2] = w0 * c000[2] + w1 * c1[2] + w2 * c2[2] + w3 * c111[2];
+}
+
+static void display_lut_processor_apply(OCIO_ConstProcessorRcPtr *processor,
+                                        float *pixels,
+                                        int num_pixels)
+{
+  OCIO_PackedImageDesc *img = OCIO_createOCIO_PackedImageDesc(pixels,
+                                                              num_pixels,
+                                                              1,
+                                                              4,
+                                                              sizeof(float),
+                                                              sizeof(float[4]),
+                                                              sizeof(float[4]) * num_pixels);
+  OCIO_processorApply(processor, img);
+  OCIO_PackedImageDescRelease(img);
+}
+
+static void display_lut_bake(ColormanageDisplayLUT *lut, OCIO_ConstProcessorRcPtr *processor)
+{
+  const int size = DISPLAY_LUT_SIZE;
+  const int num_nodes = size * size * size;
+  float node_values[DISPLAY_LUT_SIZE];
+  bool alpha_preserved = true;
+
+  for (int i = 0; i < size; i++) {
+    node_values[i] = display_lut_shaper_inverse((float)i);
+  }
+
+  /* Alpha is neither 0 nor 1, so transforms which modify alpha can be detected. */
+  float *pixels = MEM_mallocN(sizeof(float[4]) * num_nodes, "display LUT bake");
+  float *pixel = pixels;
+  for (int b = 0; b < size; b++) {
+    for (int g = 0; g < size; g++) {
+      for (int r = 0; r < size; r++, pixel += 4) {
+        pixel[0] = node_values[r];
+        pixel[1] = node_values[g];
+        pixel[2] = node_values[b];
+        pixel[3] = 0.5f;
+      }
+    }
+  }
+
+  display_lut_processor_apply(processor, pixels, num_nodes);
+
+  lut->table = MEM_mallocN(sizeof(float[3]) * num_nodes, "display LUT table");
+  for (int i = 0; i < num_nodes; i++) {
+    copy_v3_v3(lut->table + 3 * i, pixels + 4 * i);
+    alpha_preserved &= (pixels[4 * i + 3] == 0.5f);
+  }
+
+  MEM_freeN(pixels);
+
+  /* Measure the error at random positions, which are in general in between the nodes. */
+  float(*samples)[4] = MEM_mallocN(sizeof(float[4]) * DISPLAY_LUT_ERROR_SAMPLES,
+                                   "display LUT error samples");
+  RNG *rng = BLI_rng_new(0);
+  for (int i = 0; i < DISPLAY_LUT_ERROR_SAMPLES; i++) {
+    for (int j = 0; j < 3; j++) {
+      samples[i][j] = display_lut_shaper_inverse(BLI_rng_get_float(rng) * (size - 1));
+    }
+    samples[i][3] = 1.0f;
+  }
+  BLI_rng_free(rng);
+
+  float(*samples_lut)[3] = MEM_mallocN(sizeof(float[3]) * DISPLAY_LUT_ERROR_SAMPLES,
+                                       "display LUT error samples");
+  for (int i = 0; i < DISPLAY_LUT_ERROR_SAMPLES; i++) {
+    CLAMP_MAX(samples[i][0], DISPLAY_LUT_DOMAIN_MAX);
+    CLAMP_MAX(samples[i][1], DISPLAY_LUT_DOMAIN_MAX);
+    CLAMP_MAX(samples[i][2], DISPLAY_LUT_DOMAIN_MAX);
+    display_lut_evaluate(lut->table, samples[i], samples_lut[i]);
+  }
+
+  display_lut_processor_apply(processor, samples[0], DISPLAY_LUT_ERROR_SAMPLES);
+
+  /* Compare in the displayable range, differences above 1.0 are not visible. */
+  lut->max_error = 0.0f;
+  for (int i = 0; i < DISPLAY_LUT_ERROR_SAMPLES; i++) {
+    for (int j = 0; j < 3; j++) {
+      const float error = fabsf(clamp_f(samples_lut[i][j], 0.0f, 1.0f) -
+                                clamp_f(samples[i][j], 0.0f, 1.0f));
+      /* Also catches NaN coming from the processor. */
+      if (!(error <= lut->max_error)) {
+        lut->max_error = isfinite(error) ? error : FLT_MAX;
+      }
+    }
+  }
+
+  MEM_freeN(samples);
+  MEM_freeN(samples_lut);
+
+  if (!alpha_preserved) {
+    lut->max_error = FLT_MAX;
+  }
+
+  printf("Color management: baked display LUT for view \"%s\", look \"%s\", display \"%s\", "
+         "max error %f%s\n",
+         lut->view,
+         lut->look,
+         lut->display,
+         lut->max_error,
+         (lut->max_error > DISPLAY_LUT_MAX_ERROR) ? ", using exact transform instead" : "");
+
+  if (lut->max_error > DISPLAY_LUT_MAX_ERROR) {
+    MEM_SAFE_FREE(lut->table);
+  }
+}
+
+static void display_lut_free(ColormanageDisplayLUT *lut)
+{
+  MEM_SAFE_FREE(lut->table);
+  MEM_freeN(lut);
+}
+
+/* Get a LUT for the given settings from the cache, baking it when needed. */
+static ColormanageDisplayLUT *display_lut_acquire(
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings,
+    OCIO_ConstProcessorRcPtr *processor)
+{
+  ColormanageDisplayLUT *lut;
+
+  BLI_mutex_lock(&display_lut_lock);
+
+  for (lut = global_display_luts.first; lut; lut = lut->next) {
+    if (lut->exposure == view_settings->exposure && STREQ(lut->look, view_settings->look) &&
+        STREQ(lut->view, view_settings->view_transform) &&
+        STREQ(lut->display, display_settings->display_device)) {
+      /* Keep most recently used LUTs at the front. */
+      BLI_remlink(&global_display_luts, lut);
+      break;
+    }
+  }
+
+  if (lut == NULL) {
+    /* Baking happens with the lock held, so concurrent display buffer updates for the same
+     * settings do not bake the same LUT multiple times. */
+    lut = MEM_callocN(sizeof(ColormanageDisplayLUT), "colormanagement display LUT");
+    STRNCPY(lut->look, view_settings->look);
+    STRNCPY(lut->view, view_settings->view_transform);
+    STRNCPY(lut->display, display_settings->display_device);
+    lut->exposure = view_settings->exposure;
+
+    display_lut_bake(lut, processor);
+  }
+
+  BLI_addhead(&global_display_luts, lut);
+  lut->users++;
+
+  /* Free least recently used LUTs which are not used by any processor. */
+  int num_unused = 0;
+  ColormanageDisplayLUT *lut_iter = global_display_luts.first;
+  while (lut_iter) {
+    ColormanageDisplayLUT *lut_next = lut_iter->next;
+    if (lut_iter->users == 0 && ++num_unused > DISPLAY_LUT_CACHE_SIZE) {
+      BLI_remlink(&global_display_luts, lut_iter);
+      display_lut_free(lut_iter);
+    }
+    lut_iter = lut_next;
+  }
+
+  BLI_mutex_unlock(&display_lut_lock);
+
+  return lut;
+}
+
+static void display_lut_release(ColormanageDisplayLUT *lut)
+{
+  BLI_mutex_lock(&display_lut_lock);
+  BLI_assert(lut->users > 0);
+  lut->users--;
+  BLI_mutex_unlock(&display_lut_lock);
+}
+
+static void display_lut_free_all(void)
+{
+  ColormanageDisplayLUT *lut = global_display_luts.first;
+  while (lut) {
+    ColormanageDisplayLUT *lut_next = lut->next;
+    BLI_assert(lut->users == 0);
+    display_lut_free(lut);
+    lut = lut_next;
+  }
+  BLI_listbase_clear(&global_display_luts);
+}
+
+void IMB_colormanagement_display_lut_use_set(bool use)
+{
+  global_use_display_lut = use;
+}
+
+/* Use a baked LUT for display transforms of buffers which are large enough to benefit. */
+static void colormanage_processor_display_lut_ensure(
+    ColormanageProcessor *cm_processor,
+    const ColorManagedViewSettings *view_settings,
+    const ColorManagedDisplaySettings *display_settings,
+    size_t num_pixels)
+{
+  if (!global_use_display_lut || num_pixels < DISPLAY_LUT_MIN_PIXELS || view_settings == NULL ||
+      cm_processor->processor == NULL || cm_processor->is_data_result) {
+    return;
+  }
+
+  /* Post-display gamma is also applied to alpha, which is not covered by the LUT. */
+  if (view_settings->gamma != 1.0f) {
+    return;
+  }
+
+  cm_processor->display_lut = display_lut_acquire(
+      view_settings, display_settings, cm_processor->processor);
+}
+
+static void display_lut_apply(const ColormanageDisplayLUT *lut,
+                              OCIO_ConstProcessorRcPtr *processor,
+                              float *buffer,
+                              size_t num_pixels,
+                              int channels,
+                              bool predivide)
+{
+  BLI_assert(ELEM(channels, 3, 4));
+  predivide &= (channels == 4);
+
+  float *pixel = buffer;
+  for (size_t i = 0; i < num_pixels; i++, pixel += channels) {
+    const float alpha = predivide ? pixel[3] : 1.0f;
+    /* Same as OCIO_processorApplyRGBA_predivide. */
+    const bool use_predivide = !ELEM(alpha, 0.0f, 1.0f);
+    float rgb[3];
+
+    if (use_predivide) {
+      mul_v3_v3fl(rgb, pixel, 1.0f / alpha);
+    }
+    else {
+      copy_v3_v3(rgb, pixel);
+    }
+
+    if (!display_lut_in_domain(rgb)) {
+      if (predivide) {
+        OCIO_processorApplyRGBA_predivide(processor, pixel);
+      }
+      else if (channels == 4) {
+        OCIO_processorApplyRGBA(processor, pixel);
+      }
+      else {
+        OCIO_processorApplyRGB(processor, pixel);
+      }
+      continue;
+    }
+
+    display_lut_evaluate(lut->table, rgb, rgb);
+
+    if (use_predivide) {
+      mul_v3_v3fl(pixel, rgb, alpha);
+    }
+    else {
+      copy_v3_v3(pixel, rgb);
+    }
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Initialization / De-initialization
  * \{ */
@@ -758,6 +1175,8 @@ void colormanagement_exit(void)
   memset(&global_glsl_state, 0, sizeof(global_glsl_state));
   memset(&global_color_picking_state, 0, sizeof(global_color_picking_state));
 
+  display_lut_free_all();
+
   colormanage_free_config();
 }
 
@@ -1812,7 +2231,8 @@ static void colormanage_display_buffer_process_ex(
     float *display_buffer,
     unsigned char *display_buffer_byte,
     const ColorManagedViewSettings *view_settings,
-    const ColorManagedDisplaySettings *display_settings)
+    const ColorManagedDisplaySettings *display_settings,
+    const bool use_display_lut)
 {
   ColormanageProcessor *cm_processor = NULL;
   bool skip_transform = false;
@@ -1828,6 +2248,11 @@ static void colormanage_display_buffer_process_ex(
 
   if (skip_transform == false) {
     cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+
+    if (use_display_lut) {
+      colormanage_processor_display_lut_ensure(
+          cm_processor, view_settings, display_settings, (size_t)ibuf->x * ibuf->y);
+    }
   }
 
   display_buffer_apply_threaded(ibuf,
@@ -1848,7 +2273,7 @@ static void colormanage_display_buffer_process(ImBuf *ibuf,
                                                const ColorManagedDisplaySettings *display_settings)
 {
   colormanage_display_buffer_process_ex(
-      ibuf, NULL, display_buffer, view_settings, display_settings);
+      ibuf, NULL, display_buffer, view_settings, display_settings, true);
 }
 
 /** \} */
@@ -2517,8 +2942,12 @@ static void colormanagement_imbuf_make_display_space(
     imb_addrectImBuf(ibuf);
   }
 
-  colormanage_display_buffer_process_ex(
-      ibuf, ibuf->rect_float, (unsigned char *)ibuf->rect, view_settings, display_settings);
+  colormanage_display_buffer_process_ex(ibuf,
+                                        ibuf->rect_float,
+                                        (unsigned char *)ibuf->rect,
+                                        view_settings,
+                                        display_settings,
+                                        false);
 }
 
 void IMB_colormanagement_imbuf_make_display_space(
@@ -3688,6 +4117,10 @@ static void imb_partial_display_buffer_update_ex(
 
     if (!skip_transform) {
       cm_processor = IMB_colormanagement_display_processor_new(view_settings, display_settings);
+      colormanage_processor_display_lut_ensure(cm_processor,
+                                               view_settings,
+                                               display_settings,
+                                               (size_t)(xmax - xmin) * (ymax - ymin));
     }
 
     if (do_threads) {
@@ -3940,7 +4373,16 @@ void IMB_colormanagement_processor_apply(ColormanageProcessor *cm_processor,
     }
   }
 
-  if (cm_processor->processor && channels >= 3) {
+  if (cm_processor->processor && cm_processor->display_lut &&
+      cm_processor->display_lut->table && ELEM(channels, 3, 4)) {
+    display_lut_apply(cm_processor->display_lut,
+                      cm_processor->processor,
+                      buffer,
+                      (size_t)width * height,
+                      channels,
+                      predivide);
+  }
+  else if (cm_processor->processor && channels >= 3) {
     OCIO_PackedImageDesc *img;
 
     /* apply OCIO processor */
@@ -3989,6 +4431,9 @@ void IMB_colormanagement_processor_free(ColormanageProcessor *cm_processor)
   if (cm_processor->processor) {
     OCIO_processorRelease(cm_processor->processor);
   }
+  if (cm_processor->display_lut) {
+    display_lut_release(cm_processor->display_lut);
+  }
 
   MEM_freeN(cm_processor);
 }
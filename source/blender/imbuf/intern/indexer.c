@@ -27,8 +27,11 @@
 #include "BLI_endian_switch.h"
 #include "BLI_fileops.h"
 #include "BLI_ghash.h"
+#include "BLI_math_bits.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 #ifdef _WIN32
 #  include "BLI_winstuff.h"
@@ -780,6 +783,18 @@ static IndexBuildContext *index_ffmpeg_create_context(struct anim *anim,
 
   context->iCodecCtx->workaround_bugs = 1;
 
+  /* Only slice threading: frame threading delays the decoded frames with respect to the packets
+   * they came from, which would attach wrong seek positions to the timecode index entries. */
+  if (context->iCodec->capabilities & AV_CODEC_CAP_SLICE_THREADS) {
+    if (context->iCodec->capabilities & AV_CODEC_CAP_AUTO_THREADS) {
+      context->iCodecCtx->thread_count = 0;
+    }
+    else {
+      context->iCodecCtx->thread_count = BLI_system_thread_count();
+    }
+    context->iCodecCtx->thread_type = FF_THREAD_SLICE;
+  }
+
   if (avcodec_open2(context->iCodecCtx, context->iCodec, NULL) < 0) {
     avformat_close_input(&context->iFormatCtx);
     MEM_freeN(context);
@@ -839,6 +854,19 @@ static void index_rebuild_ffmpeg_finish(FFmpegIndexBuilderContext *context, int
   MEM_freeN(context);
 }
 
+typedef struct FFmpegProxyOutputData {
+  struct proxy_output_ctx **proxy_ctx;
+  AVFrame *in_frame;
+} FFmpegProxyOutputData;
+
+static void index_rebuild_ffmpeg_proxy_output(void *__restrict userdata,
+                                              const int i,
+                                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  FFmpegProxyOutputData *data = userdata;
+  add_to_proxy_output_ffmpeg(data->proxy_ctx[i], data->in_frame);
+}
+
 static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *context,
                                                     AVPacket *curr_packet,
                                                     AVFrame *in_frame)
@@ -848,9 +876,19 @@ static void index_rebuild_ffmpeg_proc_decoded_frame(FFmpegIndexBuilderContext *c
   uint64_t s_dts = context->seek_pos_dts;
   uint64_t pts = av_get_pts_from_frame(context->iFormatCtx, in_frame);
 
-  for (i = 0; i < context->num_proxy_sizes; i++) {
-    add_to_proxy_output_ffmpeg(context->proxy_ctx[i], in_frame);
-  }
+  /* Every proxy size has its own scaler and encoder, so the frame is decoded once and the sizes
+   * are scaled and encoded in parallel. The decoded frame is only read, except for its pts which
+   * is set by the single proxy that can encode it without scaling. Waiting for all sizes before
+   * returning is needed since the decoder reuses `in_frame` for the next packet. */
+  FFmpegProxyOutputData data = {
+      .proxy_ctx = context->proxy_ctx,
+      .in_frame = in_frame,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = count_bits_i(context->proxy_sizes_in_use) > 1;
+  BLI_task_parallel_range(
+      0, context->num_proxy_sizes, &data, index_rebuild_ffmpeg_proxy_output, &settings);
 
   if (!context->start_pts_set) {
     context->start_pts = pts;
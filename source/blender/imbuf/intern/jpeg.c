@@ -54,7 +54,11 @@ static void skip_input_data(j_decompress_ptr cinfo, long num_bytes);
 static void term_source(j_decompress_ptr cinfo);
 static void memory_source(j_decompress_ptr cinfo, const unsigned char *buffer, size_t size);
 static boolean handle_app1(j_decompress_ptr cinfo);
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags);
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo,
+                                   int flags,
+                                   int max_size,
+                                   size_t *r_width,
+                                   size_t *r_height);
 
 static const uchar jpeg_default_quality = 75;
 static uchar ibuf_quality;
@@ -261,7 +265,16 @@ static boolean handle_app1(j_decompress_ptr cinfo)
   return true;
 }
 
-static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int flags)
+/**
+ * \param max_size: When non-zero, let the decoder scale the image down in the DCT domain as far
+ * as possible while keeping it at least this large, as it's only used for a thumbnail.
+ * \param r_width, r_height: Optionally return the full resolution of the image.
+ */
+static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo,
+                                   int flags,
+                                   int max_size,
+                                   size_t *r_width,
+                                   size_t *r_height)
 {
   JSAMPARRAY row_pointer;
   JSAMPLE *buffer = NULL;
@@ -279,16 +292,37 @@ static ImBuf *ibJpegImageFromCinfo(struct jpeg_decompress_struct *cinfo, int fla
   jpeg_save_markers(cinfo, JPEG_COM, 0xffff);
 
   if (jpeg_read_header(cinfo, false) == JPEG_HEADER_OK) {
-    x = cinfo->image_width;
-    y = cinfo->image_height;
     depth = cinfo->num_components;
 
+    if (r_width) {
+      *r_width = cinfo->image_width;
+    }
+    if (r_height) {
+      *r_height = cinfo->image_height;
+    }
+
     if (cinfo->jpeg_color_space == JCS_YCCK) {
       cinfo->out_color_space = JCS_CMYK;
     }
 
+    if (max_size > 0 && (flags & IB_test) == 0) {
+      /* Scaling by M/8 is done while decoding, skipping most of the work for large images. */
+      const unsigned int image_size = MAX2(cinfo->image_width, cinfo->image_height);
+      unsigned int scale_num = 1;
+      while (scale_num < 8 && image_size * scale_num < (unsigned int)max_size * 8) {
+        scale_num++;
+      }
+      cinfo->scale_num = scale_num;
+      cinfo->scale_denom = 8;
+      cinfo->dct_method = JDCT_IFAST;
+      cinfo->do_fancy_upsampling = false;
+    }
+
     jpeg_start_decompress(cinfo);
 
+    x = cinfo->output_width;
+    y = cinfo->output_height;
+
     if (flags & IB_test) {
       jpeg_abort_decompress(cinfo);
       ibuf = IMB_allocImBuf(x, y, 8 * depth, 0);
@@ -464,7 +498,184 @@ ImBuf *imb_load_jpeg(const unsigned char *buffer,
   jpeg_create_decompress(cinfo);
   memory_source(cinfo, buffer, size);
 
-  ibuf = ibJpegImageFromCinfo(cinfo, flags);
+  ibuf = ibJpegImageFromCinfo(cinfo, flags, 0, NULL, NULL);
+
+  return ibuf;
+}
+
+static unsigned int jpeg_exif_read_uint(const uchar *data, const bool is_big_endian, int bytes)
+{
+  unsigned int value = 0;
+  for (int i = 0; i < bytes; i++) {
+    value |= (unsigned int)data[is_big_endian ? i : bytes - 1 - i] << (8 * (bytes - 1 - i));
+  }
+  return value;
+}
+
+/**
+ * Find the thumbnail in Exif data (the contents of the APP1 marker after the "Exif" header).
+ * It's stored as a complete JPEG stream, referenced by the second image file directory.
+ */
+static ImBuf *jpeg_exif_thumbnail_load(const uchar *tiff, const size_t tiff_size)
+{
+  if (tiff_size < 8) {
+    return NULL;
+  }
+
+  bool is_big_endian;
+  if (tiff[0] == 'M' && tiff[1] == 'M') {
+    is_big_endian = true;
+  }
+  else if (tiff[0] == 'I' && tiff[1] == 'I') {
+    is_big_endian = false;
+  }
+  else {
+    return NULL;
+  }
+
+  /* Skip the main image directory, the thumbnail is described by the one following it. */
+  size_t ifd_offset = jpeg_exif_read_uint(tiff + 4, is_big_endian, 4);
+  if (ifd_offset + 2 > tiff_size) {
+    return NULL;
+  }
+  const size_t ifd0_entries = jpeg_exif_read_uint(tiff + ifd_offset, is_big_endian, 2);
+  const size_t ifd0_end = ifd_offset + 2 + ifd0_entries * 12;
+  if (ifd0_end + 4 > tiff_size) {
+    return NULL;
+  }
+  ifd_offset = jpeg_exif_read_uint(tiff + ifd0_end, is_big_endian, 4);
+  if (ifd_offset == 0 || ifd_offset + 2 > tiff_size) {
+    return NULL;
+  }
+
+  const size_t ifd1_entries = jpeg_exif_read_uint(tiff + ifd_offset, is_big_endian, 2);
+  size_t thumb_offset = 0, thumb_size = 0;
+  for (size_t i = 0; i < ifd1_entries; i++) {
+    const uchar *entry = tiff + ifd_offset + 2 + i * 12;
+    if (entry + 12 > tiff + tiff_size) {
+      return NULL;
+    }
+    const unsigned int tag = jpeg_exif_read_uint(entry, is_big_endian, 2);
+    /* JPEGInterchangeFormat and JPEGInterchangeFormatLength, both of type LONG. */
+    if (tag == 0x0201) {
+      thumb_offset = jpeg_exif_read_uint(entry + 8, is_big_endian, 4);
+    }
+    else if (tag == 0x0202) {
+      thumb_size = jpeg_exif_read_uint(entry + 8, is_big_endian, 4);
+    }
+  }
+
+  if (thumb_offset == 0 || thumb_size == 0 || thumb_offset + thumb_size > tiff_size) {
+    return NULL;
+  }
+
+  char colorspace[IM_MAX_SPACE] = "";
+  return imb_load_jpeg(tiff + thumb_offset, thumb_size, IB_rect, colorspace);
+}
+
+/**
+ * Look for an Exif thumbnail in the application markers at the start of the file.
+ * Leaves the file position undefined.
+ */
+static ImBuf *jpeg_exif_thumbnail_from_file(FILE *infile)
+{
+  uchar marker[4];
+
+  if (fread(marker, 1, 2, infile) != 2 || marker[0] != 0xFF || marker[1] != 0xD8) {
+    return NULL;
+  }
+
+  /* Application markers come right after the start of image. */
+  while (fread(marker, 1, 4, infile) == 4 && marker[0] == 0xFF && marker[1] >= JPEG_APP0 &&
+         marker[1] <= JPEG_APP0 + 15) {
+    const size_t length = ((size_t)marker[2] << 8 | marker[3]);
+    if (length < 2) {
+      return NULL;
+    }
+    const size_t data_size = length - 2;
+
+    if (marker[1] != JPEG_APP0 + 1) {
+      if (fseek(infile, (long)data_size, SEEK_CUR) != 0) {
+        return NULL;
+      }
+      continue;
+    }
+
+    uchar *data = MEM_mallocN(data_size, __func__);
+    ImBuf *ibuf = NULL;
+    if (fread(data, 1, data_size, infile) == data_size && data_size > 6 &&
+        memcmp(data, "Exif\0\0", 6) == 0) {
+      ibuf = jpeg_exif_thumbnail_load(data + 6, data_size - 6);
+    }
+    MEM_freeN(data);
+
+    if (ibuf) {
+      return ibuf;
+    }
+  }
+
+  return NULL;
+}
+
+ImBuf *imb_thumbnail_jpeg(const char *filepath,
+                          const int flags,
+                          const size_t max_thumb_size,
+                          char colorspace[IM_MAX_SPACE],
+                          size_t *r_width,
+                          size_t *r_height)
+{
+  struct jpeg_decompress_struct _cinfo, *cinfo = &_cinfo;
+  struct my_error_mgr jerr;
+  FILE *infile;
+  ImBuf *ibuf;
+
+  if ((infile = BLI_fopen(filepath, "rb")) == NULL) {
+    return NULL;
+  }
+
+  /* Use the thumbnail stored by cameras when it's large enough. It's generally 160x120, so this
+   * mostly applies to small thumbnail sizes, larger ones would look blurry when scaled up. */
+  ibuf = jpeg_exif_thumbnail_from_file(infile);
+  if (ibuf && MAX2(ibuf->x, ibuf->y) < (int)max_thumb_size) {
+    IMB_freeImBuf(ibuf);
+    ibuf = NULL;
+  }
+  rewind(infile);
+
+  colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+
+  cinfo->err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = jpeg_error;
+
+  /* Establish the setjmp return context for my_error_exit to use. */
+  if (setjmp(jerr.setjmp_buffer)) {
+    /* If we get here, the JPEG code has signaled an error.
+     * We need to clean up the JPEG object, close the input file, and return.
+     */
+    jpeg_destroy_decompress(cinfo);
+    fclose(infile);
+    if (ibuf) {
+      IMB_freeImBuf(ibuf);
+    }
+    return NULL;
+  }
+
+  jpeg_create_decompress(cinfo);
+  jpeg_stdio_src(cinfo, infile);
+
+  if (ibuf) {
+    /* Only the resolution of the full image is needed. */
+    if (jpeg_read_header(cinfo, false) == JPEG_HEADER_OK) {
+      *r_width = cinfo->image_width;
+      *r_height = cinfo->image_height;
+    }
+    jpeg_destroy_decompress(cinfo);
+  }
+  else {
+    ibuf = ibJpegImageFromCinfo(cinfo, flags, (int)max_thumb_size, r_width, r_height);
+  }
+
+  fclose(infile);
 
   return ibuf;
 }
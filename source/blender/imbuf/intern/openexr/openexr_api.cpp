@@ -42,6 +42,8 @@
 #include <ImfInputFile.h>
 #include <ImfOutputFile.h>
 #include <ImfPixelType.h>
+#include <ImfPreviewImage.h>
+#include <ImfRgbaFile.h>
 #include <ImfStandardAttributes.h>
 #include <ImfStringAttribute.h>
 #include <ImfVersion.h>
@@ -56,6 +58,7 @@
 #include <ImfPartHelper.h>
 #include <ImfPartType.h>
 #include <ImfTiledOutputPart.h>
+#include <ImfTiledRgbaFile.h>
 
 #include "DNA_scene_types.h" /* For OpenEXR compression constants */
 
@@ -78,6 +81,7 @@ _CRTIMP void __cdecl _invalid_parameter_noinfo(void)
 }
 #include "BLI_blenlib.h"
 #include "BLI_math_color.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_idprop.h"
@@ -135,6 +139,24 @@ class IMemStream : public Imf::IStream {
     return false;
   }
 
+  /* The whole file is in memory already, let the library decode pixel data in place
+   * instead of copying every chunk into a temporary buffer first. */
+  bool isMemoryMapped() const override
+  {
+    return true;
+  }
+
+  char *readMemoryMapped(int n) override
+  {
+    if (n + _exrpos > _exrsize) {
+      throw Iex::InputExc("Unexpected end of file.");
+    }
+
+    char *data = (char *)&_exrbuf[_exrpos];
+    _exrpos += n;
+    return data;
+  }
+
   Int64 tellg() override
   {
     return _exrpos;
@@ -412,6 +434,48 @@ static void openexr_header_metadata_callback(void *data,
   header->insert(propname, StringAttribute(prop));
 }
 
+struct ExrHalfConvertData {
+  const ImBuf *ibuf;
+  RGBAZ *pixels;
+};
+
+/* Convert one row of the image to half, rows are written flipped. */
+static void imb_exr_half_convert_row(void *__restrict userdata,
+                                     const int y,
+                                     const TaskParallelTLS *__restrict /*tls*/)
+{
+  const ExrHalfConvertData *data = (const ExrHalfConvertData *)userdata;
+  const ImBuf *ibuf = data->ibuf;
+  const int channels = ibuf->channels;
+  const size_t width = ibuf->x;
+  RGBAZ *to = data->pixels + (ibuf->y - 1 - y) * width;
+
+  if (ibuf->rect_float) {
+    const float *from = ibuf->rect_float + channels * y * width;
+
+    for (size_t x = 0; x < width; x++) {
+      to->r = float_to_half_safe(from[0]);
+      to->g = float_to_half_safe((channels >= 2) ? from[1] : from[0]);
+      to->b = float_to_half_safe((channels >= 3) ? from[2] : from[0]);
+      to->a = float_to_half_safe((channels >= 4) ? from[3] : 1.0f);
+      to++;
+      from += channels;
+    }
+  }
+  else {
+    const unsigned char *from = (const unsigned char *)ibuf->rect + 4 * y * width;
+
+    for (size_t x = 0; x < width; x++) {
+      to->r = srgb_to_linearrgb((float)from[0] / 255.0f);
+      to->g = srgb_to_linearrgb((float)from[1] / 255.0f);
+      to->b = srgb_to_linearrgb((float)from[2] / 255.0f);
+      to->a = channels >= 4 ? (float)from[3] / 255.0f : 1.0f;
+      to++;
+      from += 4;
+    }
+  }
+}
+
 static bool imb_save_openexr_half(ImBuf *ibuf, const char *name, const int flags)
 {
   const int channels = ibuf->channels;
@@ -470,38 +534,15 @@ static bool imb_save_openexr_half(ImBuf *ibuf, const char *name, const int flags
                                sizeof(float),
                                sizeof(float) * -width));
     }
-    if (ibuf->rect_float) {
-      float *from;
 
-      for (int i = ibuf->y - 1; i >= 0; i--) {
-        from = ibuf->rect_float + channels * i * width;
+    ExrHalfConvertData convert_data;
+    convert_data.ibuf = ibuf;
+    convert_data.pixels = to;
 
-        for (int j = ibuf->x; j > 0; j--) {
-          to->r = float_to_half_safe(from[0]);
-          to->g = float_to_half_safe((channels >= 2) ? from[1] : from[0]);
-          to->b = float_to_half_safe((channels >= 3) ? from[2] : from[0]);
-          to->a = float_to_half_safe((channels >= 4) ? from[3] : 1.0f);
-          to++;
-          from += channels;
-        }
-      }
-    }
-    else {
-      unsigned char *from;
-
-      for (int i = ibuf->y - 1; i >= 0; i--) {
-        from = (unsigned char *)ibuf->rect + 4 * i * width;
-
-        for (int j = ibuf->x; j > 0; j--) {
-          to->r = srgb_to_linearrgb((float)from[0] / 255.0f);
-          to->g = srgb_to_linearrgb((float)from[1] / 255.0f);
-          to->b = srgb_to_linearrgb((float)from[2] / 255.0f);
-          to->a = channels >= 4 ? (float)from[3] / 255.0f : 1.0f;
-          to++;
-          from += 4;
-        }
-      }
-    }
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    settings.min_iter_per_thread = 16;
+    BLI_task_parallel_range(0, height, &convert_data, imb_exr_half_convert_row, &settings);
 
     exr_printf("OpenEXR-save: Writing OpenEXR file of height %d.\n", height);
 
@@ -1098,6 +1139,27 @@ void IMB_exr_clear_channels(void *handle)
   BLI_freelistN(&data->channels);
 }
 
+struct ExrChannelHalfConvertData {
+  const float *rect;
+  int xstride;
+  int width;
+  half *rect_half;
+};
+
+static void imb_exr_channel_half_convert_row(void *__restrict userdata,
+                                             const int y,
+                                             const TaskParallelTLS *__restrict /*tls*/)
+{
+  const ExrChannelHalfConvertData *data = (const ExrChannelHalfConvertData *)userdata;
+  const size_t offset = (size_t)y * data->width;
+  const float *rect = data->rect + offset * data->xstride;
+  half *cur = data->rect_half + offset;
+
+  for (int x = 0; x < data->width; x++, cur++, rect += data->xstride) {
+    *cur = float_to_half_safe(*rect);
+  }
+}
+
 void IMB_exr_write_channels(void *handle)
 {
   ExrHandle *data = (ExrHandle *)handle;
@@ -1118,11 +1180,18 @@ void IMB_exr_write_channels(void *handle)
     for (echan = (ExrChannel *)data->channels.first; echan; echan = echan->next) {
       /* Writing starts from last scanline, stride negative. */
       if (echan->use_half_float) {
-        float *rect = echan->rect;
-        half *cur = current_rect_half;
-        for (size_t i = 0; i < num_pixels; i++, cur++) {
-          *cur = float_to_half_safe(rect[i * echan->xstride]);
-        }
+        ExrChannelHalfConvertData convert_data;
+        convert_data.rect = echan->rect;
+        convert_data.xstride = echan->xstride;
+        convert_data.width = data->width;
+        convert_data.rect_half = current_rect_half;
+
+        TaskParallelSettings settings;
+        BLI_parallel_range_settings_defaults(&settings);
+        settings.min_iter_per_thread = 16;
+        BLI_task_parallel_range(
+            0, data->height, &convert_data, imb_exr_channel_half_convert_row, &settings);
+
         half *rect_to_write = current_rect_half + (data->height - 1L) * data->width;
         frameBuffer.insert(
             echan->name,
@@ -1235,7 +1304,8 @@ void IMB_exr_read_channels(void *handle)
     Header header = in.header();
     Box2i dw = header.dataWindow();
 
-    /* Insert all matching channel into frame-buffer. */
+    /* Insert all matching channel into frame-buffer. Channels without a buffer are not
+     * requested by the caller, like passes of other layers when reading a single layer. */
     FrameBuffer frameBuffer;
     ExrChannel *echan;
 
@@ -1271,10 +1341,15 @@ void IMB_exr_read_channels(void *handle)
                            Slice(Imf::FLOAT, (char *)rect, xstride, ystride));
       }
       else {
-        printf("warning, channel with no rect set %s\n", echan->m->internal_name.c_str());
+        exr_printf("skipping channel with no rect set %s\n", echan->m->internal_name.c_str());
       }
     }
 
+    /* Don't decode parts of which no channels were requested. */
+    if (frameBuffer.begin() == frameBuffer.end()) {
+      continue;
+    }
+
     /* Read pixels. */
     try {
       in.setFrameBuffer(frameBuffer);
@@ -2096,6 +2171,193 @@ struct ImBuf *imb_load_openexr(const unsigned char *mem,
   }
 }
 
+/* Thumbnail from the preview image OpenEXR files can store in their header. */
+static ImBuf *exr_thumbnail_from_preview(const PreviewImage &preview)
+{
+  const int width = preview.width();
+  const int height = preview.height();
+  ImBuf *ibuf = IMB_allocImBuf(width, height, 32, IB_rect);
+  if (ibuf == nullptr) {
+    return nullptr;
+  }
+
+  /* Preview rows are stored top to bottom. */
+  const PreviewRgba *pixels = preview.pixels();
+  for (int y = 0; y < height; y++) {
+    const PreviewRgba *src = pixels + (size_t)(height - 1 - y) * width;
+    unsigned char *dst = (unsigned char *)(ibuf->rect + (size_t)y * width);
+    for (int x = 0; x < width; x++, src++, dst += 4) {
+      dst[0] = src->r;
+      dst[1] = src->g;
+      dst[2] = src->b;
+      dst[3] = src->a;
+    }
+  }
+
+  return ibuf;
+}
+
+/* Fill the float thumbnail by nearest neighbor sampling of the source. Source rows are
+ * requested through `read_row`, which returns the row of pixels for a thumbnail row. */
+template<typename ReadRowFn>
+static void exr_thumbnail_sample(ImBuf *ibuf,
+                                 int source_w,
+                                 int source_h,
+                                 const ReadRowFn &read_row)
+{
+  const int dest_w = ibuf->x;
+  const int dest_h = ibuf->y;
+
+  for (int h = 0; h < dest_h; h++) {
+    /* File rows are stored top to bottom. */
+    const int source_y = std::min((int)((int64_t)h * source_h / dest_h), source_h - 1);
+    const Rgba *row = read_row(source_y);
+    float *dest_px = ibuf->rect_float + (size_t)(dest_h - 1 - h) * dest_w * 4;
+    for (int w = 0; w < dest_w; w++, dest_px += 4) {
+      const int source_x = std::min((int)((int64_t)w * source_w / dest_w), source_w - 1);
+      const Rgba &px = row[source_x];
+      dest_px[0] = px.r;
+      dest_px[1] = px.g;
+      dest_px[2] = px.b;
+      dest_px[3] = px.a;
+    }
+  }
+}
+
+/* Find the layer to read the thumbnail from, an empty name for the channels without a layer.
+ * Multilayer files such as render results may have no such channels, then the first layer with
+ * color channels is used, preferring the combined pass. Returns false when there is none. */
+static bool exr_thumbnail_layer(MultiPartInputFile &file, std::string &r_layer_name)
+{
+  const ChannelList &channels = file.header(0).channels();
+  r_layer_name.clear();
+
+  if (!imb_exr_is_multi(file) || channels.findChannel("R") || channels.findChannel("Y")) {
+    return true;
+  }
+
+  std::set<std::string> layer_names;
+  channels.layers(layer_names);
+
+  bool found = false;
+  for (const std::string &layer_name : layer_names) {
+    if (!channels.findChannel(layer_name + ".R")) {
+      continue;
+    }
+    if (!found) {
+      r_layer_name = layer_name;
+      found = true;
+    }
+    if (BLI_str_endswith(layer_name.c_str(), "Combined")) {
+      r_layer_name = layer_name;
+      break;
+    }
+  }
+  return found;
+}
+
+struct ImBuf *imb_load_filepath_thumbnail_openexr(const char *filepath,
+                                                  const int flags,
+                                                  const size_t max_thumb_size,
+                                                  char colorspace[],
+                                                  size_t *r_width,
+                                                  size_t *r_height)
+{
+  ImBuf *ibuf = nullptr;
+
+  try {
+    std::string layer_name;
+    {
+      IFileStream multi_stream(filepath);
+      MultiPartInputFile multi_file(multi_stream);
+      if (!exr_thumbnail_layer(multi_file, layer_name)) {
+        return nullptr;
+      }
+    }
+
+    IFileStream stream(filepath);
+    RgbaInputFile file(stream, layer_name);
+
+    if (!file.isComplete()) {
+      return nullptr;
+    }
+
+    const Header &header = file.header();
+    const Box2i dw = file.dataWindow();
+    const int source_w = dw.max.x - dw.min.x + 1;
+    const int source_h = dw.max.y - dw.min.y + 1;
+    *r_width = source_w;
+    *r_height = source_h;
+
+    /* A preview embedded in the file doesn't need any decoding, when it's large enough. */
+    if (header.hasPreviewImage() &&
+        std::max(header.previewImage().width(), header.previewImage().height()) >=
+            max_thumb_size) {
+      colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_BYTE);
+      return exr_thumbnail_from_preview(header.previewImage());
+    }
+
+    colorspace_set_default_role(colorspace, IM_MAX_SPACE, COLOR_ROLE_DEFAULT_FLOAT);
+
+    const float scale_factor = std::min(1.0f,
+                                        std::min((float)max_thumb_size / (float)source_w,
+                                                 (float)max_thumb_size / (float)source_h));
+    const int dest_w = std::max((int)(source_w * scale_factor), 1);
+    const int dest_h = std::max((int)(source_h * scale_factor), 1);
+    ibuf = IMB_allocImBuf(dest_w, dest_h, 32, IB_rectfloat);
+    if (ibuf == nullptr) {
+      return nullptr;
+    }
+
+    if (header.hasTileDescription() && header.tileDescription().mode != ONE_LEVEL) {
+      /* Read the smallest mipmap level that is still at least as large as the thumbnail. */
+      IFileStream tiled_stream(filepath);
+      TiledRgbaInputFile tiled_file(tiled_stream, layer_name);
+      int level = 0;
+      while (level + 1 < std::min(tiled_file.numXLevels(), tiled_file.numYLevels()) &&
+             tiled_file.levelWidth(level + 1) >= dest_w &&
+             tiled_file.levelHeight(level + 1) >= dest_h) {
+        level++;
+      }
+
+      const int level_w = tiled_file.levelWidth(level);
+      const int level_h = tiled_file.levelHeight(level);
+      Array2D<Rgba> pixels(level_h, level_w);
+      tiled_file.setFrameBuffer(&pixels[0][0] - dw.min.x - dw.min.y * level_w, 1, level_w);
+      tiled_file.readTiles(0,
+                           tiled_file.numXTiles(level) - 1,
+                           0,
+                           tiled_file.numYTiles(level) - 1,
+                           level,
+                           level);
+
+      exr_thumbnail_sample(
+          ibuf, level_w, level_h, [&](int y) -> const Rgba * { return pixels[y]; });
+    }
+    else {
+      /* Only read the rows that end up in the thumbnail. */
+      Array<Rgba> pixels(source_w);
+      exr_thumbnail_sample(ibuf, source_w, source_h, [&](int y) -> const Rgba * {
+        file.setFrameBuffer(&pixels[0] - dw.min.x - (dw.min.y + y) * source_w, 1, source_w);
+        file.readPixels(dw.min.y + y);
+        return &pixels[0];
+      });
+    }
+
+    if (flags & IB_alphamode_detect) {
+      ibuf->flags |= IB_alphamode_premul;
+    }
+    return ibuf;
+  }
+  catch (const std::exception &exc) {
+    std::cerr << exc.what() << std::endl;
+    if (ibuf) {
+      IMB_freeImBuf(ibuf);
+    }
+    return nullptr;
+  }
+}
+
 void imb_initopenexr(void)
 {
   int num_threads = BLI_system_thread_count();
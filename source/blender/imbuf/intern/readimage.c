@@ -39,6 +39,8 @@
 #include "IMB_filetype.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
+#include "IMB_metadata.h"
+#include "IMB_thumbs.h"
 #include "imbuf.h"
 
 #include "IMB_colormanagement.h"
@@ -251,6 +253,55 @@ ImBuf *IMB_loadiffname(const char *filepath, int flags, char colorspace[IM_MAX_S
   return ibuf;
 }
 
+ImBuf *IMB_thumb_load_image(const char *filepath,
+                            const size_t max_thumb_size,
+                            char colorspace[IM_MAX_SPACE])
+{
+  const ImFileType *type = IMB_file_type_from_ftype(IMB_ispic_type(filepath));
+  ImBuf *ibuf = NULL;
+  const int flags = IB_rect | IB_metadata;
+  /* Resolution of the full image. */
+  size_t width = 0, height = 0;
+
+  if (type && type->load_filepath_thumbnail) {
+    char effective_colorspace[IM_MAX_SPACE] = "";
+    if (colorspace) {
+      BLI_strncpy(effective_colorspace, colorspace, sizeof(effective_colorspace));
+    }
+
+    ibuf = type->load_filepath_thumbnail(
+        filepath, flags, max_thumb_size, effective_colorspace, &width, &height);
+    if (ibuf) {
+      imb_handle_alpha(ibuf, flags, colorspace, effective_colorspace);
+    }
+  }
+  else {
+    /* Formats without reduced resolution loading are skipped above a file size. */
+    const size_t file_size = BLI_file_size(filepath);
+    if (file_size != -1 && file_size > THUMB_SIZE_MAX) {
+      return NULL;
+    }
+
+    ibuf = IMB_loadiffname(filepath, flags, colorspace);
+    if (ibuf) {
+      width = ibuf->x;
+      height = ibuf->y;
+    }
+  }
+
+  if (ibuf && width > 0 && height > 0) {
+    /* The thumbnail may be smaller than the image, store the resolution of the image. */
+    char cwidth[40], cheight[40];
+    BLI_snprintf(cwidth, sizeof(cwidth), "%zu", width);
+    BLI_snprintf(cheight, sizeof(cheight), "%zu", height);
+    IMB_metadata_ensure(&ibuf->metadata);
+    IMB_metadata_set_field(ibuf->metadata, "Thumb::Image::Width", cwidth);
+    IMB_metadata_set_field(ibuf->metadata, "Thumb::Image::Height", cheight);
+  }
+
+  return ibuf;
+}
+
 ImBuf *IMB_testiffname(const char *filepath, int flags)
 {
   ImBuf *ibuf;
@@ -24,8 +24,10 @@
 
 #include <math.h>
 
+#include "BLI_math_base.h"
 #include "BLI_math_color.h"
 #include "BLI_math_interp.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "MEM_guardedalloc.h"
 
@@ -908,645 +910,403 @@ static bool q_scale_linear_interpolation(struct ImBuf *ibuf, int newx, int newy)
   return true;
 }
 
-static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
-{
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
+/* ******** separable scaling ********
+ *
+ * Each pass scales along one axis. Sample positions only depend on the size along that axis,
+ * so they are computed once into a table and lines are then processed in parallel. The y passes
+ * walk output rows, so the innermost loops run over contiguous memory and can be vectorized.
+ * Results are identical to scanning each line with a running sample position. */
+
+/* Box filter sample for down-scaling, covering parts of `prev` and `last` pixels and all
+ * `num` pixels starting at `first`. */
+typedef struct ScaleDownSample {
+  int prev;
+  int first;
+  int num;
+  int last;
+  float prev_weight;
+  float last_weight;
+} ScaleDownSample;
+
+/* Linear interpolation between two pixels for up-scaling. */
+typedef struct ScaleUpSample {
+  int prev;
+  int next;
+  float weight;
+} ScaleUpSample;
 
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y;
+static ScaleDownSample *scale_down_samples_create(int size, int newsize, float *r_add)
+{
+  ScaleDownSample *samples = MEM_mallocN(sizeof(ScaleDownSample) * newsize, __func__);
+  const float add = (size - 0.01) / newsize;
+  float sample = 0.0f;
+  int prev = -1;
+  int i = 0;
+
+  for (int j = 0; j < newsize; j++) {
+    ScaleDownSample *s = &samples[j];
+    s->prev = prev;
+    s->prev_weight = sample;
+    s->first = i;
+    s->num = 0;
+
+    sample += add;
+    while (sample >= 1.0f) {
+      sample -= 1.0f;
+      s->num++;
+      i++;
+    }
 
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
+    s->last = min_ii(i, size - 1);
+    s->last_weight = sample;
+    i++;
 
-  if (!do_rect && !do_float) {
-    return ibuf;
+    prev = s->last;
+    sample -= 1.0f;
   }
 
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newx * ibuf->y, "scaledownx");
-    if (_newrect == NULL) {
-      return ibuf;
-    }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaledownxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
+  BLI_assert(i == size); /* see bug T26502. */
+  /* Guard against reading past the end of the line when the assert above fails. */
+  samples[newsize - 1].num = min_ii(samples[newsize - 1].num, size - samples[newsize - 1].first);
 
-  add = (ibuf->x - 0.01) / newx;
+  *r_add = add;
+  return samples;
+}
 
-  if (do_rect) {
-    rect = (uchar *)ibuf->rect;
-    newrect = _newrect;
-  }
-  if (do_float) {
-    rectf = ibuf->rect_float;
-    newrectf = _newrectf;
+static ScaleUpSample *scale_up_samples_create(int size, int newsize)
+{
+  ScaleUpSample *samples = MEM_mallocN(sizeof(ScaleUpSample) * newsize, __func__);
+  const float add = (size - 1.001) / (newsize - 1.0);
+  float sample = 0.0f;
+  int prev = 0;
+  int next = 1;
+
+  for (int j = 0; j < newsize; j++) {
+    if (sample >= 1.0f) {
+      sample -= 1.0f;
+      prev = next;
+      next++;
+    }
+    samples[j].prev = min_ii(prev, size - 1);
+    samples[j].next = min_ii(next, size - 1);
+    samples[j].weight = sample;
+    sample += add;
   }
 
-  for (y = ibuf->y; y > 0; y--) {
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (x = newx; x > 0; x--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
-      }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
-      }
+  return samples;
+}
 
-      sample += add;
+typedef struct ScaleData {
+  const uchar *rect;
+  const float *rectf;
+  uchar *newrect;
+  float *newrectf;
+  /* Size of the source buffer. */
+  int x, y;
+  /* Size of the scaled axis. */
+  int newsize;
+  const ScaleDownSample *down_samples;
+  const ScaleUpSample *up_samples;
+  float add;
+} ScaleData;
+
+static void scale_parallel_range_settings(TaskParallelSettings *settings)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->min_iter_per_thread = 8;
+}
 
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
+static void scale_parallel_range(int num, ScaleData *data, TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  scale_parallel_range_settings(&settings);
+  BLI_task_parallel_range(0, num, data, func, &settings);
+}
 
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += 4;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += 4;
+static void scaledownx_line_fn(void *__restrict userdata,
+                               const int y,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleData *data = userdata;
+  const float add = data->add;
+
+  for (int x = 0; x < data->newsize; x++) {
+    const ScaleDownSample *s = &data->down_samples[x];
+
+    if (data->rect) {
+      const uchar *rect = data->rect + (size_t)4 * y * data->x;
+      uchar *newrect = data->newrect + (size_t)4 * (y * data->newsize + x);
+      for (int c = 0; c < 4; c++) {
+        float nval = (s->prev != -1) ? -(float)rect[4 * s->prev + c] * s->prev_weight : 0.0f;
+        for (int i = s->first; i < s->first + s->num; i++) {
+          nval += rect[4 * i + c];
         }
+        newrect[c] = roundf((nval + s->last_weight * rect[4 * s->last + c]) / add);
       }
-
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += 4;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += 4;
-      }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += 4;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += 4;
+    }
+    if (data->rectf) {
+      const float *rectf = data->rectf + (size_t)4 * y * data->x;
+      float *newrectf = data->newrectf + (size_t)4 * (y * data->newsize + x);
+      for (int c = 0; c < 4; c++) {
+        float nval = (s->prev != -1) ? -rectf[4 * s->prev + c] * s->prev_weight : 0.0f;
+        for (int i = s->first; i < s->first + s->num; i++) {
+          nval += rectf[4 * i + c];
+        }
+        newrectf[c] = (nval + s->last_weight * rectf[4 * s->last + c]) / add;
       }
-
-      sample -= 1.0f;
     }
   }
+}
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = _newrectf;
-  }
-  (void)rect_size; /* UNUSED in release builds */
+/* Row of sums for byte images, allocated once per chunk of rows of a thread. */
+typedef struct ScaleDownYChunk {
+  float *nval;
+} ScaleDownYChunk;
 
-  ibuf->x = newx;
-  return ibuf;
+static void scaledowny_chunk_free(const void *__restrict UNUSED(userdata),
+                                  void *__restrict chunk_v)
+{
+  ScaleDownYChunk *chunk = chunk_v;
+  MEM_SAFE_FREE(chunk->nval);
 }
 
-static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+static void scaledowny_line_fn(void *__restrict userdata,
+                               const int y,
+                               const TaskParallelTLS *__restrict tls)
 {
-  const int do_rect = (ibuf->rect != NULL);
-  const int do_float = (ibuf->rect_float != NULL);
-  const size_t rect_size = ibuf->x * ibuf->y * 4;
-
-  uchar *rect, *_newrect, *newrect;
-  float *rectf, *_newrectf, *newrectf;
-  float sample, add, val[4], nval[4], valf[4], nvalf[4];
-  int x, y, skipx;
-
-  rectf = _newrectf = newrectf = NULL;
-  rect = _newrect = newrect = NULL;
-  nval[0] = nval[1] = nval[2] = nval[3] = 0.0f;
-  nvalf[0] = nvalf[1] = nvalf[2] = nvalf[3] = 0.0f;
-
-  if (!do_rect && !do_float) {
-    return ibuf;
-  }
-
-  if (do_rect) {
-    _newrect = MEM_mallocN(sizeof(uchar[4]) * newy * ibuf->x, "scaledowny");
-    if (_newrect == NULL) {
-      return ibuf;
+  const ScaleData *data = userdata;
+  const ScaleDownSample *s = &data->down_samples[y];
+  const size_t stride = (size_t)4 * data->x;
+  const float add = data->add;
+
+  if (data->rect) {
+    ScaleDownYChunk *chunk = tls->userdata_chunk;
+    if (chunk->nval == NULL) {
+      chunk->nval = MEM_mallocN(sizeof(float) * stride, __func__);
     }
-  }
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newy * ibuf->x, "scaledownyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
+    float *nval = chunk->nval;
+    const uchar *last = data->rect + stride * s->last;
+    uchar *newrect = data->newrect + stride * y;
+
+    if (s->prev != -1) {
+      const uchar *prev = data->rect + stride * s->prev;
+      for (size_t i = 0; i < stride; i++) {
+        nval[i] = -(float)prev[i] * s->prev_weight;
       }
-      return ibuf;
     }
-  }
-
-  add = (ibuf->y - 0.01) / newy;
-  skipx = 4 * ibuf->x;
-
-  for (x = skipx - 4; x >= 0; x -= 4) {
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + x;
-      newrect = _newrect + x;
+    else {
+      for (size_t i = 0; i < stride; i++) {
+        nval[i] = 0.0f;
+      }
     }
-    if (do_float) {
-      rectf = ibuf->rect_float + x;
-      newrectf = _newrectf + x;
+    for (int row = s->first; row < s->first + s->num; row++) {
+      const uchar *rect = data->rect + stride * row;
+      for (size_t i = 0; i < stride; i++) {
+        nval[i] += rect[i];
+      }
     }
+    for (size_t i = 0; i < stride; i++) {
+      newrect[i] = roundf((nval[i] + s->last_weight * last[i]) / add);
+    }
+  }
+  if (data->rectf) {
+    /* Accumulate straight into the output row. */
+    float *nval = data->newrectf + stride * y;
+    const float *last = data->rectf + stride * s->last;
 
-    sample = 0.0f;
-    val[0] = val[1] = val[2] = val[3] = 0.0f;
-    valf[0] = valf[1] = valf[2] = valf[3] = 0.0f;
-
-    for (y = newy; y > 0; y--) {
-      if (do_rect) {
-        nval[0] = -val[0] * sample;
-        nval[1] = -val[1] * sample;
-        nval[2] = -val[2] * sample;
-        nval[3] = -val[3] * sample;
+    if (s->prev != -1) {
+      const float *prev = data->rectf + stride * s->prev;
+      for (size_t i = 0; i < stride; i++) {
+        nval[i] = -prev[i] * s->prev_weight;
       }
-      if (do_float) {
-        nvalf[0] = -valf[0] * sample;
-        nvalf[1] = -valf[1] * sample;
-        nvalf[2] = -valf[2] * sample;
-        nvalf[3] = -valf[3] * sample;
+    }
+    else {
+      for (size_t i = 0; i < stride; i++) {
+        nval[i] = 0.0f;
       }
-
-      sample += add;
-
-      while (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          nval[0] += rect[0];
-          nval[1] += rect[1];
-          nval[2] += rect[2];
-          nval[3] += rect[3];
-          rect += skipx;
-        }
-        if (do_float) {
-          nvalf[0] += rectf[0];
-          nvalf[1] += rectf[1];
-          nvalf[2] += rectf[2];
-          nvalf[3] += rectf[3];
-          rectf += skipx;
-        }
+    }
+    for (int row = s->first; row < s->first + s->num; row++) {
+      const float *rectf = data->rectf + stride * row;
+      for (size_t i = 0; i < stride; i++) {
+        nval[i] += rectf[i];
       }
+    }
+    for (size_t i = 0; i < stride; i++) {
+      nval[i] = (nval[i] + s->last_weight * last[i]) / add;
+    }
+  }
+}
 
-      if (do_rect) {
-        val[0] = rect[0];
-        val[1] = rect[1];
-        val[2] = rect[2];
-        val[3] = rect[3];
-        rect += skipx;
-
-        newrect[0] = roundf((nval[0] + sample * val[0]) / add);
-        newrect[1] = roundf((nval[1] + sample * val[1]) / add);
-        newrect[2] = roundf((nval[2] + sample * val[2]) / add);
-        newrect[3] = roundf((nval[3] + sample * val[3]) / add);
-
-        newrect += skipx;
+static void scaleupx_line_fn(void *__restrict userdata,
+                             const int y,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleData *data = userdata;
+
+  if (data->rect) {
+    const uchar *rect = data->rect + (size_t)4 * y * data->x;
+    uchar *newrect = data->newrect + (size_t)4 * y * data->newsize;
+    for (int x = 0; x < data->newsize; x++) {
+      const ScaleUpSample *s = &data->up_samples[x];
+      const uchar *prev = rect + 4 * s->prev;
+      const uchar *next = rect + 4 * s->next;
+      for (int c = 0; c < 4; c++) {
+        const float val = prev[c];
+        newrect[4 * x + c] = (val + 0.5f) + s->weight * ((float)next[c] - val);
       }
-      if (do_float) {
-
-        valf[0] = rectf[0];
-        valf[1] = rectf[1];
-        valf[2] = rectf[2];
-        valf[3] = rectf[3];
-        rectf += skipx;
-
-        newrectf[0] = ((nvalf[0] + sample * valf[0]) / add);
-        newrectf[1] = ((nvalf[1] + sample * valf[1]) / add);
-        newrectf[2] = ((nvalf[2] + sample * valf[2]) / add);
-        newrectf[3] = ((nvalf[3] + sample * valf[3]) / add);
-
-        newrectf += skipx;
+    }
+  }
+  if (data->rectf) {
+    const float *rectf = data->rectf + (size_t)4 * y * data->x;
+    float *newrectf = data->newrectf + (size_t)4 * y * data->newsize;
+    for (int x = 0; x < data->newsize; x++) {
+      const ScaleUpSample *s = &data->up_samples[x];
+      const float *prev = rectf + 4 * s->prev;
+      const float *next = rectf + 4 * s->next;
+      for (int c = 0; c < 4; c++) {
+        newrectf[4 * x + c] = prev[c] + s->weight * (next[c] - prev[c]);
       }
-
-      sample -= 1.0f;
     }
   }
+}
 
-  if (do_rect) {
-    // printf("%ld %ld\n", (uchar *)rect - ((uchar *)ibuf->rect), rect_size);
-    BLI_assert((uchar *)rect - ((uchar *)ibuf->rect) == rect_size); /* see bug T26502. */
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+static void scaleupy_line_fn(void *__restrict userdata,
+                             const int y,
+                             const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleData *data = userdata;
+  const ScaleUpSample *s = &data->up_samples[y];
+  const size_t stride = (size_t)4 * data->x;
+
+  if (data->rect) {
+    const uchar *prev = data->rect + stride * s->prev;
+    const uchar *next = data->rect + stride * s->next;
+    uchar *newrect = data->newrect + stride * y;
+    for (size_t i = 0; i < stride; i++) {
+      const float val = prev[i];
+      newrect[i] = (val + 0.5f) + s->weight * ((float)next[i] - val);
+    }
   }
-  if (do_float) {
-    // printf("%ld %ld\n", rectf - ibuf->rect_float, rect_size);
-    BLI_assert((rectf - ibuf->rect_float) == rect_size); /* see bug T26502. */
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+  if (data->rectf) {
+    const float *prev = data->rectf + stride * s->prev;
+    const float *next = data->rectf + stride * s->next;
+    float *newrectf = data->newrectf + stride * y;
+    for (size_t i = 0; i < stride; i++) {
+      newrectf[i] = prev[i] + s->weight * (next[i] - prev[i]);
+    }
   }
-  (void)rect_size; /* UNUSED in release builds */
-
-  ibuf->y = newy;
-  return ibuf;
 }
 
-static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+/* Allocate buffers of the scaled image, returns false when allocation fails. */
+static bool scale_data_init(ScaleData *data, struct ImBuf *ibuf, int newx, int newy, int newsize)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return NULL;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
-    return ibuf;
-  }
+  memset(data, 0, sizeof(*data));
+  data->x = ibuf->x;
+  data->y = ibuf->y;
+  data->newsize = newsize;
 
   if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(newx * ibuf->y * sizeof(int), "scaleupx");
-    if (_newrect == NULL) {
-      return ibuf;
+    data->rect = (const uchar *)ibuf->rect;
+    data->newrect = MEM_mallocN(sizeof(uchar[4]) * newx * newy, "scale rect");
+    if (data->newrect == NULL) {
+      return false;
     }
   }
   if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * ibuf->y, "scaleupxf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->x - 1.001) / (newx - 1.0);
-
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (y = ibuf->y; y > 0; y--) {
-
-    sample = 0;
-
-    if (do_rect) {
-      val_a = rect[0];
-      nval_a = rect[4];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[5];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[6];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[7];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 8;
-    }
-    if (do_float) {
-      val_af = rectf[0];
-      nval_af = rectf[4];
-      diff_af = nval_af - val_af;
-
-      val_bf = rectf[1];
-      nval_bf = rectf[5];
-      diff_bf = nval_bf - val_bf;
-
-      val_gf = rectf[2];
-      nval_gf = rectf[6];
-      diff_gf = nval_gf - val_gf;
-
-      val_rf = rectf[3];
-      nval_rf = rectf[7];
-      diff_rf = nval_rf - val_rf;
-
-      rectf += 8;
-    }
-    for (x = newx; x > 0; x--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += 4;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += 4;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += 4;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += 4;
-      }
-      sample += add;
+    data->rectf = ibuf->rect_float;
+    data->newrectf = MEM_mallocN(sizeof(float[4]) * newx * newy, "scale rectf");
+    if (data->newrectf == NULL) {
+      MEM_SAFE_FREE(data->newrect);
+      return false;
     }
   }
+  return true;
+}
 
-  if (do_rect) {
+static void scale_data_apply(ScaleData *data, struct ImBuf *ibuf, int newx, int newy)
+{
+  if (data->newrect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
+    ibuf->rect = (unsigned int *)data->newrect;
   }
-  if (do_float) {
+  if (data->newrectf) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+    ibuf->rect_float = data->newrectf;
   }
 
   ibuf->x = newx;
-  return ibuf;
+  ibuf->y = newy;
 }
 
-static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+static ImBuf *scaledownx(struct ImBuf *ibuf, int newx)
 {
-  uchar *rect, *_newrect = NULL, *newrect;
-  float *rectf, *_newrectf = NULL, *newrectf;
-  float sample, add;
-  float val_a, nval_a, diff_a;
-  float val_b, nval_b, diff_b;
-  float val_g, nval_g, diff_g;
-  float val_r, nval_r, diff_r;
-  float val_af, nval_af, diff_af;
-  float val_bf, nval_bf, diff_bf;
-  float val_gf, nval_gf, diff_gf;
-  float val_rf, nval_rf, diff_rf;
-  int x, y, skipx;
-  bool do_rect = false, do_float = false;
-
-  val_a = nval_a = diff_a = val_b = nval_b = diff_b = 0;
-  val_g = nval_g = diff_g = val_r = nval_r = diff_r = 0;
-  val_af = nval_af = diff_af = val_bf = nval_bf = diff_bf = 0;
-  val_gf = nval_gf = diff_gf = val_rf = nval_rf = diff_rf = 0;
-  if (ibuf == NULL) {
-    return NULL;
-  }
-  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
+  ScaleData data;
+  if (!scale_data_init(&data, ibuf, newx, ibuf->y, newx)) {
     return ibuf;
   }
 
-  if (ibuf->rect) {
-    do_rect = true;
-    _newrect = MEM_mallocN(ibuf->x * newy * sizeof(int), "scaleupy");
-    if (_newrect == NULL) {
-      return ibuf;
-    }
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-    _newrectf = MEM_mallocN(sizeof(float[4]) * ibuf->x * newy, "scaleupyf");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
-      return ibuf;
-    }
-  }
-
-  add = (ibuf->y - 1.001) / (newy - 1.0);
-  skipx = 4 * ibuf->x;
+  ScaleDownSample *samples = scale_down_samples_create(ibuf->x, newx, &data.add);
+  data.down_samples = samples;
+  scale_parallel_range(ibuf->y, &data, scaledownx_line_fn);
+  MEM_freeN(samples);
 
-  rect = (uchar *)ibuf->rect;
-  rectf = (float *)ibuf->rect_float;
-  newrect = _newrect;
-  newrectf = _newrectf;
-
-  for (x = ibuf->x; x > 0; x--) {
+  scale_data_apply(&data, ibuf, newx, ibuf->y);
+  return ibuf;
+}
 
-    sample = 0;
-    if (do_rect) {
-      rect = ((uchar *)ibuf->rect) + 4 * (x - 1);
-      newrect = _newrect + 4 * (x - 1);
-
-      val_a = rect[0];
-      nval_a = rect[skipx];
-      diff_a = nval_a - val_a;
-      val_a += 0.5f;
-
-      val_b = rect[1];
-      nval_b = rect[skipx + 1];
-      diff_b = nval_b - val_b;
-      val_b += 0.5f;
-
-      val_g = rect[2];
-      nval_g = rect[skipx + 2];
-      diff_g = nval_g - val_g;
-      val_g += 0.5f;
-
-      val_r = rect[3];
-      nval_r = rect[skipx + 3];
-      diff_r = nval_r - val_r;
-      val_r += 0.5f;
-
-      rect += 2 * skipx;
-    }
-    if (do_float) {
-      rectf = ibuf->rect_float + 4 * (x - 1);
-      newrectf = _newrectf + 4 * (x - 1);
+static ImBuf *scaledowny(struct ImBuf *ibuf, int newy)
+{
+  ScaleData data;
+  if (!scale_data_init(&data, ibuf, ibuf->x, newy, newy)) {
+    return ibuf;
+  }
 
-      val_af = rectf[0];
-      nval_af = rectf[skipx];
-      diff_af = nval_af - val_af;
+  ScaleDownSample *samples = scale_down_samples_create(ibuf->y, newy, &data.add);
+  data.down_samples = samples;
+  ScaleDownYChunk chunk = {NULL};
+  TaskParallelSettings settings;
+  scale_parallel_range_settings(&settings);
+  settings.userdata_chunk = &chunk;
+  settings.userdata_chunk_size = sizeof(chunk);
+  settings.func_free = scaledowny_chunk_free;
+  BLI_task_parallel_range(0, newy, &data, scaledowny_line_fn, &settings);
+  MEM_freeN(samples);
 
-      val_bf = rectf[1];
-      nval_bf = rectf[skipx + 1];
-      diff_bf = nval_bf - val_bf;
+  scale_data_apply(&data, ibuf, ibuf->x, newy);
+  return ibuf;
+}
 
-      val_gf = rectf[2];
-      nval_gf = rectf[skipx + 2];
-      diff_gf = nval_gf - val_gf;
+static ImBuf *scaleupx(struct ImBuf *ibuf, int newx)
+{
+  ScaleData data;
+  if (!scale_data_init(&data, ibuf, newx, ibuf->y, newx)) {
+    return ibuf;
+  }
 
-      val_rf = rectf[3];
-      nval_rf = rectf[skipx + 3];
-      diff_rf = nval_rf - val_rf;
+  ScaleUpSample *samples = scale_up_samples_create(ibuf->x, newx);
+  data.up_samples = samples;
+  scale_parallel_range(ibuf->y, &data, scaleupx_line_fn);
+  MEM_freeN(samples);
 
-      rectf += 2 * skipx;
-    }
+  scale_data_apply(&data, ibuf, newx, ibuf->y);
+  return ibuf;
+}
 
-    for (y = newy; y > 0; y--) {
-      if (sample >= 1.0f) {
-        sample -= 1.0f;
-
-        if (do_rect) {
-          val_a = nval_a;
-          nval_a = rect[0];
-          diff_a = nval_a - val_a;
-          val_a += 0.5f;
-
-          val_b = nval_b;
-          nval_b = rect[1];
-          diff_b = nval_b - val_b;
-          val_b += 0.5f;
-
-          val_g = nval_g;
-          nval_g = rect[2];
-          diff_g = nval_g - val_g;
-          val_g += 0.5f;
-
-          val_r = nval_r;
-          nval_r = rect[3];
-          diff_r = nval_r - val_r;
-          val_r += 0.5f;
-          rect += skipx;
-        }
-        if (do_float) {
-          val_af = nval_af;
-          nval_af = rectf[0];
-          diff_af = nval_af - val_af;
-
-          val_bf = nval_bf;
-          nval_bf = rectf[1];
-          diff_bf = nval_bf - val_bf;
-
-          val_gf = nval_gf;
-          nval_gf = rectf[2];
-          diff_gf = nval_gf - val_gf;
-
-          val_rf = nval_rf;
-          nval_rf = rectf[3];
-          diff_rf = nval_rf - val_rf;
-          rectf += skipx;
-        }
-      }
-      if (do_rect) {
-        newrect[0] = val_a + sample * diff_a;
-        newrect[1] = val_b + sample * diff_b;
-        newrect[2] = val_g + sample * diff_g;
-        newrect[3] = val_r + sample * diff_r;
-        newrect += skipx;
-      }
-      if (do_float) {
-        newrectf[0] = val_af + sample * diff_af;
-        newrectf[1] = val_bf + sample * diff_bf;
-        newrectf[2] = val_gf + sample * diff_gf;
-        newrectf[3] = val_rf + sample * diff_rf;
-        newrectf += skipx;
-      }
-      sample += add;
-    }
+static ImBuf *scaleupy(struct ImBuf *ibuf, int newy)
+{
+  ScaleData data;
+  if (!scale_data_init(&data, ibuf, ibuf->x, newy, newy)) {
+    return ibuf;
   }
 
-  if (do_rect) {
-    imb_freerectImBuf(ibuf);
-    ibuf->mall |= IB_rect;
-    ibuf->rect = (unsigned int *)_newrect;
-  }
-  if (do_float) {
-    imb_freerectfloatImBuf(ibuf);
-    ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
-  }
+  ScaleUpSample *samples = scale_up_samples_create(ibuf->y, newy);
+  data.up_samples = samples;
+  scale_parallel_range(newy, &data, scaleupy_line_fn);
+  MEM_freeN(samples);
 
-  ibuf->y = newy;
+  scale_data_apply(&data, ibuf, ibuf->x, newy);
   return ibuf;
 }
 
@@ -1661,34 +1421,55 @@ struct imbufRGBA {
   float r, g, b, a;
 };
 
+typedef struct ScaleFastData {
+  const unsigned int *rect;
+  const struct imbufRGBA *rectf;
+  unsigned int *newrect;
+  struct imbufRGBA *newrectf;
+  int x;
+  int newx;
+  size_t stepx, stepy;
+} ScaleFastData;
+
+static void scalefast_line_fn(void *__restrict userdata,
+                              const int y,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const ScaleFastData *data = userdata;
+  const size_t ofsy = 32768 + y * data->stepy;
+
+  if (data->rect) {
+    const unsigned int *rect = data->rect + (ofsy >> 16) * data->x;
+    unsigned int *newrect = data->newrect + (size_t)y * data->newx;
+    size_t ofsx = 32768;
+
+    for (int x = 0; x < data->newx; x++, ofsx += data->stepx) {
+      newrect[x] = rect[ofsx >> 16];
+    }
+  }
+
+  if (data->rectf) {
+    const struct imbufRGBA *rectf = data->rectf + (ofsy >> 16) * data->x;
+    struct imbufRGBA *newrectf = data->newrectf + (size_t)y * data->newx;
+    size_t ofsx = 32768;
+
+    for (int x = 0; x < data->newx; x++, ofsx += data->stepx) {
+      newrectf[x] = rectf[ofsx >> 16];
+    }
+  }
+}
+
 /**
  * Return true if \a ibuf is modified.
  */
 bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy)
 {
-  unsigned int *rect, *_newrect, *newrect;
-  struct imbufRGBA *rectf, *_newrectf, *newrectf;
-  int x, y;
-  bool do_float = false, do_rect = false;
-  size_t ofsx, ofsy, stepx, stepy;
-
-  rect = NULL;
-  _newrect = NULL;
-  newrect = NULL;
-  rectf = NULL;
-  _newrectf = NULL;
-  newrectf = NULL;
+  ScaleFastData data = {NULL};
 
   if (ibuf == NULL) {
     return false;
   }
-  if (ibuf->rect) {
-    do_rect = true;
-  }
-  if (ibuf->rect_float) {
-    do_float = true;
-  }
-  if (do_rect == false && do_float == false) {
+  if (ibuf->rect == NULL && ibuf->rect_float == NULL) {
     return false;
   }
 
@@ -1696,61 +1477,43 @@ bool IMB_scalefastImBuf(struct ImBuf *ibuf, unsigned int newx, unsigned int newy
     return false;
   }
 
-  if (do_rect) {
-    _newrect = MEM_mallocN(newx * newy * sizeof(int), "scalefastimbuf");
-    if (_newrect == NULL) {
+  if (ibuf->rect) {
+    data.rect = ibuf->rect;
+    data.newrect = MEM_mallocN(newx * newy * sizeof(int), "scalefastimbuf");
+    if (data.newrect == NULL) {
       return false;
     }
-    newrect = _newrect;
   }
 
-  if (do_float) {
-    _newrectf = MEM_mallocN(sizeof(float[4]) * newx * newy, "scalefastimbuf f");
-    if (_newrectf == NULL) {
-      if (_newrect) {
-        MEM_freeN(_newrect);
-      }
+  if (ibuf->rect_float) {
+    data.rectf = (const struct imbufRGBA *)ibuf->rect_float;
+    data.newrectf = MEM_mallocN(sizeof(float[4]) * newx * newy, "scalefastimbuf f");
+    if (data.newrectf == NULL) {
+      MEM_SAFE_FREE(data.newrect);
       return false;
     }
-    newrectf = _newrectf;
   }
 
-  stepx = round(65536.0 * (ibuf->x - 1.0) / (newx - 1.0));
-  stepy = round(65536.0 * (ibuf->y - 1.0) / (newy - 1.0));
-  ofsy = 32768;
+  data.x = ibuf->x;
+  data.newx = newx;
+  data.stepx = round(65536.0 * (ibuf->x - 1.0) / (newx - 1.0));
+  data.stepy = round(65536.0 * (ibuf->y - 1.0) / (newy - 1.0));
 
-  for (y = newy; y > 0; y--, ofsy += stepy) {
-    if (do_rect) {
-      rect = ibuf->rect;
-      rect += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
-
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newrect++ = rect[ofsx >> 16];
-      }
-    }
-
-    if (do_float) {
-      rectf = (struct imbufRGBA *)ibuf->rect_float;
-      rectf += (ofsy >> 16) * ibuf->x;
-      ofsx = 32768;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 8;
+  BLI_task_parallel_range(0, newy, &data, scalefast_line_fn, &settings);
 
-      for (x = newx; x > 0; x--, ofsx += stepx) {
-        *newrectf++ = rectf[ofsx >> 16];
-      }
-    }
-  }
-
-  if (do_rect) {
+  if (data.newrect) {
     imb_freerectImBuf(ibuf);
     ibuf->mall |= IB_rect;
-    ibuf->rect = _newrect;
+    ibuf->rect = data.newrect;
   }
 
-  if (do_float) {
+  if (data.newrectf) {
     imb_freerectfloatImBuf(ibuf);
     ibuf->mall |= IB_rectfloat;
-    ibuf->rect_float = (float *)_newrectf;
+    ibuf->rect_float = (float *)data.newrectf;
   }
 
   scalefast_Z_ImBuf(ibuf, newx, newy);
@@ -0,0 +1,384 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <cmath>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_utildefines.h"
+
+#include "IMB_imbuf.h"
+#include "IMB_imbuf_types.h"
+
+#include "PIL_time.h"
+
+namespace blender::imbuf::tests {
+
+/* Image buffer which doesn't need IMB_init(), only its pixels are allocated. */
+static ImBuf create_ibuf(int x, int y, bool use_float)
+{
+  ImBuf ibuf = {};
+  ibuf.x = x;
+  ibuf.y = y;
+  ibuf.channels = 4;
+  if (use_float) {
+    ibuf.rect_float = (float *)MEM_mallocN(sizeof(float[4]) * x * y, __func__);
+    ibuf.mall |= IB_rectfloat;
+    for (size_t i = 0; i < (size_t)4 * x * y; i++) {
+      ibuf.rect_float[i] = (float)((i * 7919) % 1021) / 1020.0f;
+    }
+  }
+  else {
+    ibuf.rect = (unsigned int *)MEM_mallocN(sizeof(unsigned int) * x * y, __func__);
+    ibuf.mall |= IB_rect;
+    unsigned char *rect = (unsigned char *)ibuf.rect;
+    for (size_t i = 0; i < (size_t)4 * x * y; i++) {
+      rect[i] = (unsigned char)((i * 7919) % 251);
+    }
+  }
+  return ibuf;
+}
+
+static void fill_ibuf(ImBuf *ibuf, const unsigned char color[4], const float color_float[4])
+{
+  for (size_t i = 0; i < (size_t)ibuf->x * ibuf->y; i++) {
+    if (ibuf->rect) {
+      memcpy((unsigned char *)ibuf->rect + 4 * i, color, 4);
+    }
+    if (ibuf->rect_float) {
+      memcpy(ibuf->rect_float + 4 * i, color_float, sizeof(float[4]));
+    }
+  }
+}
+
+static void free_ibuf(ImBuf *ibuf)
+{
+  MEM_SAFE_FREE(ibuf->rect);
+  MEM_SAFE_FREE(ibuf->rect_float);
+}
+
+static void test_constant_color_is_preserved(int x, int y, int newx, int newy)
+{
+  const unsigned char color[4] = {10, 128, 250, 255};
+  const float color_float[4] = {0.1f, 0.5f, 2.0f, 1.0f};
+
+  ImBuf ibuf = create_ibuf(x, y, false);
+  ibuf.rect_float = (float *)MEM_mallocN(sizeof(float[4]) * x * y, __func__);
+  ibuf.mall |= IB_rectfloat;
+  fill_ibuf(&ibuf, color, color_float);
+
+  EXPECT_TRUE(IMB_scaleImBuf(&ibuf, newx, newy));
+  EXPECT_EQ(ibuf.x, newx);
+  EXPECT_EQ(ibuf.y, newy);
+
+  for (size_t i = 0; i < (size_t)newx * newy; i++) {
+    const unsigned char *pixel = (unsigned char *)ibuf.rect + 4 * i;
+    const float *pixel_float = ibuf.rect_float + 4 * i;
+    for (int c = 0; c < 4; c++) {
+      EXPECT_NEAR(pixel[c], color[c], 1);
+      EXPECT_NEAR(pixel_float[c], color_float[c], 1e-4f);
+    }
+  }
+
+  free_ibuf(&ibuf);
+}
+
+TEST(imbuf_scaling, scale_down_constant)
+{
+  test_constant_color_is_preserved(64, 48, 17, 13);
+  test_constant_color_is_preserved(1920, 1080, 960, 540);
+}
+
+TEST(imbuf_scaling, scale_up_constant)
+{
+  test_constant_color_is_preserved(17, 13, 64, 48);
+  test_constant_color_is_preserved(960, 540, 1920, 1080);
+}
+
+TEST(imbuf_scaling, scale_mixed_constant)
+{
+  test_constant_color_is_preserved(100, 300, 250, 120);
+}
+
+/* -------------------------------------------------------------------- */
+/* Reference results: the box filter and linear interpolation of the implementation before the
+ * scaling was split into sample tables and row passes, one axis at a time. */
+
+static unsigned char store_box(float value, unsigned char /*type*/)
+{
+  return roundf(value);
+}
+static float store_box(float value, float /*type*/)
+{
+  return value;
+}
+
+/* The previous byte up-scaling rounds by adding 0.5 before truncating. */
+static float linear_offset(unsigned char /*type*/)
+{
+  return 0.5f;
+}
+static float linear_offset(float /*type*/)
+{
+  return 0.0f;
+}
+
+/* Box filter along an axis of `size` pixels, `step` apart. `lines` lines start `line_step`
+ * apart. */
+template<typename T>
+static void reference_scale_down(const T *src,
+                                 T *dst,
+                                 int size,
+                                 int newsize,
+                                 size_t step,
+                                 int lines,
+                                 size_t line_step)
+{
+  const float add = (size - 0.01) / newsize;
+
+  for (int line = 0; line < lines; line++) {
+    const T *rect = src + line * line_step;
+    T *newrect = dst + line * line_step;
+    float sample = 0.0f;
+    float val[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float nval[4];
+
+    for (int i = 0; i < newsize; i++) {
+      for (int c = 0; c < 4; c++) {
+        nval[c] = -val[c] * sample;
+      }
+      sample += add;
+      while (sample >= 1.0f) {
+        sample -= 1.0f;
+        for (int c = 0; c < 4; c++) {
+          nval[c] += rect[c];
+        }
+        rect += step;
+      }
+      for (int c = 0; c < 4; c++) {
+        val[c] = rect[c];
+        newrect[c] = store_box((nval[c] + sample * val[c]) / add, T());
+      }
+      rect += step;
+      newrect += step;
+      sample -= 1.0f;
+    }
+  }
+}
+
+/* Linear interpolation along an axis, same arguments as #reference_scale_down. */
+template<typename T>
+static void reference_scale_up(const T *src,
+                               T *dst,
+                               int size,
+                               int newsize,
+                               size_t step,
+                               int lines,
+                               size_t line_step)
+{
+  const float add = (size - 1.001) / (newsize - 1.0);
+  const float offset = linear_offset(T());
+
+  for (int line = 0; line < lines; line++) {
+    const T *rect = src + line * line_step;
+    T *newrect = dst + line * line_step;
+    float sample = 0.0f;
+    float val[4], nval[4], diff[4];
+
+    for (int c = 0; c < 4; c++) {
+      val[c] = rect[c];
+      nval[c] = rect[step + c];
+      diff[c] = nval[c] - val[c];
+      val[c] += offset;
+    }
+    rect += 2 * step;
+
+    for (int i = 0; i < newsize; i++) {
+      if (sample >= 1.0f) {
+        sample -= 1.0f;
+        for (int c = 0; c < 4; c++) {
+          val[c] = nval[c];
+          nval[c] = rect[c];
+          diff[c] = nval[c] - val[c];
+          val[c] += offset;
+        }
+        rect += step;
+      }
+      for (int c = 0; c < 4; c++) {
+        newrect[c] = val[c] + sample * diff[c];
+      }
+      newrect += step;
+      sample += add;
+    }
+  }
+}
+
+/* Scale in the same order as #IMB_scaleImBuf: down in x, down in y, up in x, up in y. */
+template<typename T>
+static std::vector<T> reference_scale(const T *rect, int x, int y, int newx, int newy)
+{
+  std::vector<T> src(rect, rect + (size_t)4 * x * y);
+
+  const auto scale_x = [&](const bool down) {
+    std::vector<T> dst((size_t)4 * newx * y);
+    for (int line = 0; line < y; line++) {
+      const T *src_line = src.data() + (size_t)4 * line * x;
+      T *dst_line = dst.data() + (size_t)4 * line * newx;
+      if (down) {
+        reference_scale_down(src_line, dst_line, x, newx, 4, 1, 0);
+      }
+      else {
+        reference_scale_up(src_line, dst_line, x, newx, 4, 1, 0);
+      }
+    }
+    src = std::move(dst);
+    x = newx;
+  };
+  const auto scale_y = [&](const bool down) {
+    std::vector<T> dst((size_t)4 * x * newy);
+    if (down) {
+      reference_scale_down(src.data(), dst.data(), y, newy, (size_t)4 * x, x, 4);
+    }
+    else {
+      reference_scale_up(src.data(), dst.data(), y, newy, (size_t)4 * x, x, 4);
+    }
+    src = std::move(dst);
+    y = newy;
+  };
+
+  if (newx < x) {
+    scale_x(true);
+  }
+  if (newy < y) {
+    scale_y(true);
+  }
+  if (newx > x) {
+    scale_x(false);
+  }
+  if (newy > y) {
+    scale_y(false);
+  }
+  return src;
+}
+
+/* Horizontal and vertical gradients with a checker pattern, float values go above 1. */
+static ImBuf create_pattern_ibuf(int x, int y)
+{
+  ImBuf ibuf = create_ibuf(x, y, false);
+  ibuf.rect_float = (float *)MEM_mallocN(sizeof(float[4]) * x * y, __func__);
+  ibuf.mall |= IB_rectfloat;
+
+  unsigned char *rect = (unsigned char *)ibuf.rect;
+  for (int j = 0; j < y; j++) {
+    for (int i = 0; i < x; i++) {
+      const size_t index = (size_t)4 * (j * x + i);
+      const bool checker = ((i / 3) + (j / 3)) % 2;
+      rect[index + 0] = (unsigned char)(255 * i / (x - 1));
+      rect[index + 1] = (unsigned char)(255 * j / (y - 1));
+      rect[index + 2] = checker ? 255 : 0;
+      rect[index + 3] = (unsigned char)(128 + 127 * (checker ? i : j) / MAX2(x, y));
+      for (int c = 0; c < 4; c++) {
+        ibuf.rect_float[index + c] = rect[index + c] / 100.0f;
+      }
+    }
+  }
+  return ibuf;
+}
+
+static void test_matches_reference(int x, int y, int newx, int newy)
+{
+  ImBuf ibuf = create_pattern_ibuf(x, y);
+  const std::vector<unsigned char> expected = reference_scale(
+      (const unsigned char *)ibuf.rect, x, y, newx, newy);
+  const std::vector<float> expected_float = reference_scale(ibuf.rect_float, x, y, newx, newy);
+
+  EXPECT_TRUE(IMB_scaleImBuf(&ibuf, newx, newy));
+  ASSERT_EQ(ibuf.x, newx);
+  ASSERT_EQ(ibuf.y, newy);
+
+  const unsigned char *rect = (const unsigned char *)ibuf.rect;
+  for (size_t i = 0; i < (size_t)4 * newx * newy; i++) {
+    ASSERT_EQ(rect[i], expected[i]) << "byte value " << i;
+    /* Exact, the float results should be bit-identical as well. */
+    ASSERT_EQ(ibuf.rect_float[i], expected_float[i]) << "float value " << i;
+  }
+
+  free_ibuf(&ibuf);
+}
+
+TEST(imbuf_scaling, scale_down_matches_reference)
+{
+  test_matches_reference(64, 48, 27, 48);
+  test_matches_reference(64, 48, 64, 19);
+  test_matches_reference(101, 77, 37, 29);
+}
+
+TEST(imbuf_scaling, scale_up_matches_reference)
+{
+  test_matches_reference(27, 48, 64, 48);
+  test_matches_reference(64, 19, 64, 48);
+  test_matches_reference(37, 29, 101, 77);
+}
+
+TEST(imbuf_scaling, scale_mixed_matches_reference)
+{
+  test_matches_reference(100, 30, 41, 77);
+  test_matches_reference(30, 100, 77, 41);
+}
+
+TEST(imbuf_scaling, scale_fast)
+{
+  ImBuf ibuf = create_ibuf(4, 4, false);
+  const unsigned int corner = ibuf.rect[15];
+
+  EXPECT_TRUE(IMB_scalefastImBuf(&ibuf, 2, 2));
+  EXPECT_EQ(ibuf.x, 2);
+  EXPECT_EQ(ibuf.y, 2);
+  /* Nearest pixels of the corners are kept. */
+  EXPECT_EQ(ibuf.rect[3], corner);
+
+  free_ibuf(&ibuf);
+}
+
+/* Timing of sequencer preview sized scaling, run with `--gtest_also_run_disabled_tests`.
+ * Compare the numbers against a build of the previous implementation. */
+TEST(imbuf_scaling, DISABLED_performance)
+{
+  const int num_runs = 10;
+
+  for (const bool use_float : {false, true}) {
+    ImBuf ibuf_down = create_ibuf(3840, 2160, use_float);
+    double time_start = PIL_check_seconds_timer();
+    for (int i = 0; i < num_runs; i++) {
+      ImBuf ibuf = ibuf_down;
+      ibuf.rect = ibuf_down.rect ? (unsigned int *)MEM_dupallocN(ibuf_down.rect) : nullptr;
+      ibuf.rect_float = ibuf_down.rect_float ? (float *)MEM_dupallocN(ibuf_down.rect_float) :
+                                               nullptr;
+      IMB_scaleImBuf(&ibuf, 1920, 1080);
+      free_ibuf(&ibuf);
+    }
+    printf("%s 3840x2160 -> 1920x1080: %.2f ms\n",
+           use_float ? "float" : "byte",
+           (PIL_check_seconds_timer() - time_start) * 1000.0 / num_runs);
+    free_ibuf(&ibuf_down);
+
+    ImBuf ibuf_up = create_ibuf(1920, 1080, use_float);
+    time_start = PIL_check_seconds_timer();
+    for (int i = 0; i < num_runs; i++) {
+      ImBuf ibuf = ibuf_up;
+      ibuf.rect = ibuf_up.rect ? (unsigned int *)MEM_dupallocN(ibuf_up.rect) : nullptr;
+      ibuf.rect_float = ibuf_up.rect_float ? (float *)MEM_dupallocN(ibuf_up.rect_float) :
+                                             nullptr;
+      IMB_scaleImBuf(&ibuf, 3840, 2160);
+      free_ibuf(&ibuf);
+    }
+    printf("%s 1920x1080 -> 3840x2160: %.2f ms\n",
+           use_float ? "float" : "byte",
+           (PIL_check_seconds_timer() - time_start) * 1000.0 / num_runs);
+    free_ibuf(&ibuf_up);
+  }
+}
+
+}  // namespace blender::imbuf::tests
@@ -1627,6 +1627,52 @@ static IDProperty *rna_NodesModifier_properties(PointerRNA *ptr, bool create)
   }
   return settings->properties;
 }
+
+static void rna_NodesModifier_node_profiles_begin(CollectionPropertyIterator *iter,
+                                                  PointerRNA *ptr)
+{
+  NodesModifierData *nmd = ptr->data;
+  int len;
+  const NodesModifierNodeProfile *profiles = MOD_nodes_profile_get(nmd, &len);
+  rna_iterator_array_begin(
+      iter, (void *)profiles, sizeof(NodesModifierNodeProfile), len, false, NULL);
+}
+
+static void rna_NodesModifierNodeProfile_path_get(PointerRNA *ptr, char *value)
+{
+  const NodesModifierNodeProfile *profile = ptr->data;
+  strcpy(value, profile->path);
+}
+
+static int rna_NodesModifierNodeProfile_path_length(PointerRNA *ptr)
+{
+  const NodesModifierNodeProfile *profile = ptr->data;
+  return strlen(profile->path);
+}
+
+static float rna_NodesModifierNodeProfile_time_get(PointerRNA *ptr)
+{
+  const NodesModifierNodeProfile *profile = ptr->data;
+  return (float)profile->time;
+}
+
+static int rna_NodesModifierNodeProfile_elements_get(PointerRNA *ptr)
+{
+  const NodesModifierNodeProfile *profile = ptr->data;
+  return (int)MIN2(profile->elements, INT_MAX);
+}
+
+static float rna_NodesModifierNodeProfile_memory_get(PointerRNA *ptr)
+{
+  const NodesModifierNodeProfile *profile = ptr->data;
+  return (float)(profile->memory / (1024.0 * 1024.0));
+}
+
+static bool rna_NodesModifierNodeProfile_is_cached_get(PointerRNA *ptr)
+{
+  const NodesModifierNodeProfile *profile = ptr->data;
+  return profile->is_cached;
+}
 #else
 
 static void rna_def_property_subdivision_common(StructRNA *srna)
@@ -6977,6 +7023,67 @@ static void rna_def_modifier_nodes(BlenderRNA *brna)
   RNA_def_property_update(prop, 0, "rna_NodesModifier_node_group_update");
 
   RNA_define_lib_overridable(false);
+
+  prop = RNA_def_property(srna, "node_profiles", PROP_COLLECTION, PROP_NONE);
+  RNA_def_property_struct_type(prop, "NodesModifierNodeProfile");
+  RNA_def_property_collection_funcs(prop,
+                                    "rna_NodesModifier_node_profiles_begin",
+                                    "rna_iterator_array_next",
+                                    "rna_iterator_array_end",
+                                    "rna_iterator_array_get",
+                                    NULL,
+                                    NULL,
+                                    NULL,
+                                    NULL);
+  RNA_def_property_ui_text(prop,
+                           "Node Profiles",
+                           "Statistics of the nodes executed during the last evaluation, only "
+                           "available on the evaluated modifier");
+}
+
+static void rna_def_modifier_nodes_node_profile(BlenderRNA *brna)
+{
+  StructRNA *srna;
+  PropertyRNA *prop;
+
+  srna = RNA_def_struct(brna, "NodesModifierNodeProfile", NULL);
+  RNA_def_struct_ui_text(
+      srna, "Node Profile", "Statistics of a node recorded during the evaluation of a modifier");
+
+  prop = RNA_def_property(srna, "path", PROP_STRING, PROP_NONE);
+  RNA_def_property_string_funcs(prop,
+                                "rna_NodesModifierNodeProfile_path_get",
+                                "rna_NodesModifierNodeProfile_path_length",
+                                NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(
+      prop, "Path", "Names of the group nodes containing the node and of the node itself");
+  RNA_def_struct_name_property(srna, prop);
+
+  prop = RNA_def_property(srna, "time", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_funcs(prop, "rna_NodesModifierNodeProfile_time_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Time",
+                           "Execution time in seconds, including all nodes inside for group "
+                           "nodes");
+
+  prop = RNA_def_property(srna, "elements", PROP_INT, PROP_NONE);
+  RNA_def_property_int_funcs(prop, "rna_NodesModifierNodeProfile_elements_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(
+      prop, "Elements", "Amount of points and instances in the output geometries");
+
+  prop = RNA_def_property(srna, "memory", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_funcs(prop, "rna_NodesModifierNodeProfile_memory_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop, "Memory", "Memory used by the outputs in MiB");
+
+  prop = RNA_def_property(srna, "is_cached", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_funcs(prop, "rna_NodesModifierNodeProfile_is_cached_get", NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(
+      prop, "Is Cached", "The outputs were taken from the cache instead of executing the node");
 }
 
 static void rna_def_modifier_mesh_to_volume(BlenderRNA *brna)
@@ -7343,6 +7450,7 @@ void RNA_def_modifier(BlenderRNA *brna)
   rna_def_modifier_surfacedeform(brna);
   rna_def_modifier_weightednormal(brna);
   rna_def_modifier_nodes(brna);
+  rna_def_modifier_nodes_node_profile(brna);
   rna_def_modifier_mesh_to_volume(brna);
   rna_def_modifier_volume_displace(brna);
   rna_def_modifier_volume_to_mesh(brna);
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include "BLI_sys_types.h"
+
 struct Main;
 struct NodesModifierData;
 struct Object;
@@ -28,6 +30,32 @@ void MOD_nodes_update_interface(struct Object *object, struct NodesModifierData
 
 void MOD_nodes_init(struct Main *bmain, struct NodesModifierData *nmd);
 
+/**
+ * Statistics of a node, recorded during the last evaluation of an evaluated nodes modifier.
+ */
+typedef struct NodesModifierNodeProfile {
+  /** Same as the #bNodeInstanceKey of the node in the node editor. */
+  unsigned int instance_key;
+  /** Names of the group nodes containing the node and the name of the node, separated by '/'. */
+  const char *path;
+  /** Execution time in seconds. For group nodes this is the time of all nodes inside. */
+  double time;
+  /** Amount of points and instances in the output geometries. */
+  int64_t elements;
+  /** Memory used by the output values in bytes. */
+  int64_t memory;
+  /** The outputs have been copied from the node output cache. */
+  bool is_cached;
+} NodesModifierNodeProfile;
+
+const NodesModifierNodeProfile *MOD_nodes_profile_get(const struct NodesModifierData *nmd,
+                                                      int *r_len);
+const NodesModifierNodeProfile *MOD_nodes_profile_lookup(const struct NodesModifierData *nmd,
+                                                         unsigned int instance_key);
+
+/** Cache node outputs regardless of how long the nodes took to execute, used by tests. */
+void MOD_nodes_cache_all_outputs_set(bool enable);
+
 #ifdef __cplusplus
 }
 #endif
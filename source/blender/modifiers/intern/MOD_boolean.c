@@ -44,6 +44,7 @@
 
 #include "BKE_collection.h"
 #include "BKE_context.h"
+#include "BKE_customdata.h"
 #include "BKE_global.h" /* only to check G.debug */
 #include "BKE_lib_id.h"
 #include "BKE_lib_query.h"
@@ -295,6 +296,118 @@ static void clean_obmat(float cleaned[4][4], const float mat[4][4])
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Exact Result Cache
+ *
+ * The result of the Exact solver only depends on the operand meshes, their transformation
+ * relative to the modified object and the modifier settings. It is kept in the runtime data and
+ * reused while those don't change, e.g. when a modifier further down the stack is animated.
+ * \{ */
+
+/**
+ * Results larger than this are not kept. The copy is held for as long as the modifier exists,
+ * in addition to the result that is passed on to the next modifier.
+ */
+#define BOOLEAN_RESULT_CACHE_MAX_SIZE ((size_t)64 * 1024 * 1024)
+
+typedef struct BooleanModifierRuntime {
+  /** Hash of the inputs #result was computed from, see #exact_inputs_hash. */
+  uint64_t inputs_hash[2];
+  /** Copy of the last result of the Exact solver. */
+  struct Mesh *result;
+} BooleanModifierRuntime;
+
+/**
+ * Hash everything the Exact solver result depends on. The first mesh and object are the
+ * modified ones. Returns false when the inputs can't be hashed reliably.
+ */
+static bool exact_inputs_hash(const BooleanModifierData *bmd,
+                              Mesh **meshes,
+                              Object **objects,
+                              const int shapes_len,
+                              uint64_t r_hash[2])
+{
+  CustomDataHash hash;
+  CustomData_hash_init(&hash);
+
+  CustomData_hash_add_int(&hash, bmd->operation);
+  CustomData_hash_add_int(&hash, bmd->flag);
+  CustomData_hash_add_int(&hash, shapes_len);
+
+  float cleaned_obmat[4][4];
+  float imat[4][4];
+  clean_obmat(cleaned_obmat, objects[0]->obmat);
+  invert_m4_m4(imat, cleaned_obmat);
+  const bool is_neg_mat0 = is_negative_m4(objects[0]->obmat);
+
+  for (int i = 0; i < shapes_len; i++) {
+    if (!BKE_mesh_hash_add_content(&hash, meshes[i])) {
+      return false;
+    }
+    if (i == 0) {
+      continue;
+    }
+    /* The operands are transformed into the space of the modified object. */
+    float omat[4][4];
+    clean_obmat(cleaned_obmat, objects[i]->obmat);
+    mul_m4_m4m4(omat, imat, cleaned_obmat);
+    CustomData_hash_add(&hash, omat, sizeof(omat));
+    CustomData_hash_add_int(&hash, is_neg_mat0 != is_negative_m4(objects[i]->obmat));
+
+    const short totcol = objects[i]->totcol;
+    short *material_remap = BLI_array_alloca(material_remap, totcol ? totcol : 1);
+    BKE_object_material_remap_calc(objects[0], objects[i], material_remap);
+    CustomData_hash_add(&hash, material_remap, sizeof(*material_remap) * totcol);
+  }
+
+  CustomData_hash_end(&hash, r_hash);
+  return true;
+}
+
+/**
+ * Return a copy of the cached result if it was computed from the same inputs,
+ * with the mesh settings of the current input mesh.
+ */
+static Mesh *exact_result_cache_lookup(const BooleanModifierData *bmd,
+                                       const uint64_t inputs_hash[2],
+                                       const Mesh *mesh)
+{
+  const BooleanModifierRuntime *runtime = bmd->modifier.runtime;
+  if (runtime == NULL || runtime->result == NULL) {
+    return NULL;
+  }
+  if (runtime->inputs_hash[0] != inputs_hash[0] || runtime->inputs_hash[1] != inputs_hash[1]) {
+    return NULL;
+  }
+  Mesh *result = BKE_mesh_copy_for_eval(runtime->result, false);
+  BKE_mesh_copy_settings(result, mesh);
+  result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  return result;
+}
+
+static void exact_result_cache_store(BooleanModifierData *bmd,
+                                     const uint64_t inputs_hash[2],
+                                     Mesh *result)
+{
+  BooleanModifierRuntime *runtime = bmd->modifier.runtime;
+  if (runtime == NULL) {
+    runtime = MEM_callocN(sizeof(*runtime), "boolean runtime");
+    bmd->modifier.runtime = runtime;
+  }
+  if (runtime->result != NULL) {
+    BKE_id_free(NULL, runtime->result);
+    runtime->result = NULL;
+  }
+  if (BKE_mesh_memory_size(result) > BOOLEAN_RESULT_CACHE_MAX_SIZE) {
+    return;
+  }
+  runtime->result = BKE_mesh_copy_for_eval(result, false);
+  runtime->inputs_hash[0] = inputs_hash[0];
+  runtime->inputs_hash[1] = inputs_hash[1];
+}
+
+/** \} */
+
 static void BMD_mesh_intersection(BMesh *bm,
                                   ModifierData *md,
                                   const ModifierEvalContext *ctx,
@@ -482,6 +595,19 @@ static Mesh *collection_boolean_exact(BooleanModifierData *bmd,
     }
     FOREACH_COLLECTION_OBJECT_RECURSIVE_END;
   }
+
+  uint64_t inputs_hash[2];
+  const bool use_result_cache = (ctx->flag & MOD_APPLY_USECACHE) &&
+                                exact_inputs_hash(bmd, meshes, objects, num_shapes, inputs_hash);
+  if (use_result_cache) {
+    result = exact_result_cache_lookup(bmd, inputs_hash, mesh);
+    if (result != NULL) {
+      BLI_array_free(meshes);
+      BLI_array_free(objects);
+      return result;
+    }
+  }
+
   int *shape_face_end = MEM_mallocN(num_shapes * sizeof(int), __func__);
   int *shape_vert_end = MEM_mallocN(num_shapes * sizeof(int), __func__);
   bool is_neg_mat0 = is_negative_m4(ctx->object->obmat);
@@ -588,6 +714,10 @@ static Mesh *collection_boolean_exact(BooleanModifierData *bmd,
   BM_mesh_free(bm);
   result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
 
+  if (use_result_cache) {
+    exact_result_cache_store(bmd, inputs_hash, result);
+  }
+
   MEM_freeN(shape);
   MEM_freeN(shape_face_end);
   MEM_freeN(shape_vert_end);
@@ -649,6 +779,17 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
        * Returning mesh is depended on modifiers operation (sergey) */
       result = get_quick_mesh(object, mesh, operand_ob, mesh_operand_ob, bmd->operation);
 
+      uint64_t inputs_hash[2];
+      bool use_result_cache = false;
+      if (result == NULL && use_exact && (ctx->flag & MOD_APPLY_USECACHE)) {
+        Mesh *meshes[2] = {mesh, mesh_operand_ob};
+        Object *objects[2] = {object, operand_ob};
+        use_result_cache = exact_inputs_hash(bmd, meshes, objects, 2, inputs_hash);
+        if (use_result_cache) {
+          result = exact_result_cache_lookup(bmd, inputs_hash, mesh);
+        }
+      }
+
       if (result == NULL) {
 #ifdef DEBUG_TIME
         TIMEIT_BLOCK_INIT(object_BMD_mesh_bm_create);
@@ -681,6 +822,10 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
 #endif
         BM_mesh_free(bm);
         result->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+
+        if (use_result_cache) {
+          exact_result_cache_store(bmd, inputs_hash, result);
+        }
       }
 
       /* if new mesh returned, return it; otherwise there was
@@ -745,6 +890,24 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
   return result;
 }
 
+static void freeRuntimeData(void *runtime_data)
+{
+  if (runtime_data == NULL) {
+    return;
+  }
+  BooleanModifierRuntime *runtime = (BooleanModifierRuntime *)runtime_data;
+  if (runtime->result != NULL) {
+    BKE_id_free(NULL, runtime->result);
+  }
+  MEM_freeN(runtime);
+}
+
+static void freeData(ModifierData *md)
+{
+  freeRuntimeData(md->runtime);
+  md->runtime = NULL;
+}
+
 static void requiredDataMask(Object *UNUSED(ob),
                              ModifierData *UNUSED(md),
                              CustomData_MeshMasks *r_cddata_masks)
@@ -824,14 +987,14 @@ ModifierTypeInfo modifierType_Boolean = {
 
     /* initData */ initData,
     /* requiredDataMask */ requiredDataMask,
-    /* freeData */ NULL,
+    /* freeData */ freeData,
     /* isDisabled */ isDisabled,
     /* updateDepsgraph */ updateDepsgraph,
     /* dependsOnTime */ NULL,
     /* dependsOnNormals */ NULL,
     /* foreachIDLink */ foreachIDLink,
     /* foreachTexLink */ NULL,
-    /* freeRuntimeData */ NULL,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ NULL,
     /* blendRead */ NULL,
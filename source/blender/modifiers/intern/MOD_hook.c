@@ -25,6 +25,7 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -247,7 +248,7 @@ static float hook_falloff(const struct HookData_cb *hd, const float len_sq)
   }
 }
 
-static void hook_co_apply(struct HookData_cb *hd, int j, const MDeformVert *dv)
+static void hook_co_apply(const struct HookData_cb *hd, int j, const MDeformVert *dv)
 {
   float *co = hd->vertexCos[j];
   float fac;
@@ -284,6 +285,45 @@ static void hook_co_apply(struct HookData_cb *hd, int j, const MDeformVert *dv)
   }
 }
 
+struct HookTaskData_cb {
+  const struct HookData_cb *hd;
+  const MDeformVert *dvert;
+  /** Optional, when set only vertices with original index in `indexar_used` are deformed. */
+  const int *origindex_ar;
+  const BLI_bitmap *indexar_used;
+};
+
+static void hook_co_apply_task(void *__restrict userdata,
+                               const int i,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const struct HookTaskData_cb *data = userdata;
+  if (data->origindex_ar != NULL && !BLI_BITMAP_TEST(data->indexar_used, data->origindex_ar[i])) {
+    return;
+  }
+  hook_co_apply(data->hd, i, data->dvert ? &data->dvert[i] : NULL);
+}
+
+/* Each vertex is deformed independently, so this can be threaded for meshes.
+ * Edit-meshes and explicit index arrays (which may contain duplicates) are handled serially. */
+static void hook_co_apply_parallel(const struct HookData_cb *hd,
+                                   const MDeformVert *dvert,
+                                   const int *origindex_ar,
+                                   const BLI_bitmap *indexar_used,
+                                   const int numVerts)
+{
+  struct HookTaskData_cb data = {
+      .hd = hd,
+      .dvert = dvert,
+      .origindex_ar = origindex_ar,
+      .indexar_used = indexar_used,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, numVerts, &data, hook_co_apply_task, &settings);
+}
+
 static void deformVerts_do(HookModifierData *hmd,
                            const ModifierEvalContext *UNUSED(ctx),
                            Object *ob,
@@ -386,13 +426,7 @@ static void deformVerts_do(HookModifierData *hmd,
         numVerts_orig = me_orig->totvert;
       }
       BLI_bitmap *indexar_used = hook_index_array_to_bitmap(hmd, numVerts_orig);
-      for (i = 0; i < numVerts; i++) {
-        int i_orig = origindex_ar[i];
-        BLI_assert(i_orig < numVerts_orig);
-        if (BLI_BITMAP_TEST(indexar_used, i_orig)) {
-          hook_co_apply(&hd, i, dvert ? &dvert[i] : NULL);
-        }
-      }
+      hook_co_apply_parallel(&hd, dvert, origindex_ar, indexar_used, numVerts);
       MEM_freeN(indexar_used);
     }
     else { /* missing mesh or ORIGINDEX */
@@ -431,9 +465,7 @@ static void deformVerts_do(HookModifierData *hmd,
     }
     else {
       BLI_assert(dvert != NULL);
-      for (i = 0; i < numVerts; i++) {
-        hook_co_apply(&hd, i, &dvert[i]);
-      }
+      hook_co_apply_parallel(&hd, dvert, NULL, NULL, numVerts);
     }
   }
 }
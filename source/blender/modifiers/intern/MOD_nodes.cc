@@ -21,20 +21,26 @@
  * \ingroup modifiers
  */
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <string>
 
 #include "MEM_guardedalloc.h"
 
 #include "BLI_float3.hh"
+#include "BLI_hash_mm2a.h"
 #include "BLI_listbase.h"
 #include "BLI_set.hh"
 #include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_collection_types.h"
 #include "DNA_defaults.h"
+#include "DNA_genfile.h"
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_modifier_types.h"
@@ -43,6 +49,7 @@
 #include "DNA_pointcloud_types.h"
 #include "DNA_scene_types.h"
 #include "DNA_screen_types.h"
+#include "DNA_sdna_types.h"
 
 #include "BKE_customdata.h"
 #include "BKE_global.h"
@@ -50,6 +57,7 @@
 #include "BKE_lib_query.h"
 #include "BKE_mesh.h"
 #include "BKE_modifier.h"
+#include "BKE_node.h"
 #include "BKE_pointcloud.h"
 #include "BKE_screen.h"
 #include "BKE_simulation.h"
@@ -75,6 +83,8 @@
 #include "NOD_node_tree_multi_function.hh"
 #include "NOD_type_callbacks.hh"
 
+#include "PIL_time.h"
+
 using blender::float3;
 using blender::IndexRange;
 using blender::Map;
@@ -86,6 +96,7 @@ using blender::bke::PersistentCollectionHandle;
 using blender::bke::PersistentDataHandleMap;
 using blender::bke::PersistentObjectHandle;
 using blender::fn::GMutablePointer;
+using blender::fn::GPointer;
 using blender::fn::GValueMap;
 using blender::nodes::GeoNodeExecParams;
 using namespace blender::nodes::derived_node_tree_types;
@@ -212,11 +223,439 @@ static bool isDisabled(const struct Scene *UNUSED(scene),
   return false;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Node Output Cache
+ *
+ * Outputs of nodes that are expensive to compute are kept in the runtime data of the modifier,
+ * so that the next evaluation can reuse them when the inputs of the node did not change. A node is
+ * identified by a 128 bit hash of its type, settings and input values. Values computed by other
+ * nodes are represented by the hash of those nodes, so only the group inputs are hashed by their
+ * content. Nodes that depend on data outside of the node tree, like objects or textures, are not
+ * cached.
+ * \{ */
+
+/** Memory that the cached values of a single modifier may use. */
+static const int64_t NODES_CACHE_MAX_SIZE = int64_t(256) * 1024 * 1024;
+/** Memory that the cached values of all modifiers together may use. */
+static const int64_t NODES_CACHE_MAX_SIZE_GLOBAL = int64_t(1024) * 1024 * 1024;
+/** Memory used by the caches of all modifiers. */
+static std::atomic<int64_t> nodes_cache_size_global = 0;
+
+static uint64_t hash_combine(const uint64_t hash, const uint64_t value)
+{
+  return hash ^ (value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2));
+}
+
+/** A mixing step that is independent of #hash_combine, for the second half of the key. */
+static uint64_t hash_combine_alt(const uint64_t hash, const uint64_t value)
+{
+  uint64_t x = (hash * 0x100000001b3ull) ^ (value * 0xc4ceb9fe1a85ec53ull);
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  return x;
+}
+
+/**
+ * Identifies node outputs in the cache. With 128 bits, different inputs practically never end up
+ * with the same key, so that a cached value can be used without comparing the inputs.
+ */
+struct NodesCacheKey {
+  uint64_t h1 = 0;
+  uint64_t h2 = 0;
+
+  void add(const uint64_t value)
+  {
+    h1 = hash_combine(h1, value);
+    h2 = hash_combine_alt(h2, value);
+  }
+
+  void add(const NodesCacheKey &other)
+  {
+    h1 = hash_combine(h1, other.h1);
+    h2 = hash_combine_alt(h2, other.h2);
+  }
+
+  uint64_t hash() const
+  {
+    return h1;
+  }
+
+  friend bool operator==(const NodesCacheKey &a, const NodesCacheKey &b)
+  {
+    return a.h1 == b.h1 && a.h2 == b.h2;
+  }
+};
+
+struct NodesModifierCache {
+  struct Entry {
+    /** Values of the available outputs of the node, in order. */
+    Vector<GMutablePointer> values;
+    int64_t size;
+    uint64_t last_used;
+  };
+
+  /** Nodes are evaluated in multiple threads, see #GeometryNodesEvaluator. */
+  std::mutex mutex;
+  Map<NodesCacheKey, Entry> entries;
+  int64_t size = 0;
+  uint64_t evaluation_count = 0;
+
+  /* Statistics of the last evaluation. */
+  int hits = 0;
+  int misses = 0;
+  int evictions = 0;
+
+  ~NodesModifierCache()
+  {
+    for (Entry &entry : entries.values()) {
+      free_values(entry.values);
+    }
+    nodes_cache_size_global -= size;
+  }
+
+  static void free_values(Span<GMutablePointer> values)
+  {
+    for (GMutablePointer value : values) {
+      value.destruct();
+      MEM_freeN(value.get());
+    }
+  }
+
+  void begin_evaluation()
+  {
+    evaluation_count++;
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+  }
+
+  void add_entry(const NodesCacheKey &key, Entry entry)
+  {
+    size += entry.size;
+    nodes_cache_size_global += entry.size;
+    entries.add_new(key, std::move(entry));
+  }
+
+  bool is_over_budget() const
+  {
+    return size > NODES_CACHE_MAX_SIZE || nodes_cache_size_global > NODES_CACHE_MAX_SIZE_GLOBAL;
+  }
+
+  /**
+   * Remove the least recently used entries until the cache fits into its budget. When the caches
+   * of all modifiers together use too much memory, the modifier that is evaluated gives up its
+   * entries, so the memory goes to the modifiers that are currently being edited.
+   */
+  void end_evaluation()
+  {
+    if (!this->is_over_budget()) {
+      return;
+    }
+    Vector<std::pair<uint64_t, NodesCacheKey>> keys_by_use;
+    for (auto item : entries.items()) {
+      keys_by_use.append({item.value.last_used, item.key});
+    }
+    std::sort(keys_by_use.begin(),
+              keys_by_use.end(),
+              [](const std::pair<uint64_t, NodesCacheKey> &a,
+                 const std::pair<uint64_t, NodesCacheKey> &b) { return a.first < b.first; });
+    for (const std::pair<uint64_t, NodesCacheKey> &item : keys_by_use) {
+      if (!this->is_over_budget()) {
+        break;
+      }
+      /* Only for the budget of this modifier, remove values that the current evaluation used.
+       * Those are the most likely to be used again. */
+      if (item.first == evaluation_count && size <= NODES_CACHE_MAX_SIZE) {
+        break;
+      }
+      Entry entry = entries.pop(item.second);
+      size -= entry.size;
+      nodes_cache_size_global -= entry.size;
+      free_values(entry.values);
+      evictions++;
+    }
+  }
+};
+
+static NodesCacheKey hash_bytes(const void *data, const size_t size)
+{
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  NodesCacheKey key;
+  key.h1 = (static_cast<uint64_t>(BLI_hash_mm2(bytes, size, 0)) << 32) |
+           BLI_hash_mm2(bytes, size, 1);
+  key.h2 = (static_cast<uint64_t>(BLI_hash_mm2(bytes, size, 2)) << 32) |
+           BLI_hash_mm2(bytes, size, 3);
+  return key;
+}
+
+/** Add a content hash of #CustomDataHash to the key. */
+static void key_add_custom_data_hash(NodesCacheKey &key, CustomDataHash &hash)
+{
+  uint64_t digest[2];
+  CustomData_hash_end(&hash, digest);
+  key.add(NodesCacheKey{digest[0], digest[1]});
+}
+
+/**
+ * Hash the content of a geometry. This has to read all the data, but that is still much cheaper
+ * than evaluating the nodes that are using the geometry.
+ */
+static std::optional<NodesCacheKey> hash_geometry_set(const GeometrySet &geometry_set)
+{
+  if (geometry_set.has_volume()) {
+    return std::nullopt;
+  }
+  NodesCacheKey key;
+  if (const MeshComponent *component = geometry_set.get_component_for_read<MeshComponent>()) {
+    key.add(static_cast<uint64_t>(GeometryComponentType::Mesh));
+    if (const Mesh *mesh = component->get_for_read()) {
+      CustomDataHash mesh_hash;
+      CustomData_hash_init(&mesh_hash);
+      if (!BKE_mesh_hash_add_content(&mesh_hash, mesh)) {
+        return std::nullopt;
+      }
+      key_add_custom_data_hash(key, mesh_hash);
+    }
+    /* The order of the names in the map is arbitrary. */
+    uint64_t names_hash = 0;
+    for (auto item : component->vertex_group_names().items()) {
+      names_hash += hash_combine(blender::hash_string(item.key),
+                                 static_cast<uint64_t>(item.value));
+    }
+    key.add(names_hash);
+  }
+  if (const PointCloudComponent *component =
+          geometry_set.get_component_for_read<PointCloudComponent>()) {
+    key.add(static_cast<uint64_t>(GeometryComponentType::PointCloud));
+    if (const PointCloud *pointcloud = component->get_for_read()) {
+      CustomDataHash pointcloud_hash;
+      CustomData_hash_init(&pointcloud_hash);
+      if (!CustomData_hash_add_layers(
+              &pointcloud_hash, &pointcloud->pdata, pointcloud->totpoint)) {
+        return std::nullopt;
+      }
+      key_add_custom_data_hash(key, pointcloud_hash);
+    }
+  }
+  if (const InstancesComponent *component =
+          geometry_set.get_component_for_read<InstancesComponent>()) {
+    key.add(static_cast<uint64_t>(GeometryComponentType::Instances));
+    key.add(hash_bytes(component->transforms().data(),
+                       sizeof(blender::float4x4) * component->instances_amount()));
+    key.add(hash_bytes(component->ids().data(), sizeof(int) * component->instances_amount()));
+    for (const InstancedData &data : component->instanced_data()) {
+      key.add(static_cast<uint64_t>(data.type));
+      key.add(reinterpret_cast<uint64_t>(data.data.object));
+    }
+  }
+  return key;
+}
+
+static int64_t geometry_set_size(const GeometrySet &geometry_set)
+{
+  int64_t size = sizeof(GeometrySet);
+  if (const Mesh *mesh = geometry_set.get_mesh_for_read()) {
+    size += BKE_mesh_memory_size(mesh);
+  }
+  if (const PointCloud *pointcloud = geometry_set.get_pointcloud_for_read()) {
+    size += CustomData_layers_memory_size(&pointcloud->pdata, pointcloud->totpoint);
+  }
+  if (const InstancesComponent *component =
+          geometry_set.get_component_for_read<InstancesComponent>()) {
+    size += (sizeof(blender::float4x4) + sizeof(int) + sizeof(InstancedData)) *
+            component->instances_amount();
+  }
+  return size;
+}
+
+/** Hash a value by its content, or return nothing when the value refers to other data. */
+static std::optional<NodesCacheKey> hash_value(const GPointer value)
+{
+  const CPPType &type = *value.type();
+  if (type.is<GeometrySet>()) {
+    return hash_geometry_set(*static_cast<const GeometrySet *>(value.get()));
+  }
+  if (type.is<PersistentObjectHandle>() || type.is<PersistentCollectionHandle>()) {
+    return std::nullopt;
+  }
+  NodesCacheKey key;
+  key.add(type.hash(value.get()));
+  return key;
+}
+
+/**
+ * Hash the members of a DNA struct. Going over the members skips the padding, which is not
+ * guaranteed to be initialized, and the unused memory at the end of the allocation.
+ */
+static void hash_dna_struct(NodesCacheKey &key,
+                            const SDNA &sdna,
+                            const int struct_nr,
+                            const char *data)
+{
+  const SDNA_Struct *struct_info = sdna.structs[struct_nr];
+  for (const int i : IndexRange(struct_info->members_len)) {
+    const SDNA_StructMember &member = struct_info->members[i];
+    const char *name = sdna.names[member.name];
+    const int size = DNA_elem_size_nr(&sdna, member.type, member.name);
+    if (STRPREFIX(name, "_pad")) {
+      data += size;
+      continue;
+    }
+    const bool is_pointer = ELEM(name[0], '*', '(');
+    const int member_struct_nr = is_pointer ? -1 :
+                                              DNA_struct_find_nr(&sdna, sdna.types[member.type]);
+    if (member_struct_nr == -1) {
+      key.add(hash_bytes(data, size));
+      data += size;
+      continue;
+    }
+    /* Nested structs can have padding as well. */
+    for (int j = 0; j < sdna.names_array_len[member.name]; j++) {
+      hash_dna_struct(key, sdna, member_struct_nr, data);
+      data += sdna.types_size[member.type];
+    }
+  }
+}
+
+static int64_t value_size(const GPointer value)
+{
+  const CPPType &type = *value.type();
+  if (type.is<GeometrySet>()) {
+    return geometry_set_size(*static_cast<const GeometrySet *>(value.get()));
+  }
+  return type.size();
+}
+
+/**
+ * Holding on to a geometry means that the next node has to copy it before it can be modified, so
+ * only outputs of nodes that take much longer to execute than it takes to copy them are cached.
+ */
+static bool is_worth_caching(const double execution_time, const int64_t size)
+{
+  /* Roughly the time it takes to copy a byte, with some margin. */
+  const double copy_time_per_byte = 4e-9;
+  return execution_time > 1e-3 && execution_time > size * copy_time_per_byte;
+}
+
+/* Cache the outputs of all nodes, so that tests don't depend on the execution time. */
+static bool nodes_cache_all_outputs = false;
+
+void MOD_nodes_cache_all_outputs_set(const bool enable)
+{
+  nodes_cache_all_outputs = enable;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Node Profile
+ *
+ * The execution time and output size of every executed node are recorded in the runtime data of
+ * the evaluated modifier. They are drawn in the node editor and are accessible from Python, to
+ * find the nodes that are slow to evaluate.
+ * \{ */
+
+struct NodesModifierProfile {
+  Vector<NodesModifierNodeProfile> nodes;
+  /** Storage for the paths referenced by #nodes. */
+  Vector<std::string> paths;
+  Map<unsigned int, int> index_by_key;
+
+  NodesModifierNodeProfile &ensure_node(const bNodeInstanceKey key, const std::string &path)
+  {
+    const int index = index_by_key.lookup_or_add_cb(key.value, [&]() {
+      NodesModifierNodeProfile node_profile = {0};
+      node_profile.instance_key = key.value;
+      nodes.append(node_profile);
+      paths.append(path);
+      return static_cast<int>(nodes.size() - 1);
+    });
+    return nodes[index];
+  }
+
+  /** Has to be called after all nodes have been added, because adding nodes moves the paths. */
+  void update_paths()
+  {
+    for (const int i : nodes.index_range()) {
+      nodes[i].path = paths[i].c_str();
+    }
+  }
+};
+
+/** The data stored in #ModifierData.runtime of an evaluated nodes modifier. */
+struct NodesModifierRuntime {
+  NodesModifierCache cache;
+  NodesModifierProfile profile;
+};
+
+static int64_t geometry_set_elements_amount(const GeometrySet &geometry_set)
+{
+  int64_t amount = 0;
+  if (const Mesh *mesh = geometry_set.get_mesh_for_read()) {
+    amount += mesh->totvert;
+  }
+  if (const PointCloud *pointcloud = geometry_set.get_pointcloud_for_read()) {
+    amount += pointcloud->totpoint;
+  }
+  if (const InstancesComponent *component =
+          geometry_set.get_component_for_read<InstancesComponent>()) {
+    amount += component->instances_amount();
+  }
+  return amount;
+}
+
+/** \} */
+
+/**
+ * Evaluates a #DerivedNodeTree with data that is forwarded from the group inputs to the group
+ * outputs.
+ *
+ * Only nodes that the group outputs depend on are executed, every one of them exactly once. A node
+ * is scheduled in a task pool as soon as all its linked inputs have been computed, so independent
+ * branches of the tree are evaluated in parallel.
+ */
 class GeometryNodesEvaluator {
  private:
+  using LinkKey = std::pair<const DInputSocket *, const DOutputSocket *>;
+
+  /** Evaluation state of a node that is required to compute the group outputs. */
+  struct NodeState {
+    /** Values that have been forwarded to the linked inputs of the node. */
+    Map<LinkKey, GMutablePointer> value_by_input;
+    /** Protects #value_by_input while the linked nodes are evaluated in different threads. */
+    std::mutex value_mutex;
+    /** Number of linked inputs whose value has not been computed yet. */
+    std::atomic<int> missing_inputs = 0;
+    /**
+     * Memory for the values computed by the node. Every node has its own allocator, because a
+     * node is only evaluated by one thread at a time.
+     */
+    blender::LinearAllocator<> allocator;
+    /** The group output node only collects values, it is not executed. */
+    bool is_group_output = false;
+    /**
+     * Identifies the computed outputs in the #NodesModifierCache. It is set before the outputs are
+     * forwarded, so that the linked nodes can use it for their own hash.
+     */
+    std::optional<NodesCacheKey> hash;
+
+    /* Statistics for the #NodesModifierProfile. */
+    double execution_time = 0.0;
+    int64_t output_elements = 0;
+    int64_t output_memory = 0;
+    bool is_cached = false;
+  };
+
   blender::LinearAllocator<> allocator_;
-  Map<std::pair<const DInputSocket *, const DOutputSocket *>, GMutablePointer> value_by_input_;
+  Map<const DNode *, NodeState *> node_states_;
+  /** Links whose value is used by a required node. Values are not forwarded over other links. */
+  Set<LinkKey> required_links_;
   Vector<const DInputSocket *> group_outputs_;
+  TaskPool *task_pool_ = nullptr;
+  /** Optional, outputs are not cached when this is null. */
+  NodesModifierCache *cache_;
+  Map<const DOutputSocket *, std::optional<NodesCacheKey>> group_input_hashes_;
   blender::nodes::MultiFunctionByNode &mf_by_node_;
   const blender::nodes::DataTypeConversions &conversions_;
   const PersistentDataHandleMap &handle_map_;
@@ -229,124 +668,444 @@ class GeometryNodesEvaluator {
                          blender::nodes::MultiFunctionByNode &mf_by_node,
                          const PersistentDataHandleMap &handle_map,
                          const Object *self_object,
-                         Depsgraph *depsgraph)
+                         Depsgraph *depsgraph,
+                         NodesModifierCache *cache)
       : group_outputs_(std::move(group_outputs)),
+        cache_(cache),
         mf_by_node_(mf_by_node),
         conversions_(blender::nodes::get_implicit_type_conversions()),
         handle_map_(handle_map),
         self_object_(self_object),
         depsgraph_(depsgraph)
   {
+    this->find_required_nodes(group_input_data);
+    if (cache_ != nullptr) {
+      for (auto item : group_input_data.items()) {
+        group_input_hashes_.add_new(item.key, hash_value(item.value));
+      }
+    }
     for (auto item : group_input_data.items()) {
-      this->forward_to_inputs(*item.key, item.value);
+      this->forward_to_inputs(*item.key, item.value, allocator_);
+    }
+  }
+
+  ~GeometryNodesEvaluator()
+  {
+    for (NodeState *node_state : node_states_.values()) {
+      node_state->~NodeState();
     }
   }
 
   Vector<GMutablePointer> execute()
   {
+    /* Gather the nodes that can run right away before starting any task, because running tasks
+     * schedule the nodes that depend on them themselves. */
+    Vector<const DNode *> nodes_to_start;
+    for (auto item : node_states_.items()) {
+      if (!item.value->is_group_output && item.value->missing_inputs == 0) {
+        nodes_to_start.append(item.key);
+      }
+    }
+
+    task_pool_ = BLI_task_pool_create(this, TASK_PRIORITY_HIGH);
+    for (const DNode *node : nodes_to_start) {
+      this->schedule_node(*node);
+    }
+    BLI_task_pool_work_and_wait(task_pool_);
+    BLI_task_pool_free(task_pool_);
+    task_pool_ = nullptr;
+
     Vector<GMutablePointer> results;
     for (const DInputSocket *group_output : group_outputs_) {
-      Vector<GMutablePointer> result = this->get_input_values(*group_output);
+      NodeState &node_state = *node_states_.lookup(&group_output->node());
+      Vector<GMutablePointer> result = this->get_input_values(*group_output, node_state);
       results.append(result[0]);
     }
-    for (GMutablePointer value : value_by_input_.values()) {
-      value.destruct();
+    for (NodeState *node_state : node_states_.values()) {
+      for (GMutablePointer value : node_state->value_by_input.values()) {
+        value.destruct();
+      }
+      node_state->value_by_input.clear();
     }
     return results;
   }
 
- private:
-  Vector<GMutablePointer> get_input_values(const DInputSocket &socket_to_compute)
+  /**
+   * Add the statistics of all executed nodes to the profile. Nodes are identified in the same way
+   * as in the node editor. Group nodes get the time of all the nodes they contain.
+   */
+  void fill_profile(NodesModifierProfile &profile) const
   {
+    for (auto item : node_states_.items()) {
+      const DNode &node = *item.key;
+      const NodeState &node_state = *item.value;
+      if (node_state.is_group_output) {
+        continue;
+      }
 
-    Span<const DOutputSocket *> from_sockets = socket_to_compute.linked_sockets();
-    Span<const DGroupInput *> from_group_inputs = socket_to_compute.linked_group_inputs();
-    const int total_inputs = from_sockets.size() + from_group_inputs.size();
+      Vector<const DParentNode *> parents;
+      for (const DParentNode *parent = node.parent(); parent != nullptr;
+           parent = parent->parent()) {
+        parents.append(parent);
+      }
 
-    if (total_inputs == 0) {
-      /* The input is not connected, use the value from the socket itself. */
-      return {get_unlinked_input_value(socket_to_compute)};
+      bNodeInstanceKey key = NODE_INSTANCE_KEY_BASE;
+      std::string path;
+      for (int i = parents.size() - 1; i >= 0; i--) {
+        const blender::nodes::NodeRef &group_node = parents[i]->node_ref();
+        key = BKE_node_instance_key(key, group_node.tree().btree(), group_node.bnode());
+        path += group_node.name();
+        profile.ensure_node(key, path).time += node_state.execution_time;
+        path += "/";
+      }
+
+      key = BKE_node_instance_key(key, node.node_ref().tree().btree(), node.bnode());
+      path += node.name();
+      NodesModifierNodeProfile &node_profile = profile.ensure_node(key, path);
+      node_profile.time += node_state.execution_time;
+      node_profile.elements += node_state.output_elements;
+      node_profile.memory += node_state.output_memory;
+      node_profile.is_cached = node_state.is_cached;
     }
+    profile.update_paths();
+  }
+
+ private:
+  static bool is_group_input_node(const DNode &node)
+  {
+    return node.idname() == "NodeGroupInput";
+  }
 
-    if (from_group_inputs.size() == 1) {
-      return {get_unlinked_input_value(socket_to_compute)};
+  /**
+   * The sockets whose values are used by the input. Inputs that are not linked or that are
+   * linked to a group input of a nested group use the value stored in the socket instead.
+   */
+  static Span<const DOutputSocket *> get_used_linked_sockets(const DInputSocket &socket)
+  {
+    Span<const DOutputSocket *> from_sockets = socket.linked_sockets();
+    if (from_sockets.is_empty() || socket.linked_group_inputs().size() == 1) {
+      return {};
+    }
+    if (socket.is_multi_input_socket()) {
+      return from_sockets;
     }
+    return from_sockets.take_front(1);
+  }
 
-    /* Multi-input sockets contain a vector of inputs. */
-    if (socket_to_compute.is_multi_input_socket()) {
-      Vector<GMutablePointer> values;
-      for (const DOutputSocket *from_socket : from_sockets) {
-        const std::pair<const DInputSocket *, const DOutputSocket *> key = std::make_pair(
-            &socket_to_compute, from_socket);
-        std::optional<GMutablePointer> value = value_by_input_.pop_try(key);
-        if (value.has_value()) {
-          values.append(*value);
+  NodeState &add_node_state(const DNode &node)
+  {
+    return *node_states_.lookup_or_add_cb(&node,
+                                          [&]() { return allocator_.construct<NodeState>(); });
+  }
+
+  /**
+   * Walk the tree from the group outputs to find the nodes that have to be executed and the
+   * number of linked inputs every one of them has to wait for.
+   */
+  void find_required_nodes(const Map<const DOutputSocket *, GMutablePointer> &group_input_data)
+  {
+    Vector<const DNode *> nodes_to_check;
+
+    auto add_required_input = [&](const DInputSocket &socket, NodeState &node_state) {
+      for (const DOutputSocket *from_socket : get_used_linked_sockets(socket)) {
+        if (!from_socket->is_available()) {
+          /* The default value is used, see #get_input_values. */
+          continue;
         }
-        else {
-          this->compute_output_and_forward(*from_socket);
-          GMutablePointer value = value_by_input_.pop(key);
-          values.append(value);
+        const DNode &from_node = from_socket->node();
+        if (is_group_input_node(from_node) && !group_input_data.contains(from_socket)) {
+          continue;
+        }
+        required_links_.add_new(std::make_pair(&socket, from_socket));
+        node_state.missing_inputs++;
+        if (!is_group_input_node(from_node) && !node_states_.contains(&from_node)) {
+          this->add_node_state(from_node);
+          nodes_to_check.append(&from_node);
         }
       }
-      return values;
+    };
+
+    for (const DInputSocket *group_output : group_outputs_) {
+      NodeState &node_state = this->add_node_state(group_output->node());
+      node_state.is_group_output = true;
+      add_required_input(*group_output, node_state);
     }
 
-    const DOutputSocket &from_socket = *from_sockets[0];
-    const std::pair<const DInputSocket *, const DOutputSocket *> key = std::make_pair(
-        &socket_to_compute, &from_socket);
-    std::optional<GMutablePointer> value = value_by_input_.pop_try(key);
-    if (value.has_value()) {
-      /* This input has been computed before, return it directly. */
-      return {*value};
+    while (!nodes_to_check.is_empty()) {
+      const DNode &node = *nodes_to_check.pop_last();
+      NodeState &node_state = *node_states_.lookup(&node);
+      for (const DInputSocket *input_socket : node.inputs()) {
+        if (input_socket->is_available()) {
+          add_required_input(*input_socket, node_state);
+        }
+      }
     }
+  }
 
-    /* Compute the socket now. */
-    this->compute_output_and_forward(from_socket);
-    return {value_by_input_.pop(key)};
+  void schedule_node(const DNode &node)
+  {
+    BLI_task_pool_push(task_pool_, execute_node_task, (void *)&node, false, nullptr);
   }
 
-  void compute_output_and_forward(const DOutputSocket &socket_to_compute)
+  static void execute_node_task(TaskPool *__restrict pool, void *taskdata)
   {
-    const DNode &node = socket_to_compute.node();
-    const bNode &bnode = *node.bnode();
+    GeometryNodesEvaluator &evaluator = *(GeometryNodesEvaluator *)BLI_task_pool_user_data(pool);
+    const DNode &node = *(const DNode *)taskdata;
+    evaluator.compute_outputs_and_forward(node);
+  }
 
-    if (!socket_to_compute.is_available()) {
-      /* If the output is not available, use a default value. */
-      const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket_to_compute.typeinfo());
-      void *buffer = allocator_.allocate(type.size(), type.alignment());
-      type.copy_to_uninitialized(type.default_value(), buffer);
-      this->forward_to_inputs(socket_to_compute, {type, buffer});
-      return;
+  /**
+   * Get the values of an input socket. All linked sockets have been computed at this point.
+   */
+  Vector<GMutablePointer> get_input_values(const DInputSocket &socket_to_compute,
+                                           NodeState &node_state)
+  {
+    Span<const DOutputSocket *> from_sockets = get_used_linked_sockets(socket_to_compute);
+
+    if (from_sockets.is_empty()) {
+      /* The input is not connected, use the value from the socket itself. */
+      return {get_unlinked_input_value(socket_to_compute, node_state.allocator)};
+    }
+
+    /* Multi-input sockets contain a vector of inputs. */
+    Vector<GMutablePointer> values;
+    for (const DOutputSocket *from_socket : from_sockets) {
+      const LinkKey key = std::make_pair(&socket_to_compute, from_socket);
+      std::optional<GMutablePointer> value = node_state.value_by_input.pop_try(key);
+      if (value.has_value()) {
+        values.append(*value);
+      }
+      else {
+        /* The output is not available or has no value, use a default value. */
+        const CPPType &from_type = *blender::nodes::socket_cpp_type_get(*from_socket->typeinfo());
+        const CPPType &to_type = *blender::nodes::socket_cpp_type_get(
+            *socket_to_compute.typeinfo());
+        void *buffer = node_state.allocator.allocate(to_type.size(), to_type.alignment());
+        this->convert_value(from_type, to_type, from_type.default_value(), buffer);
+        values.append({to_type, buffer});
+      }
     }
+    return values;
+  }
+
+  void compute_outputs_and_forward(const DNode &node)
+  {
+    const bNode &bnode = *node.bnode();
+    NodeState &node_state = *node_states_.lookup(&node);
+    blender::LinearAllocator<> &allocator = node_state.allocator;
 
     /* Prepare inputs required to execute the node. */
-    GValueMap<StringRef> node_inputs_map{allocator_};
+    GValueMap<StringRef> node_inputs_map{allocator};
+    std::optional<NodesCacheKey> node_hash = this->hash_node_settings(node);
     for (const DInputSocket *input_socket : node.inputs()) {
       if (input_socket->is_available()) {
-        Vector<GMutablePointer> values = this->get_input_values(*input_socket);
+        Vector<GMutablePointer> values = this->get_input_values(*input_socket, node_state);
+        if (node_hash.has_value()) {
+          node_hash = this->hash_input_values(*input_socket, values, *node_hash);
+        }
         for (int i = 0; i < values.size(); ++i) {
           /* Values from Multi Input Sockets are stored in input map with the format
            * <identifier>[<index>]. */
-          blender::StringRefNull key = allocator_.copy_string(
+          blender::StringRefNull key = allocator.copy_string(
               input_socket->identifier() + (i > 0 ? ("[" + std::to_string(i)) + "]" : ""));
           node_inputs_map.add_new_direct(key, std::move(values[i]));
         }
       }
     }
 
+    node_state.hash = node_hash;
+    const double start_time = PIL_check_seconds_timer();
+    if (node_hash.has_value() && this->forward_cached_outputs(node, *node_hash, node_state)) {
+      node_state.is_cached = true;
+      node_state.execution_time = PIL_check_seconds_timer() - start_time;
+      return;
+    }
+
     /* Execute the node. */
-    GValueMap<StringRef> node_outputs_map{allocator_};
+    GValueMap<StringRef> node_outputs_map{allocator};
     GeoNodeExecParams params{
         bnode, node_inputs_map, node_outputs_map, handle_map_, self_object_, depsgraph_};
     this->execute_node(node, params);
 
+    Vector<GMutablePointer> output_values;
+    for (const DOutputSocket *output_socket : node.outputs()) {
+      if (output_socket->is_available()) {
+        output_values.append(node_outputs_map.extract(output_socket->identifier()));
+      }
+    }
+    node_state.execution_time = PIL_check_seconds_timer() - start_time;
+    record_output_sizes(node_state, output_values);
+    if (node_hash.has_value()) {
+      this->add_outputs_to_cache(*node_hash, output_values, node_state.execution_time);
+    }
+
     /* Forward computed outputs to linked input sockets. */
+    int output_index = 0;
+    for (const DOutputSocket *output_socket : node.outputs()) {
+      if (output_socket->is_available()) {
+        this->forward_to_inputs(*output_socket, output_values[output_index], allocator);
+        output_index++;
+      }
+    }
+  }
+
+  /**
+   * Hash everything that influences the outputs of the node, except for its inputs. Nothing is
+   * returned when the outputs should not be cached.
+   */
+  std::optional<NodesCacheKey> hash_node_settings(const DNode &node)
+  {
+    if (cache_ == nullptr) {
+      return std::nullopt;
+    }
+    const bNode &bnode = *node.bnode();
+    if (bnode.id != nullptr) {
+      /* The referenced data-block (e.g. a texture) can change without the node changing. */
+      return std::nullopt;
+    }
+    NodesCacheKey key;
+    key.add(blender::hash_string(node.idname()));
+    key.add(static_cast<uint64_t>(bnode.custom1));
+    key.add(static_cast<uint64_t>(bnode.custom2));
+    key.add(blender::DefaultHash<float>{}(bnode.custom3));
+    key.add(blender::DefaultHash<float>{}(bnode.custom4));
+    if (bnode.storage != nullptr) {
+      const SDNA &sdna = *DNA_sdna_current_get();
+      const int struct_nr = DNA_struct_find_nr(&sdna, bnode.typeinfo->storagename);
+      if (struct_nr == -1) {
+        return std::nullopt;
+      }
+      hash_dna_struct(key, sdna, struct_nr, static_cast<const char *>(bnode.storage));
+    }
+    for (const DInputSocket *socket : node.inputs()) {
+      key.add(socket->is_available());
+    }
+    for (const DOutputSocket *socket : node.outputs()) {
+      key.add(socket->is_available());
+    }
+    return key;
+  }
+
+  std::optional<NodesCacheKey> hash_input_values(const DInputSocket &socket,
+                                                 Span<GMutablePointer> values,
+                                                 NodesCacheKey key)
+  {
+    /* The socket type decides about implicit conversions. */
+    key.add(blender::hash_string(socket.idname()));
+    Span<const DOutputSocket *> from_sockets = get_used_linked_sockets(socket);
+    for (const int i : values.index_range()) {
+      std::optional<NodesCacheKey> value_hash;
+      if (i < from_sockets.size() && required_links_.contains({&socket, from_sockets[i]})) {
+        value_hash = this->get_output_hash(*from_sockets[i]);
+      }
+      else {
+        value_hash = hash_value(values[i]);
+      }
+      if (!value_hash.has_value()) {
+        return std::nullopt;
+      }
+      key.add(*value_hash);
+    }
+    return key;
+  }
+
+  std::optional<NodesCacheKey> get_output_hash(const DOutputSocket &socket)
+  {
+    const DNode &node = socket.node();
+    if (is_group_input_node(node)) {
+      return group_input_hashes_.lookup_default(&socket, std::nullopt);
+    }
+    const std::optional<NodesCacheKey> &node_hash = node_states_.lookup(&node)->hash;
+    if (!node_hash.has_value()) {
+      return std::nullopt;
+    }
+    NodesCacheKey key = *node_hash;
+    key.add(static_cast<uint64_t>(socket.index()));
+    return key;
+  }
+
+  /** Forward copies of the cached outputs of the node, if there are any. */
+  bool forward_cached_outputs(const DNode &node,
+                              const NodesCacheKey &node_hash,
+                              NodeState &node_state)
+  {
+    blender::LinearAllocator<> &allocator = node_state.allocator;
+    Vector<GMutablePointer> values;
+    {
+      std::lock_guard<std::mutex> lock{cache_->mutex};
+      NodesModifierCache::Entry *entry = cache_->entries.lookup_ptr(node_hash);
+      if (entry == nullptr) {
+        cache_->misses++;
+        return false;
+      }
+      cache_->hits++;
+      entry->last_used = cache_->evaluation_count;
+      for (GMutablePointer cached_value : entry->values) {
+        const CPPType &type = *cached_value.type();
+        void *buffer = allocator.allocate(type.size(), type.alignment());
+        type.copy_to_uninitialized(cached_value.get(), buffer);
+        values.append({type, buffer});
+      }
+    }
+    record_output_sizes(node_state, values);
+
+    int output_index = 0;
     for (const DOutputSocket *output_socket : node.outputs()) {
       if (output_socket->is_available()) {
-        GMutablePointer value = node_outputs_map.extract(output_socket->identifier());
-        this->forward_to_inputs(*output_socket, value);
+        this->forward_to_inputs(*output_socket, values[output_index], allocator);
+        output_index++;
       }
     }
+    return true;
+  }
+
+  static void record_output_sizes(NodeState &node_state, Span<GMutablePointer> values)
+  {
+    for (const GMutablePointer value : values) {
+      if (value.type()->is<GeometrySet>()) {
+        node_state.output_elements += geometry_set_elements_amount(
+            *static_cast<const GeometrySet *>(value.get()));
+      }
+      node_state.output_memory += value_size(value);
+    }
+  }
+
+  void add_outputs_to_cache(const NodesCacheKey &node_hash,
+                            Span<GMutablePointer> values,
+                            const double execution_time)
+  {
+    int64_t size = 0;
+    for (const GMutablePointer value : values) {
+      size += value_size(value);
+    }
+    if (!(nodes_cache_all_outputs || is_worth_caching(execution_time, size)) ||
+        size > NODES_CACHE_MAX_SIZE ||
+        nodes_cache_size_global + size > NODES_CACHE_MAX_SIZE_GLOBAL) {
+      return;
+    }
+
+    NodesModifierCache::Entry entry;
+    entry.size = size;
+    for (const GMutablePointer value : values) {
+      const CPPType &type = *value.type();
+      void *buffer = MEM_mallocN_aligned(type.size(), type.alignment(), __func__);
+      type.copy_to_uninitialized(value.get(), buffer);
+      if (type.is<GeometrySet>()) {
+        /* The output can still reference data the node did not create, like the input mesh of
+         * the modifier that is modified in place. That data is freed after this evaluation. */
+        static_cast<GeometrySet *>(buffer)->ensure_owns_direct_data();
+      }
+      entry.values.append({type, buffer});
+    }
+
+    std::lock_guard<std::mutex> lock{cache_->mutex};
+    if (cache_->entries.contains(node_hash)) {
+      /* Another node with the same inputs has been cached already. */
+      NodesModifierCache::free_values(entry.values);
+      return;
+    }
+    entry.last_used = cache_->evaluation_count;
+    cache_->add_entry(node_hash, std::move(entry));
   }
 
   void execute_node(const DNode &node, GeoNodeExecParams params)
@@ -384,11 +1143,12 @@ class GeometryNodesEvaluator {
         input_data.append(data);
       }
     }
+    blender::LinearAllocator<> &allocator = node_states_.lookup(&node)->allocator;
     Vector<GMutablePointer> output_data;
     for (const DOutputSocket *dsocket : node.outputs()) {
       if (dsocket->is_available()) {
         const CPPType &type = *blender::nodes::socket_cpp_type_get(*dsocket->typeinfo());
-        void *buffer = allocator_.allocate(type.size(), type.alignment());
+        void *buffer = allocator.allocate(type.size(), type.alignment());
         fn_params.add_uninitialized_single_output(GMutableSpan(type, buffer, 1));
         output_data.append(GMutablePointer(type, buffer));
       }
@@ -418,69 +1178,83 @@ class GeometryNodesEvaluator {
     }
   }
 
-  void forward_to_inputs(const DOutputSocket &from_socket, GMutablePointer value_to_forward)
+  void convert_value(const CPPType &from_type,
+                     const CPPType &to_type,
+                     const void *from_value,
+                     void *to_buffer)
   {
-    /* For all sockets that are linked with the from_socket push the value to their node. */
-    Span<const DInputSocket *> to_sockets_all = from_socket.linked_sockets();
+    if (from_type == to_type) {
+      from_type.copy_to_uninitialized(from_value, to_buffer);
+    }
+    else if (conversions_.is_convertible(from_type, to_type)) {
+      conversions_.convert(from_type, to_type, from_value, to_buffer);
+    }
+    else {
+      to_type.copy_to_uninitialized(to_type.default_value(), to_buffer);
+    }
+  }
 
+  void forward_to_inputs(const DOutputSocket &from_socket,
+                         GMutablePointer value_to_forward,
+                         blender::LinearAllocator<> &allocator)
+  {
+    /* For all required sockets that are linked with the from_socket push the value to their
+     * node. Values are not computed for sockets that are not required. */
     const CPPType &from_type = *value_to_forward.type();
     Vector<const DInputSocket *> to_sockets_same_type;
-    for (const DInputSocket *to_socket : to_sockets_all) {
+    for (const DInputSocket *to_socket : from_socket.linked_sockets()) {
+      const LinkKey key = std::make_pair(to_socket, &from_socket);
+      if (!required_links_.contains(key)) {
+        continue;
+      }
       const CPPType &to_type = *blender::nodes::socket_cpp_type_get(*to_socket->typeinfo());
-      const std::pair<const DInputSocket *, const DOutputSocket *> key = std::make_pair(
-          to_socket, &from_socket);
       if (from_type == to_type) {
         to_sockets_same_type.append(to_socket);
       }
       else {
-        void *buffer = allocator_.allocate(to_type.size(), to_type.alignment());
-        if (conversions_.is_convertible(from_type, to_type)) {
-          conversions_.convert(from_type, to_type, value_to_forward.get(), buffer);
-        }
-        else {
-          to_type.copy_to_uninitialized(to_type.default_value(), buffer);
-        }
-        add_value_to_input_socket(key, GMutablePointer{to_type, buffer});
+        void *buffer = allocator.allocate(to_type.size(), to_type.alignment());
+        this->convert_value(from_type, to_type, value_to_forward.get(), buffer);
+        this->add_value_to_input_socket(key, GMutablePointer{to_type, buffer});
       }
     }
 
     if (to_sockets_same_type.size() == 0) {
       /* This value is not further used, so destruct it. */
       value_to_forward.destruct();
+      return;
     }
-    else if (to_sockets_same_type.size() == 1) {
-      /* This value is only used on one input socket, no need to copy it. */
-      const DInputSocket *to_socket = to_sockets_same_type[0];
-      const std::pair<const DInputSocket *, const DOutputSocket *> key = std::make_pair(
-          to_socket, &from_socket);
 
-      add_value_to_input_socket(key, value_to_forward);
-    }
-    else {
-      /* Multiple inputs use the value, make a copy for every input except for one. */
-      const DInputSocket *first_to_socket = to_sockets_same_type[0];
-      Span<const DInputSocket *> other_to_sockets = to_sockets_same_type.as_span().drop_front(1);
-      const CPPType &type = *value_to_forward.type();
-      const std::pair<const DInputSocket *, const DOutputSocket *> first_key = std::make_pair(
-          first_to_socket, &from_socket);
-      add_value_to_input_socket(first_key, value_to_forward);
-      for (const DInputSocket *to_socket : other_to_sockets) {
-        const std::pair<const DInputSocket *, const DOutputSocket *> key = std::make_pair(
-            to_socket, &from_socket);
-        void *buffer = allocator_.allocate(type.size(), type.alignment());
-        type.copy_to_uninitialized(value_to_forward.get(), buffer);
-        add_value_to_input_socket(key, GMutablePointer{type, buffer});
-      }
+    /* Make a copy for every input except for one, which gets the computed value itself. This
+     * avoids copying the value when it is only used by a single input socket. The copies are made
+     * before passing on the value, because its new owner may run and modify it right away. */
+    for (const DInputSocket *to_socket : to_sockets_same_type.as_span().drop_front(1)) {
+      void *buffer = allocator.allocate(from_type.size(), from_type.alignment());
+      from_type.copy_to_uninitialized(value_to_forward.get(), buffer);
+      this->add_value_to_input_socket(std::make_pair(to_socket, &from_socket),
+                                      GMutablePointer{from_type, buffer});
     }
+    this->add_value_to_input_socket(std::make_pair(to_sockets_same_type[0], &from_socket),
+                                    value_to_forward);
   }
 
-  void add_value_to_input_socket(const std::pair<const DInputSocket *, const DOutputSocket *> key,
-                                 GMutablePointer value)
+  void add_value_to_input_socket(const LinkKey key, GMutablePointer value)
   {
-    value_by_input_.add_new(key, value);
+    const DNode &node = key.first->node();
+    NodeState &node_state = *node_states_.lookup(&node);
+    {
+      std::lock_guard<std::mutex> lock{node_state.value_mutex};
+      node_state.value_by_input.add_new(key, value);
+    }
+    const bool is_last_input = node_state.missing_inputs.fetch_sub(1) == 1;
+    /* Before the evaluation starts, only the group inputs are forwarded. The nodes that are ready
+     * at that point are started by #execute. */
+    if (is_last_input && !node_state.is_group_output && task_pool_ != nullptr) {
+      this->schedule_node(node);
+    }
   }
 
-  GMutablePointer get_unlinked_input_value(const DInputSocket &socket)
+  GMutablePointer get_unlinked_input_value(const DInputSocket &socket,
+                                           blender::LinearAllocator<> &allocator)
   {
     bNodeSocket *bsocket;
     if (socket.linked_group_inputs().size() == 0) {
@@ -490,7 +1264,7 @@ class GeometryNodesEvaluator {
       bsocket = socket.linked_group_inputs()[0]->bsocket();
     }
     const CPPType &type = *blender::nodes::socket_cpp_type_get(*socket.typeinfo());
-    void *buffer = allocator_.allocate(type.size(), type.alignment());
+    void *buffer = allocator.allocate(type.size(), type.alignment());
 
     if (bsocket->type == SOCK_OBJECT) {
       Object *object = ((bNodeSocketValueObject *)bsocket->default_value)->value;
@@ -881,6 +1655,33 @@ void MOD_nodes_init(Main *bmain, NodesModifierData *nmd)
   ntreeUpdateTree(bmain, ntree);
 }
 
+const NodesModifierNodeProfile *MOD_nodes_profile_get(const NodesModifierData *nmd, int *r_len)
+{
+  const NodesModifierRuntime *runtime = static_cast<const NodesModifierRuntime *>(
+      nmd->modifier.runtime);
+  if (runtime == nullptr) {
+    *r_len = 0;
+    return nullptr;
+  }
+  *r_len = runtime->profile.nodes.size();
+  return runtime->profile.nodes.data();
+}
+
+const NodesModifierNodeProfile *MOD_nodes_profile_lookup(const NodesModifierData *nmd,
+                                                         const unsigned int instance_key)
+{
+  const NodesModifierRuntime *runtime = static_cast<const NodesModifierRuntime *>(
+      nmd->modifier.runtime);
+  if (runtime == nullptr) {
+    return nullptr;
+  }
+  const int *index = runtime->profile.index_by_key.lookup_ptr(instance_key);
+  if (index == nullptr) {
+    return nullptr;
+  }
+  return &runtime->profile.nodes[*index];
+}
+
 static void initialize_group_input(NodesModifierData &nmd,
                                    const PersistentDataHandleMap &handle_map,
                                    const bNodeSocket &socket,
@@ -926,8 +1727,6 @@ static void fill_data_handle_map(const NodesModifierSettings &settings,
 
 /**
  * Evaluate a node group to compute the output geometry.
- * Currently, this uses a fairly basic and inefficient algorithm that might compute things more
- * often than necessary. It's going to be replaced soon.
  */
 static GeometrySet compute_geometry(const DerivedNodeTree &tree,
                                     Span<const DOutputSocket *> group_input_sockets,
@@ -970,13 +1769,45 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   Vector<const DInputSocket *> group_outputs;
   group_outputs.append(&socket_to_compute);
 
-  GeometryNodesEvaluator evaluator{
-      group_inputs, group_outputs, mf_by_node, handle_map, ctx->object, ctx->depsgraph};
-  Vector<GMutablePointer> results = evaluator.execute();
-  BLI_assert(results.size() == 1);
-  GMutablePointer result = results[0];
+  if (nmd->modifier.runtime == nullptr) {
+    nmd->modifier.runtime = OBJECT_GUARDED_NEW(NodesModifierRuntime);
+  }
+  NodesModifierRuntime &runtime = *static_cast<NodesModifierRuntime *>(nmd->modifier.runtime);
+
+  /* Only cache when the result of the evaluation is kept around as well. */
+  NodesModifierCache *cache = nullptr;
+  if (ctx->flag & MOD_APPLY_USECACHE) {
+    cache = &runtime.cache;
+    cache->begin_evaluation();
+  }
+
+  GeometrySet output_geometry;
+  {
+    GeometryNodesEvaluator evaluator{
+        group_inputs, group_outputs, mf_by_node, handle_map, ctx->object, ctx->depsgraph, cache};
+    Vector<GMutablePointer> results = evaluator.execute();
+    BLI_assert(results.size() == 1);
+    GMutablePointer result = results[0];
+
+    output_geometry = std::move(*(GeometrySet *)result.get());
+
+    runtime.profile = NodesModifierProfile();
+    evaluator.fill_profile(runtime.profile);
+  }
+
+  if (cache != nullptr) {
+    cache->end_evaluation();
+    if (G.debug & G_DEBUG) {
+      printf("%s: node cache %d hits, %d misses, %d evicted, %d entries (%.1f MiB)\n",
+             nmd->modifier.name,
+             cache->hits,
+             cache->misses,
+             cache->evictions,
+             static_cast<int>(cache->entries.size()),
+             cache->size / (1024.0 * 1024.0));
+    }
+  }
 
-  GeometrySet output_geometry = std::move(*(GeometrySet *)result.get());
   return output_geometry;
 }
 
@@ -1220,6 +2051,17 @@ static void freeData(ModifierData *md)
     IDP_FreeProperty_ex(nmd->settings.properties, false);
     nmd->settings.properties = nullptr;
   }
+  if (nmd->modifier.runtime != nullptr) {
+    NodesModifierRuntime *runtime = static_cast<NodesModifierRuntime *>(nmd->modifier.runtime);
+    OBJECT_GUARDED_DELETE(runtime, NodesModifierRuntime);
+    nmd->modifier.runtime = nullptr;
+  }
+}
+
+static void freeRuntimeData(void *runtime_data)
+{
+  NodesModifierRuntime *runtime = static_cast<NodesModifierRuntime *>(runtime_data);
+  OBJECT_GUARDED_DELETE(runtime, NodesModifierRuntime);
 }
 
 static void requiredDataMask(Object *UNUSED(ob),
@@ -1263,7 +2105,7 @@ ModifierTypeInfo modifierType_Nodes = {
     /* dependsOnNormals */ nullptr,
     /* foreachIDLink */ foreachIDLink,
     /* foreachTexLink */ nullptr,
-    /* freeRuntimeData */ nullptr,
+    /* freeRuntimeData */ freeRuntimeData,
     /* panelRegister */ panelRegister,
     /* blendWrite */ blendWrite,
     /* blendRead */ blendRead,
@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_blender.h"
+#include "BKE_global.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_node.h"
+#include "BKE_object.h"
+
+#include "BLI_math_vector.h"
+#include "BLI_threads.h"
+
+#include "DNA_genfile.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+#include "DNA_node_types.h"
+#include "DNA_object_types.h"
+
+#include "RNA_define.h"
+
+#include "MOD_nodes.h"
+
+#include "CLG_log.h"
+
+namespace blender::modifiers::tests {
+
+class NodesModifierCacheTest : public testing::Test {
+ protected:
+  Main *bmain = nullptr;
+  Object *object = nullptr;
+  bNodeTree *ntree = nullptr;
+  ModifierData *md = nullptr;
+
+  static void SetUpTestCase()
+  {
+    testing::Test::SetUpTestCase();
+    CLG_init();
+    BLI_threadapi_init();
+    DNA_sdna_current_init();
+    BKE_blender_globals_init();
+    BKE_idtype_init();
+    BKE_appdir_init();
+    BKE_modifier_init();
+    RNA_init();
+    BKE_node_system_init();
+    G.background = true;
+  }
+
+  static void TearDownTestCase()
+  {
+    BKE_blender_free();
+    RNA_exit();
+    DNA_sdna_current_free();
+    BLI_threadapi_exit();
+    BKE_blender_atexit();
+    BKE_appdir_exit();
+    CLG_exit();
+    testing::Test::TearDownTestCase();
+  }
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    object = BKE_object_add_only_object(bmain, OB_MESH, "Object");
+
+    /* Group Input -> Transform -> Group Output. The transform node modifies the input mesh of
+     * the modifier in place and passes it on. */
+    ntree = ntreeAddTree(bmain, "Geometry Nodes", "GeometryNodeTree");
+    ntreeAddSocketInterface(ntree, SOCK_IN, "NodeSocketGeometry", "Geometry");
+    ntreeAddSocketInterface(ntree, SOCK_OUT, "NodeSocketGeometry", "Geometry");
+    bNode *group_input = nodeAddStaticNode(nullptr, ntree, NODE_GROUP_INPUT);
+    bNode *group_output = nodeAddStaticNode(nullptr, ntree, NODE_GROUP_OUTPUT);
+    bNode *transform = nodeAddStaticNode(nullptr, ntree, GEO_NODE_TRANSFORM);
+    ntreeUpdateTree(bmain, ntree);
+
+    bNodeSocket *translation = nodeFindSocket(transform, SOCK_IN, "Translation");
+    copy_v3_fl3(((bNodeSocketValueVector *)translation->default_value)->value, 1.0f, 0.0f, 0.0f);
+    nodeAddLink(ntree,
+                group_input,
+                (bNodeSocket *)group_input->outputs.first,
+                transform,
+                nodeFindSocket(transform, SOCK_IN, "Geometry"));
+    nodeAddLink(ntree,
+                transform,
+                nodeFindSocket(transform, SOCK_OUT, "Geometry"),
+                group_output,
+                (bNodeSocket *)group_output->inputs.first);
+    ntreeUpdateTree(bmain, ntree);
+
+    md = BKE_modifier_new(eModifierType_Nodes);
+    NodesModifierData *nmd = (NodesModifierData *)md;
+    nmd->node_group = ntree;
+    MOD_nodes_update_interface(object, nmd);
+
+    MOD_nodes_cache_all_outputs_set(true);
+  }
+
+  void TearDown() override
+  {
+    MOD_nodes_cache_all_outputs_set(false);
+    BKE_modifier_free(md);
+    BKE_main_free(bmain);
+  }
+
+  /* Evaluate the modifier on a new mesh with a single vertex at the origin. */
+  Mesh *evaluate()
+  {
+    Mesh *mesh = BKE_mesh_new_nomain(1, 0, 0, 0, 0);
+    zero_v3(mesh->mvert[0].co);
+    ModifierEvalContext ctx = {nullptr, object, MOD_APPLY_USECACHE};
+    const ModifierTypeInfo *mti = BKE_modifier_get_info(eModifierType_Nodes);
+    Mesh *result = mti->modifyMesh(md, &ctx, mesh);
+    if (result != mesh) {
+      BKE_id_free(nullptr, mesh);
+    }
+    return result;
+  }
+};
+
+TEST_F(NodesModifierCacheTest, output_shares_input_mesh)
+{
+  const float expected[3] = {1.0f, 0.0f, 0.0f};
+
+  /* The first evaluation caches the output of the transform node, which is the input mesh. */
+  Mesh *result = this->evaluate();
+  ASSERT_EQ(result->totvert, 1);
+  EXPECT_V3_NEAR(result->mvert[0].co, expected, 1e-6f);
+  BKE_id_free(nullptr, result);
+
+  /* The second evaluation has the same inputs, so it uses the cached output, which must not
+   * reference the input mesh of the first evaluation that has been freed. */
+  result = this->evaluate();
+  ASSERT_EQ(result->totvert, 1);
+  EXPECT_V3_NEAR(result->mvert[0].co, expected, 1e-6f);
+  BKE_id_free(nullptr, result);
+
+  int profile_len;
+  const NodesModifierNodeProfile *profile = MOD_nodes_profile_get((NodesModifierData *)md,
+                                                                  &profile_len);
+  bool transform_is_cached = false;
+  for (int i = 0; i < profile_len; i++) {
+    transform_is_cached |= profile[i].is_cached;
+  }
+  EXPECT_TRUE(transform_is_cached);
+}
+
+}  // namespace blender::modifiers::tests
@@ -14,6 +14,8 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include "BLI_task.hh"
+
 #include "node_geometry_util.hh"
 #include "node_util.h"
 
@@ -89,6 +91,37 @@ CustomDataType attribute_data_type_highest_complexity(Span<CustomDataType> data_
   return most_complex_type;
 }
 
+/**
+ * Compute the result attribute with a multi-function that has a single input parameter for every
+ * input attribute, followed by one single output parameter. The elements are split into chunks
+ * that are computed in parallel. Inputs that have the same value for all elements are passed to
+ * the function as single value, instead of being expanded to an array first.
+ */
+void attribute_call_multi_function(const fn::MultiFunction &fn,
+                                   Span<const ReadAttribute *> inputs,
+                                   WriteAttribute &result)
+{
+  const int64_t size = result.size();
+  Vector<fn::GVSpan> input_spans;
+  for (const ReadAttribute *input : inputs) {
+    BLI_assert(input->size() == size);
+    input_spans.append(input->get_virtual_span());
+  }
+  fn::GMutableSpan result_span = result.get_span_for_write_only();
+
+  parallel_for(IndexRange(size), 4096, [&](IndexRange range) {
+    fn::MFParamsBuilder params{fn, size};
+    for (const fn::GVSpan &input_span : input_spans) {
+      params.add_readonly_single_input(input_span);
+    }
+    params.add_uninitialized_single_output(result_span);
+    fn::MFContextBuilder context;
+    fn.call(range, params, context);
+  });
+
+  result.apply_span();
+}
+
 }  // namespace blender::nodes
 
 bool geo_node_poll_default(bNodeType *UNUSED(ntype), bNodeTree *ntree)
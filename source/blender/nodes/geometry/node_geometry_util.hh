@@ -27,6 +27,8 @@
 
 #include "BKE_node.h"
 
+#include "FN_multi_function.hh"
+
 #include "BLT_translation.h"
 
 #include "NOD_geometry.h"
@@ -49,4 +51,8 @@ CustomDataType attribute_data_type_highest_complexity(Span<CustomDataType>);
 Array<uint32_t> get_geometry_element_ids_as_uints(const GeometryComponent &component,
                                                   const AttributeDomain domain);
 
+void attribute_call_multi_function(const fn::MultiFunction &fn,
+                                   Span<const ReadAttribute *> inputs,
+                                   WriteAttribute &result);
+
 }  // namespace blender::nodes
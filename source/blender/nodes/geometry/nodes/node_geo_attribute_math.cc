@@ -26,6 +26,8 @@
 #include "DNA_mesh_types.h"
 #include "DNA_pointcloud_types.h"
 
+#include "FN_multi_function_builder.hh"
+
 #include "NOD_math_functions.hh"
 
 static bNodeSocketTemplate geo_node_attribute_math_in[] = {
@@ -138,46 +140,45 @@ static void geo_node_attribute_math_update(bNodeTree *UNUSED(ntree), bNode *node
       operation_use_input_c(operation));
 }
 
-static void do_math_operation(Span<float> span_a,
-                              Span<float> span_b,
-                              Span<float> span_c,
-                              MutableSpan<float> span_result,
+static void do_math_operation(const ReadAttribute &attribute_a,
+                              const ReadAttribute &attribute_b,
+                              const ReadAttribute &attribute_c,
+                              WriteAttribute &attribute_result,
                               const NodeMathOperation operation)
 {
   bool success = try_dispatch_float_math_fl_fl_fl_to_fl(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(span_result.size())) {
-          span_result[i] = math_function(span_a[i], span_b[i], span_c[i]);
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SI_SI_SO<float, float, float, float> fn{info.title_case_name,
+                                                                math_function};
+        attribute_call_multi_function(
+            fn, {&attribute_a, &attribute_b, &attribute_c}, attribute_result);
       });
   BLI_assert(success);
   UNUSED_VARS_NDEBUG(success);
 }
 
-static void do_math_operation(Span<float> span_a,
-                              Span<float> span_b,
-                              MutableSpan<float> span_result,
+static void do_math_operation(const ReadAttribute &attribute_a,
+                              const ReadAttribute &attribute_b,
+                              WriteAttribute &attribute_result,
                               const NodeMathOperation operation)
 {
   bool success = try_dispatch_float_math_fl_fl_to_fl(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(span_result.size())) {
-          span_result[i] = math_function(span_a[i], span_b[i]);
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SI_SO<float, float, float> fn{info.title_case_name, math_function};
+        attribute_call_multi_function(fn, {&attribute_a, &attribute_b}, attribute_result);
       });
   BLI_assert(success);
   UNUSED_VARS_NDEBUG(success);
 }
 
-static void do_math_operation(Span<float> span_input,
-                              MutableSpan<float> span_result,
+static void do_math_operation(const ReadAttribute &attribute_input,
+                              WriteAttribute &attribute_result,
                               const NodeMathOperation operation)
 {
   bool success = try_dispatch_float_math_fl_to_fl(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(span_result.size())) {
-          span_result[i] = math_function(span_input[i]);
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SO<float, float> fn{info.title_case_name, math_function};
+        attribute_call_multi_function(fn, {&attribute_input}, attribute_result);
       });
   BLI_assert(success);
   UNUSED_VARS_NDEBUG(success);
@@ -208,8 +209,6 @@ static void attribute_math_calc(GeometryComponent &component, const GeoNodeExecP
     return;
   }
 
-  /* Note that passing the data with `get_span<float>()` works
-   * because the attributes were accessed with #CD_PROP_FLOAT. */
   if (operation_use_input_b(operation)) {
     ReadAttributePtr attribute_b = params.get_input_attribute(
         "B", component, result_domain, result_type, nullptr);
@@ -222,26 +221,18 @@ static void attribute_math_calc(GeometryComponent &component, const GeoNodeExecP
       if (!attribute_c) {
         return;
       }
-      do_math_operation(attribute_a->get_span<float>(),
-                        attribute_b->get_span<float>(),
-                        attribute_c->get_span<float>(),
-                        attribute_result->get_span_for_write_only<float>(),
-                        operation);
+      do_math_operation(
+          *attribute_a, *attribute_b, *attribute_c, *attribute_result, operation);
     }
     else {
-      do_math_operation(attribute_a->get_span<float>(),
-                        attribute_b->get_span<float>(),
-                        attribute_result->get_span_for_write_only<float>(),
-                        operation);
+      do_math_operation(*attribute_a, *attribute_b, *attribute_result, operation);
     }
   }
   else {
-    do_math_operation(attribute_a->get_span<float>(),
-                      attribute_result->get_span_for_write_only<float>(),
-                      operation);
+    do_math_operation(*attribute_a, *attribute_result, operation);
   }
 
-  attribute_result.apply_span_and_save();
+  attribute_result.save();
 }
 
 static void geo_node_attribute_math_exec(GeoNodeExecParams params)
@@ -18,6 +18,8 @@
 
 #include "DNA_material_types.h"
 
+#include "FN_multi_function_builder.hh"
+
 #include "node_geometry_util.hh"
 
 static bNodeSocketTemplate geo_node_attribute_mix_in[] = {
@@ -43,73 +45,41 @@ static bNodeSocketTemplate geo_node_mix_attribute_out[] = {
 
 namespace blender::nodes {
 
-static void do_mix_operation_float(const int blend_mode,
-                                   const FloatReadAttribute &factors,
-                                   const FloatReadAttribute &inputs_a,
-                                   const FloatReadAttribute &inputs_b,
-                                   FloatWriteAttribute results)
-{
-  const int size = results.size();
-  for (const int i : IndexRange(size)) {
-    const float factor = factors[i];
-    float3 a{inputs_a[i]};
-    const float3 b{inputs_b[i]};
-    ramp_blend(blend_mode, a, factor, b);
-    const float result = a.x;
-    results.set(i, result);
-  }
-}
-
-static void do_mix_operation_float3(const int blend_mode,
-                                    const FloatReadAttribute &factors,
-                                    const Float3ReadAttribute &inputs_a,
-                                    const Float3ReadAttribute &inputs_b,
-                                    Float3WriteAttribute results)
-{
-  const int size = results.size();
-  for (const int i : IndexRange(size)) {
-    const float factor = factors[i];
-    float3 a = inputs_a[i];
-    const float3 b = inputs_b[i];
-    ramp_blend(blend_mode, a, factor, b);
-    results.set(i, a);
-  }
-}
-
-static void do_mix_operation_color4f(const int blend_mode,
-                                     const FloatReadAttribute &factors,
-                                     const Color4fReadAttribute &inputs_a,
-                                     const Color4fReadAttribute &inputs_b,
-                                     Color4fWriteAttribute results)
-{
-  const int size = results.size();
-  for (const int i : IndexRange(size)) {
-    const float factor = factors[i];
-    Color4f a = inputs_a[i];
-    const Color4f b = inputs_b[i];
-    ramp_blend(blend_mode, a, factor, b);
-    results.set(i, a);
-  }
-}
-
 static void do_mix_operation(const CustomDataType result_type,
                              int blend_mode,
-                             const FloatReadAttribute &attribute_factor,
+                             const ReadAttribute &attribute_factor,
                              const ReadAttribute &attribute_a,
                              const ReadAttribute &attribute_b,
                              WriteAttribute &attribute_result)
 {
+  const Vector<const ReadAttribute *> inputs = {&attribute_factor, &attribute_a, &attribute_b};
   if (result_type == CD_PROP_FLOAT) {
-    do_mix_operation_float(
-        blend_mode, attribute_factor, attribute_a, attribute_b, attribute_result);
+    fn::CustomMF_SI_SI_SI_SO<float, float, float, float> fn{
+        "Mix Float", [blend_mode](const float factor, const float a, const float b) {
+          float3 result{a};
+          ramp_blend(blend_mode, result, factor, float3(b));
+          return result.x;
+        }};
+    attribute_call_multi_function(fn, inputs, attribute_result);
   }
   else if (result_type == CD_PROP_FLOAT3) {
-    do_mix_operation_float3(
-        blend_mode, attribute_factor, attribute_a, attribute_b, attribute_result);
+    fn::CustomMF_SI_SI_SI_SO<float, float3, float3, float3> fn{
+        "Mix Float3", [blend_mode](const float factor, const float3 a, const float3 b) {
+          float3 result = a;
+          ramp_blend(blend_mode, result, factor, b);
+          return result;
+        }};
+    attribute_call_multi_function(fn, inputs, attribute_result);
   }
   else if (result_type == CD_PROP_COLOR) {
-    do_mix_operation_color4f(
-        blend_mode, attribute_factor, attribute_a, attribute_b, attribute_result);
+    fn::CustomMF_SI_SI_SI_SO<float, Color4f, Color4f, Color4f> fn{
+        "Mix Color",
+        [blend_mode](const float factor, const Color4f &a, const Color4f &b) {
+          Color4f result = a;
+          ramp_blend(blend_mode, result, factor, b);
+          return result;
+        }};
+    attribute_call_multi_function(fn, inputs, attribute_result);
   }
 }
 
@@ -142,8 +112,9 @@ static void attribute_mix_calc(GeometryComponent &component, const GeoNodeExecPa
     return;
   }
 
-  FloatReadAttribute attribute_factor = params.get_input_attribute<float>(
-      "Factor", component, result_domain, 0.5f);
+  const float default_factor = 0.5f;
+  ReadAttributePtr attribute_factor = params.get_input_attribute(
+      "Factor", component, result_domain, CD_PROP_FLOAT, &default_factor);
   ReadAttributePtr attribute_a = params.get_input_attribute(
       "A", component, result_domain, result_type, nullptr);
   ReadAttributePtr attribute_b = params.get_input_attribute(
@@ -151,7 +122,7 @@ static void attribute_mix_calc(GeometryComponent &component, const GeoNodeExecPa
 
   do_mix_operation(result_type,
                    node_storage->blend_type,
-                   attribute_factor,
+                   *attribute_factor,
                    *attribute_a,
                    *attribute_b,
                    *attribute_result);
@@ -26,6 +26,8 @@
 #include "DNA_mesh_types.h"
 #include "DNA_pointcloud_types.h"
 
+#include "FN_multi_function_builder.hh"
+
 #include "NOD_math_functions.hh"
 
 static bNodeSocketTemplate geo_node_attribute_vector_math_in[] = {
@@ -140,166 +142,97 @@ static void geo_node_attribute_vector_math_update(bNodeTree *UNUSED(ntree), bNod
       operation_use_input_c(operation));
 }
 
-static void do_math_operation_fl3_fl3_to_fl3(const Float3ReadAttribute &input_a,
-                                             const Float3ReadAttribute &input_b,
-                                             Float3WriteAttribute result,
+static void do_math_operation_fl3_fl3_to_fl3(const ReadAttribute &input_a,
+                                             const ReadAttribute &input_b,
+                                             WriteAttribute &result,
                                              const NodeVectorMathOperation operation)
 {
-  const int size = input_a.size();
-
-  Span<float3> span_a = input_a.get_span();
-  Span<float3> span_b = input_b.get_span();
-  MutableSpan<float3> span_result = result.get_span_for_write_only();
-
   bool success = try_dispatch_float_math_fl3_fl3_to_fl3(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(size)) {
-          const float3 a = span_a[i];
-          const float3 b = span_b[i];
-          const float3 out = math_function(a, b);
-          span_result[i] = out;
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SI_SO<float3, float3, float3> fn{info.title_case_name, math_function};
+        attribute_call_multi_function(fn, {&input_a, &input_b}, result);
       });
 
-  result.apply_span();
-
   /* The operation is not supported by this node currently. */
   BLI_assert(success);
   UNUSED_VARS_NDEBUG(success);
 }
 
-static void do_math_operation_fl3_fl3_fl3_to_fl3(const Float3ReadAttribute &input_a,
-                                                 const Float3ReadAttribute &input_b,
-                                                 const Float3ReadAttribute &input_c,
-                                                 Float3WriteAttribute result,
+static void do_math_operation_fl3_fl3_fl3_to_fl3(const ReadAttribute &input_a,
+                                                 const ReadAttribute &input_b,
+                                                 const ReadAttribute &input_c,
+                                                 WriteAttribute &result,
                                                  const NodeVectorMathOperation operation)
 {
-  const int size = input_a.size();
-
-  Span<float3> span_a = input_a.get_span();
-  Span<float3> span_b = input_b.get_span();
-  Span<float3> span_c = input_c.get_span();
-  MutableSpan<float3> span_result = result.get_span_for_write_only();
-
   bool success = try_dispatch_float_math_fl3_fl3_fl3_to_fl3(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(size)) {
-          const float3 a = span_a[i];
-          const float3 b = span_b[i];
-          const float3 c = span_c[i];
-          const float3 out = math_function(a, b, c);
-          span_result[i] = out;
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SI_SI_SO<float3, float3, float3, float3> fn{info.title_case_name,
+                                                                    math_function};
+        attribute_call_multi_function(fn, {&input_a, &input_b, &input_c}, result);
       });
 
-  result.apply_span();
-
   /* The operation is not supported by this node currently. */
   BLI_assert(success);
   UNUSED_VARS_NDEBUG(success);
 }
 
-static void do_math_operation_fl3_fl3_to_fl(const Float3ReadAttribute &input_a,
-                                            const Float3ReadAttribute &input_b,
-                                            FloatWriteAttribute result,
+static void do_math_operation_fl3_fl3_to_fl(const ReadAttribute &input_a,
+                                            const ReadAttribute &input_b,
+                                            WriteAttribute &result,
                                             const NodeVectorMathOperation operation)
 {
-  const int size = input_a.size();
-
-  Span<float3> span_a = input_a.get_span();
-  Span<float3> span_b = input_b.get_span();
-  MutableSpan<float> span_result = result.get_span_for_write_only();
-
   bool success = try_dispatch_float_math_fl3_fl3_to_fl(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(size)) {
-          const float3 a = span_a[i];
-          const float3 b = span_b[i];
-          const float out = math_function(a, b);
-          span_result[i] = out;
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SI_SO<float3, float3, float> fn{info.title_case_name, math_function};
+        attribute_call_multi_function(fn, {&input_a, &input_b}, result);
       });
 
-  result.apply_span();
-
   /* The operation is not supported by this node currently. */
   BLI_assert(success);
   UNUSED_VARS_NDEBUG(success);
 }
 
-static void do_math_operation_fl3_fl_to_fl3(const Float3ReadAttribute &input_a,
-                                            const FloatReadAttribute &input_b,
-                                            Float3WriteAttribute result,
+static void do_math_operation_fl3_fl_to_fl3(const ReadAttribute &input_a,
+                                            const ReadAttribute &input_b,
+                                            WriteAttribute &result,
                                             const NodeVectorMathOperation operation)
 {
-  const int size = input_a.size();
-
-  Span<float3> span_a = input_a.get_span();
-  Span<float> span_b = input_b.get_span();
-  MutableSpan<float3> span_result = result.get_span_for_write_only();
-
   bool success = try_dispatch_float_math_fl3_fl_to_fl3(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(size)) {
-          const float3 a = span_a[i];
-          const float b = span_b[i];
-          const float3 out = math_function(a, b);
-          span_result[i] = out;
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SI_SO<float3, float, float3> fn{info.title_case_name, math_function};
+        attribute_call_multi_function(fn, {&input_a, &input_b}, result);
       });
 
-  result.apply_span();
-
   /* The operation is not supported by this node currently. */
   BLI_assert(success);
   UNUSED_VARS_NDEBUG(success);
 }
 
-static void do_math_operation_fl3_to_fl3(const Float3ReadAttribute &input_a,
-                                         Float3WriteAttribute result,
+static void do_math_operation_fl3_to_fl3(const ReadAttribute &input_a,
+                                         WriteAttribute &result,
                                          const NodeVectorMathOperation operation)
 {
-  const int size = input_a.size();
-
-  Span<float3> span_a = input_a.get_span();
-  MutableSpan<float3> span_result = result.get_span_for_write_only();
-
   bool success = try_dispatch_float_math_fl3_to_fl3(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(size)) {
-          const float3 in = span_a[i];
-          const float3 out = math_function(in);
-          span_result[i] = out;
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SO<float3, float3> fn{info.title_case_name, math_function};
+        attribute_call_multi_function(fn, {&input_a}, result);
       });
 
-  result.apply_span();
-
   /* The operation is not supported by this node currently. */
   BLI_assert(success);
   UNUSED_VARS_NDEBUG(success);
 }
 
-static void do_math_operation_fl3_to_fl(const Float3ReadAttribute &input_a,
-                                        FloatWriteAttribute result,
+static void do_math_operation_fl3_to_fl(const ReadAttribute &input_a,
+                                        WriteAttribute &result,
                                         const NodeVectorMathOperation operation)
 {
-  const int size = input_a.size();
-
-  Span<float3> span_a = input_a.get_span();
-  MutableSpan<float> span_result = result.get_span_for_write_only();
-
   bool success = try_dispatch_float_math_fl3_to_fl(
-      operation, [&](auto math_function, const FloatMathOperationInfo &UNUSED(info)) {
-        for (const int i : IndexRange(size)) {
-          const float3 in = span_a[i];
-          const float out = math_function(in);
-          span_result[i] = out;
-        }
+      operation, [&](auto math_function, const FloatMathOperationInfo &info) {
+        fn::CustomMF_SI_SO<float3, float> fn{info.title_case_name, math_function};
+        attribute_call_multi_function(fn, {&input_a}, result);
       });
 
-  result.apply_span();
-
   /* The operation is not supported by this node currently. */
   BLI_assert(success);
   UNUSED_VARS_NDEBUG(success);
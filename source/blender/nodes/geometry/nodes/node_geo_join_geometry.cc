@@ -232,14 +232,15 @@ static void join_components(Span<const PointCloudComponent *> src_components, Ge
 
 static void join_components(Span<const InstancesComponent *> src_components, GeometrySet &result)
 {
+  int tot_instances = 0;
+  for (const InstancesComponent *component : src_components) {
+    tot_instances += component->instances_amount();
+  }
+
   InstancesComponent &dst_component = result.get_component_for_write<InstancesComponent>();
+  dst_component.reserve(tot_instances);
   for (const InstancesComponent *component : src_components) {
-    const int size = component->instances_amount();
-    Span<InstancedData> instanced_data = component->instanced_data();
-    Span<float4x4> transforms = component->transforms();
-    for (const int i : IndexRange(size)) {
-      dst_component.add_instance(instanced_data[i], transforms[i]);
-    }
+    dst_component.add_instances(*component);
   }
 }
 
@@ -87,6 +87,21 @@ static void geo_node_object_info_exec(GeoNodeExecParams params)
           mesh_component.copy_vertex_group_names_from_object(*object);
         }
       }
+      if (object->runtime.geometry_set_eval != nullptr) {
+        /* Pass on the instances generated by the object's modifiers without realizing them. */
+        const InstancesComponent *src_instances =
+            object->runtime.geometry_set_eval->get_component_for_read<InstancesComponent>();
+        if (src_instances != nullptr && !src_instances->is_empty()) {
+          InstancesComponent &instances =
+              geometry_set.get_component_for_write<InstancesComponent>();
+          if (transform_space_relative) {
+            instances.add_instances(*src_instances, transform);
+          }
+          else {
+            instances.add_instances(*src_instances);
+          }
+        }
+      }
       if (object->type == OB_VOLUME) {
         InstancesComponent &instances = geometry_set.get_component_for_write<InstancesComponent>();
 
@@ -14,12 +14,14 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
+
 #include "BLI_float3.hh"
 #include "BLI_hash.h"
-#include "BLI_kdtree.h"
 #include "BLI_math_vector.h"
 #include "BLI_rand.hh"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
 #include "BLI_timeit.hh"
 
 #include "DNA_mesh_types.h"
@@ -78,6 +80,27 @@ static Span<MLoopTri> get_mesh_looptris(const Mesh &mesh)
   return {looptris, looptris_len};
 }
 
+static float looptri_density_factor(const Mesh &mesh,
+                                    const MLoopTri &looptri,
+                                    const FloatReadAttribute *density_factors)
+{
+  if (density_factors == nullptr) {
+    return 1.0f;
+  }
+  const int v0_index = mesh.mloop[looptri.tri[0]].v;
+  const int v1_index = mesh.mloop[looptri.tri[1]].v;
+  const int v2_index = mesh.mloop[looptri.tri[2]].v;
+  const float v0_density_factor = std::max(0.0f, (*density_factors)[v0_index]);
+  const float v1_density_factor = std::max(0.0f, (*density_factors)[v1_index]);
+  const float v2_density_factor = std::max(0.0f, (*density_factors)[v2_index]);
+  return (v0_density_factor + v1_density_factor + v2_density_factor) / 3.0f;
+}
+
+/**
+ * Every triangle has its own random number generator that is seeded with the triangle index.
+ * Therefore the generated points do not depend on the order in which triangles are processed,
+ * which allows sampling them in parallel while keeping the result deterministic.
+ */
 static void sample_mesh_surface(const Mesh &mesh,
                                 const float base_density,
                                 const FloatReadAttribute *density_factors,
@@ -88,86 +111,191 @@ static void sample_mesh_surface(const Mesh &mesh,
 {
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
 
-  for (const int looptri_index : looptris.index_range()) {
-    const MLoopTri &looptri = looptris[looptri_index];
-    const int v0_index = mesh.mloop[looptri.tri[0]].v;
-    const int v1_index = mesh.mloop[looptri.tri[1]].v;
-    const int v2_index = mesh.mloop[looptri.tri[2]].v;
-    const float3 v0_pos = mesh.mvert[v0_index].co;
-    const float3 v1_pos = mesh.mvert[v1_index].co;
-    const float3 v2_pos = mesh.mvert[v2_index].co;
-
-    float looptri_density_factor = 1.0f;
-    if (density_factors != nullptr) {
-      const float v0_density_factor = std::max(0.0f, (*density_factors)[v0_index]);
-      const float v1_density_factor = std::max(0.0f, (*density_factors)[v1_index]);
-      const float v2_density_factor = std::max(0.0f, (*density_factors)[v2_index]);
-      looptri_density_factor = (v0_density_factor + v1_density_factor + v2_density_factor) / 3.0f;
-    }
-    const float area = area_tri_v3(v0_pos, v1_pos, v2_pos);
-
-    const int looptri_seed = BLI_hash_int(looptri_index + seed);
-    RandomNumberGenerator looptri_rng(looptri_seed);
-
-    const float points_amount_fl = area * base_density * looptri_density_factor;
-    const float add_point_probability = fractf(points_amount_fl);
-    const bool add_point = add_point_probability > looptri_rng.get_float();
-    const int point_amount = (int)points_amount_fl + (int)add_point;
-
-    for (int i = 0; i < point_amount; i++) {
-      const float3 bary_coord = looptri_rng.get_barycentric_coordinates();
-      float3 point_pos;
-      interp_v3_v3v3v3(point_pos, v0_pos, v1_pos, v2_pos, bary_coord);
-      r_positions.append(point_pos);
-      r_bary_coords.append(bary_coord);
-      r_looptri_indices.append(looptri_index);
+  /* Count the points of every triangle first, so that each triangle can write its points into
+   * its own part of the output arrays afterwards. */
+  Array<int> point_offsets(looptris.size() + 1);
+  parallel_for(looptris.index_range(), 1024, [&](IndexRange range) {
+    for (const int looptri_index : range) {
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 v0_pos = mesh.mvert[mesh.mloop[looptri.tri[0]].v].co;
+      const float3 v1_pos = mesh.mvert[mesh.mloop[looptri.tri[1]].v].co;
+      const float3 v2_pos = mesh.mvert[mesh.mloop[looptri.tri[2]].v].co;
+      const float area = area_tri_v3(v0_pos, v1_pos, v2_pos);
+
+      const int looptri_seed = BLI_hash_int(looptri_index + seed);
+      RandomNumberGenerator looptri_rng(looptri_seed);
+
+      const float points_amount_fl = area * base_density *
+                                     looptri_density_factor(mesh, looptri, density_factors);
+      const float add_point_probability = fractf(points_amount_fl);
+      const bool add_point = add_point_probability > looptri_rng.get_float();
+      point_offsets[looptri_index] = (int)points_amount_fl + (int)add_point;
     }
+  });
+
+  int tot_points = 0;
+  for (const int looptri_index : looptris.index_range()) {
+    const int point_amount = point_offsets[looptri_index];
+    point_offsets[looptri_index] = tot_points;
+    tot_points += point_amount;
   }
+  point_offsets.last() = tot_points;
+
+  r_positions.resize(tot_points);
+  r_bary_coords.resize(tot_points);
+  r_looptri_indices.resize(tot_points);
+
+  parallel_for(looptris.index_range(), 1024, [&](IndexRange range) {
+    for (const int looptri_index : range) {
+      const IndexRange point_range(point_offsets[looptri_index],
+                                   point_offsets[looptri_index + 1] -
+                                       point_offsets[looptri_index]);
+      if (point_range.size() == 0) {
+        continue;
+      }
+
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 v0_pos = mesh.mvert[mesh.mloop[looptri.tri[0]].v].co;
+      const float3 v1_pos = mesh.mvert[mesh.mloop[looptri.tri[1]].v].co;
+      const float3 v2_pos = mesh.mvert[mesh.mloop[looptri.tri[2]].v].co;
+
+      const int looptri_seed = BLI_hash_int(looptri_index + seed);
+      RandomNumberGenerator looptri_rng(looptri_seed);
+      /* Skip the value that was used to compute the amount of points. */
+      looptri_rng.get_float();
+
+      for (const int i : point_range) {
+        const float3 bary_coord = looptri_rng.get_barycentric_coordinates();
+        interp_v3_v3v3v3(r_positions[i], v0_pos, v1_pos, v2_pos, bary_coord);
+        r_bary_coords[i] = bary_coord;
+        r_looptri_indices[i] = looptri_index;
+      }
+    }
+  });
 }
 
-BLI_NOINLINE static KDTree_3d *build_kdtree(Span<float3> positions)
+/* The cell coordinates of the grid used for Poisson disk elimination are packed into a key. */
+static constexpr int grid_axis_bits = 21;
+static constexpr int grid_axis_max = (1 << grid_axis_bits) - 1;
+
+static uint64_t grid_cell_key(const int x, const int y, const int z)
 {
-  KDTree_3d *kdtree = BLI_kdtree_3d_new(positions.size());
-  for (const int i : positions.index_range()) {
-    BLI_kdtree_3d_insert(kdtree, i, positions[i]);
-  }
-  BLI_kdtree_3d_balance(kdtree);
-  return kdtree;
+  return ((uint64_t)x << (2 * grid_axis_bits)) | ((uint64_t)y << grid_axis_bits) | (uint64_t)z;
+}
+
+static void grid_cell_coords(const uint64_t key, int r_coords[3])
+{
+  r_coords[0] = (int)(key >> (2 * grid_axis_bits));
+  r_coords[1] = (int)((key >> grid_axis_bits) & grid_axis_max);
+  r_coords[2] = (int)(key & grid_axis_max);
 }
 
+struct EliminationGridCell {
+  uint64_t key;
+  /* Range in the points sorted by cell. */
+  IndexRange points;
+};
+
+/**
+ * Eliminate points that are closer than the minimum distance to a point that is kept.
+ *
+ * The points are sorted into a grid whose cells are at least as large as the minimum distance,
+ * so that all close points are in the same or in a neighboring cell. Cells are processed in 27
+ * phases, based on their coordinates modulo three. Cells of the same phase don't share any
+ * neighbors, so they can be processed in parallel. Within a cell, points are processed in index
+ * order, which makes the result independent of the number of threads.
+ */
 BLI_NOINLINE static void update_elimination_mask_for_close_points(
     Span<float3> positions, const float minimum_distance, MutableSpan<bool> elimination_mask)
 {
-  if (minimum_distance <= 0.0f) {
+  if (minimum_distance <= 0.0f || positions.is_empty()) {
     return;
   }
 
-  KDTree_3d *kdtree = build_kdtree(positions);
-
-  for (const int i : positions.index_range()) {
-    if (elimination_mask[i]) {
+  float3 min, max;
+  INIT_MINMAX(min, max);
+  for (const float3 &position : positions) {
+    minmax_v3v3_v3(min, max, position);
+  }
+  const float3 extent = max - min;
+  /* Add a small margin to avoid missing neighbors due to precision issues. Cells are made larger
+   * when necessary for the coordinates to fit into the key. */
+  const float cell_size = std::max(minimum_distance * 1.001f,
+                                   max_fff(extent.x, extent.y, extent.z) / (grid_axis_max - 1));
+
+  Array<std::pair<uint64_t, int>> sorted_points(positions.size());
+  parallel_for(positions.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      int coords[3];
+      for (const int axis : IndexRange(3)) {
+        coords[axis] = std::clamp(
+            (int)((positions[i][axis] - min[axis]) / cell_size), 0, grid_axis_max);
+      }
+      sorted_points[i] = {grid_cell_key(coords[0], coords[1], coords[2]), i};
+    }
+  });
+  std::sort(sorted_points.begin(), sorted_points.end());
+
+  Map<uint64_t, IndexRange> cell_map;
+  Vector<EliminationGridCell> cells_by_phase[27];
+  int cell_start = 0;
+  for (const int i : sorted_points.index_range()) {
+    const uint64_t key = sorted_points[i].first;
+    if (i + 1 < sorted_points.size() && sorted_points[i + 1].first == key) {
       continue;
     }
+    const IndexRange cell_points(cell_start, i + 1 - cell_start);
+    cell_map.add_new(key, cell_points);
+    int coords[3];
+    grid_cell_coords(key, coords);
+    const int phase = (coords[0] % 3) * 9 + (coords[1] % 3) * 3 + coords[2] % 3;
+    cells_by_phase[phase].append({key, cell_points});
+    cell_start = i + 1;
+  }
 
-    struct CallbackData {
-      int index;
-      MutableSpan<bool> elimination_mask;
-    } callback_data = {i, elimination_mask};
-
-    BLI_kdtree_3d_range_search_cb(
-        kdtree,
-        positions[i],
-        minimum_distance,
-        [](void *user_data, int index, const float *UNUSED(co), float UNUSED(dist_sq)) {
-          CallbackData &callback_data = *static_cast<CallbackData *>(user_data);
-          if (index != callback_data.index) {
-            callback_data.elimination_mask[index] = true;
+  const float minimum_distance_sq = minimum_distance * minimum_distance;
+  for (Span<EliminationGridCell> cells : cells_by_phase) {
+    parallel_for(cells.index_range(), 16, [&](IndexRange range) {
+      for (const EliminationGridCell &cell : cells.slice(range)) {
+        int coords[3];
+        grid_cell_coords(cell.key, coords);
+        Vector<IndexRange, 27> neighbor_cells;
+        for (int x = coords[0] - 1; x <= coords[0] + 1; x++) {
+          for (int y = coords[1] - 1; y <= coords[1] + 1; y++) {
+            for (int z = coords[2] - 1; z <= coords[2] + 1; z++) {
+              if (x < 0 || y < 0 || z < 0 || x > grid_axis_max || y > grid_axis_max ||
+                  z > grid_axis_max) {
+                continue;
+              }
+              const IndexRange *neighbor = cell_map.lookup_ptr(grid_cell_key(x, y, z));
+              if (neighbor != nullptr) {
+                neighbor_cells.append(*neighbor);
+              }
+            }
           }
-          return true;
-        },
-        &callback_data);
+        }
+
+        for (const int sorted_index : cell.points) {
+          const int point_index = sorted_points[sorted_index].second;
+          if (elimination_mask[point_index]) {
+            continue;
+          }
+          const float3 &position = positions[point_index];
+          for (const IndexRange neighbor_points : neighbor_cells) {
+            for (const int neighbor_sorted_index : neighbor_points) {
+              const int neighbor_index = sorted_points[neighbor_sorted_index].second;
+              if (neighbor_index == point_index) {
+                continue;
+              }
+              if (len_squared_v3v3(position, positions[neighbor_index]) <= minimum_distance_sq) {
+                elimination_mask[neighbor_index] = true;
+              }
+            }
+          }
+        }
+      }
+    });
   }
-  BLI_kdtree_3d_free(kdtree);
 }
 
 BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
@@ -178,30 +306,33 @@ BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
     MutableSpan<bool> elimination_mask)
 {
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
-  for (const int i : bary_coords.index_range()) {
-    if (elimination_mask[i]) {
-      continue;
-    }
+  parallel_for(bary_coords.index_range(), 2048, [&](IndexRange range) {
+    for (const int i : range) {
+      if (elimination_mask[i]) {
+        continue;
+      }
 
-    const MLoopTri &looptri = looptris[looptri_indices[i]];
-    const float3 bary_coord = bary_coords[i];
+      const MLoopTri &looptri = looptris[looptri_indices[i]];
+      const float3 bary_coord = bary_coords[i];
 
-    const int v0_index = mesh.mloop[looptri.tri[0]].v;
-    const int v1_index = mesh.mloop[looptri.tri[1]].v;
-    const int v2_index = mesh.mloop[looptri.tri[2]].v;
+      const int v0_index = mesh.mloop[looptri.tri[0]].v;
+      const int v1_index = mesh.mloop[looptri.tri[1]].v;
+      const int v2_index = mesh.mloop[looptri.tri[2]].v;
 
-    const float v0_density_factor = std::max(0.0f, density_factors[v0_index]);
-    const float v1_density_factor = std::max(0.0f, density_factors[v1_index]);
-    const float v2_density_factor = std::max(0.0f, density_factors[v2_index]);
+      const float v0_density_factor = std::max(0.0f, density_factors[v0_index]);
+      const float v1_density_factor = std::max(0.0f, density_factors[v1_index]);
+      const float v2_density_factor = std::max(0.0f, density_factors[v2_index]);
 
-    const float probablity = v0_density_factor * bary_coord.x + v1_density_factor * bary_coord.y +
-                             v2_density_factor * bary_coord.z;
+      const float probablity = v0_density_factor * bary_coord.x +
+                               v1_density_factor * bary_coord.y +
+                               v2_density_factor * bary_coord.z;
 
-    const float hash = BLI_hash_int_01(bary_coord.hash());
-    if (hash > probablity) {
-      elimination_mask[i] = true;
+      const float hash = BLI_hash_int_01(bary_coord.hash());
+      if (hash > probablity) {
+        elimination_mask[i] = true;
+      }
     }
-  }
+  });
 }
 
 BLI_NOINLINE static void eliminate_points_based_on_mask(Span<bool> elimination_mask,
@@ -209,13 +340,19 @@ BLI_NOINLINE static void eliminate_points_based_on_mask(Span<bool> elimination_m
                                                         Vector<float3> &bary_coords,
                                                         Vector<int> &looptri_indices)
 {
-  for (int i = positions.size() - 1; i >= 0; i--) {
-    if (elimination_mask[i]) {
-      positions.remove_and_reorder(i);
-      bary_coords.remove_and_reorder(i);
-      looptri_indices.remove_and_reorder(i);
+  /* Keep the order of the remaining points, so that it only depends on the sampling. */
+  int new_size = 0;
+  for (const int i : positions.index_range()) {
+    if (!elimination_mask[i]) {
+      positions[new_size] = positions[i];
+      bary_coords[new_size] = bary_coords[i];
+      looptri_indices[new_size] = looptri_indices[i];
+      new_size++;
     }
   }
+  positions.resize(new_size);
+  bary_coords.resize(new_size);
+  looptri_indices.resize(new_size);
 }
 
 template<typename T>
@@ -228,22 +365,24 @@ BLI_NOINLINE static void interpolate_attribute_point(const Mesh &mesh,
   BLI_assert(data_in.size() == mesh.totvert);
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
 
-  for (const int i : bary_coords.index_range()) {
-    const int looptri_index = looptri_indices[i];
-    const MLoopTri &looptri = looptris[looptri_index];
-    const float3 &bary_coord = bary_coords[i];
+  parallel_for(bary_coords.index_range(), 2048, [&](IndexRange range) {
+    for (const int i : range) {
+      const int looptri_index = looptri_indices[i];
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 &bary_coord = bary_coords[i];
 
-    const int v0_index = mesh.mloop[looptri.tri[0]].v;
-    const int v1_index = mesh.mloop[looptri.tri[1]].v;
-    const int v2_index = mesh.mloop[looptri.tri[2]].v;
+      const int v0_index = mesh.mloop[looptri.tri[0]].v;
+      const int v1_index = mesh.mloop[looptri.tri[1]].v;
+      const int v2_index = mesh.mloop[looptri.tri[2]].v;
 
-    const T &v0 = data_in[v0_index];
-    const T &v1 = data_in[v1_index];
-    const T &v2 = data_in[v2_index];
+      const T &v0 = data_in[v0_index];
+      const T &v1 = data_in[v1_index];
+      const T &v2 = data_in[v2_index];
 
-    const T interpolated_value = attribute_math::mix3(bary_coord, v0, v1, v2);
-    data_out[i] = interpolated_value;
-  }
+      const T interpolated_value = attribute_math::mix3(bary_coord, v0, v1, v2);
+      data_out[i] = interpolated_value;
+    }
+  });
 }
 
 template<typename T>
@@ -256,22 +395,24 @@ BLI_NOINLINE static void interpolate_attribute_corner(const Mesh &mesh,
   BLI_assert(data_in.size() == mesh.totloop);
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
 
-  for (const int i : bary_coords.index_range()) {
-    const int looptri_index = looptri_indices[i];
-    const MLoopTri &looptri = looptris[looptri_index];
-    const float3 &bary_coord = bary_coords[i];
+  parallel_for(bary_coords.index_range(), 2048, [&](IndexRange range) {
+    for (const int i : range) {
+      const int looptri_index = looptri_indices[i];
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 &bary_coord = bary_coords[i];
 
-    const int loop_index_0 = looptri.tri[0];
-    const int loop_index_1 = looptri.tri[1];
-    const int loop_index_2 = looptri.tri[2];
+      const int loop_index_0 = looptri.tri[0];
+      const int loop_index_1 = looptri.tri[1];
+      const int loop_index_2 = looptri.tri[2];
 
-    const T &v0 = data_in[loop_index_0];
-    const T &v1 = data_in[loop_index_1];
-    const T &v2 = data_in[loop_index_2];
+      const T &v0 = data_in[loop_index_0];
+      const T &v1 = data_in[loop_index_1];
+      const T &v2 = data_in[loop_index_2];
 
-    const T interpolated_value = attribute_math::mix3(bary_coord, v0, v1, v2);
-    data_out[i] = interpolated_value;
-  }
+      const T interpolated_value = attribute_math::mix3(bary_coord, v0, v1, v2);
+      data_out[i] = interpolated_value;
+    }
+  });
 }
 
 BLI_NOINLINE static void interpolate_attribute(const Mesh &mesh,
@@ -354,22 +495,24 @@ BLI_NOINLINE static void compute_special_attributes(const Mesh &mesh,
   MutableSpan<float3> rotations = rotation_attribute->get_span_for_write_only<float3>();
 
   Span<MLoopTri> looptris = get_mesh_looptris(mesh);
-  for (const int i : bary_coords.index_range()) {
-    const int looptri_index = looptri_indices[i];
-    const MLoopTri &looptri = looptris[looptri_index];
-    const float3 &bary_coord = bary_coords[i];
-
-    const int v0_index = mesh.mloop[looptri.tri[0]].v;
-    const int v1_index = mesh.mloop[looptri.tri[1]].v;
-    const int v2_index = mesh.mloop[looptri.tri[2]].v;
-    const float3 v0_pos = mesh.mvert[v0_index].co;
-    const float3 v1_pos = mesh.mvert[v1_index].co;
-    const float3 v2_pos = mesh.mvert[v2_index].co;
-
-    ids[i] = (int)(bary_coord.hash()) + looptri_index;
-    normal_tri_v3(normals[i], v0_pos, v1_pos, v2_pos);
-    rotations[i] = normal_to_euler_rotation(normals[i]);
-  }
+  parallel_for(bary_coords.index_range(), 2048, [&](IndexRange range) {
+    for (const int i : range) {
+      const int looptri_index = looptri_indices[i];
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 &bary_coord = bary_coords[i];
+
+      const int v0_index = mesh.mloop[looptri.tri[0]].v;
+      const int v1_index = mesh.mloop[looptri.tri[1]].v;
+      const int v2_index = mesh.mloop[looptri.tri[2]].v;
+      const float3 v0_pos = mesh.mvert[v0_index].co;
+      const float3 v1_pos = mesh.mvert[v1_index].co;
+      const float3 v2_pos = mesh.mvert[v2_index].co;
+
+      ids[i] = (int)(bary_coord.hash()) + looptri_index;
+      normal_tri_v3(normals[i], v0_pos, v1_pos, v2_pos);
+      rotations[i] = normal_to_euler_rotation(normals[i]);
+    }
+  });
 
   id_attribute.apply_span_and_save();
   normal_attribute.apply_span_and_save();
@@ -169,6 +169,7 @@ static void add_instances_from_geometry_component(InstancesComponent &instances,
       "scale", domain, {1, 1, 1});
   Int32ReadAttribute ids = src_geometry.attribute_get_for_read<int>("id", domain, -1);
 
+  instances.reserve(instances.instances_amount() + domain_size);
   for (const int i : IndexRange(domain_size)) {
     if (instances_data[i].has_value()) {
       float transform[4][4];
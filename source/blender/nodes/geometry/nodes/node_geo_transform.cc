@@ -19,6 +19,7 @@
 #endif
 
 #include "BLI_math_matrix.h"
+#include "BLI_task.hh"
 
 #include "DNA_pointcloud_types.h"
 #include "DNA_volume_types.h"
@@ -103,17 +104,21 @@ static void transform_instances(InstancesComponent &instances,
 
   /* Use only translation if rotation and scale don't apply. */
   if (use_translate(rotation, scale)) {
-    for (float4x4 &transform : transforms) {
-      add_v3_v3(transform.ptr()[3], translation);
-    }
+    parallel_for(transforms.index_range(), 4096, [&](IndexRange range) {
+      for (const int i : range) {
+        add_v3_v3(transforms[i].ptr()[3], translation);
+      }
+    });
   }
   else {
     float mat[4][4];
 
     loc_eul_size_to_mat4(mat, translation, rotation, scale);
-    for (float4x4 &transform : transforms) {
-      mul_m4_m4_pre(transform.ptr(), mat);
-    }
+    parallel_for(transforms.index_range(), 4096, [&](IndexRange range) {
+      for (const int i : range) {
+        mul_m4_m4_pre(transforms[i].ptr(), mat);
+      }
+    });
   }
 }
 
@@ -748,6 +748,9 @@ static float color_step;
 static float inv_color_step;
 static float valid_gamma;
 static float valid_inv_gamma;
+/* Inverse gamma of opaque byte colors and their alpha, see #gammacross_byte_pixel. */
+static float inv_gamma_byte_table[256];
+static float inv_gamma_byte_alpha;
 
 static void makeGammaTables(float gamma)
 {
@@ -870,6 +873,13 @@ static void build_gammatabs(void)
   if (gamma_tabs_init == false) {
     gamtabs(2.0f);
     makeGammaTables(2.0f);
+    for (int i = 0; i < 256; i++) {
+      const unsigned char opaque[4] = {i, i, i, 255};
+      float rt[4];
+      straight_uchar_to_premul_float(rt, opaque);
+      inv_gamma_byte_table[i] = invGammaCorrect(rt[0]);
+      inv_gamma_byte_alpha = invGammaCorrect(rt[3]);
+    }
     gamma_tabs_init = true;
   }
 }
@@ -886,6 +896,36 @@ static void free_gammacross(Sequence *UNUSED(seq), const bool UNUSED(do_id_user)
 {
 }
 
+BLI_INLINE void gammacross_byte_pixel(
+    float fac1, float fac2, const unsigned char *cp1, const unsigned char *cp2, unsigned char *rt)
+{
+  float rt1[4], rt2[4], tempc[4];
+
+  if (cp1[3] == 255 && cp2[3] == 255) {
+    /* Opaque colors premultiply to a fixed value per byte, look their inverse gamma up. */
+    for (int c = 0; c < 3; c++) {
+      rt1[c] = inv_gamma_byte_table[cp1[c]];
+      rt2[c] = inv_gamma_byte_table[cp2[c]];
+    }
+    rt1[3] = rt2[3] = inv_gamma_byte_alpha;
+  }
+  else {
+    straight_uchar_to_premul_float(rt1, cp1);
+    straight_uchar_to_premul_float(rt2, cp2);
+    for (int c = 0; c < 4; c++) {
+      rt1[c] = invGammaCorrect(rt1[c]);
+      rt2[c] = invGammaCorrect(rt2[c]);
+    }
+  }
+
+  tempc[0] = gammaCorrect(fac1 * rt1[0] + fac2 * rt2[0]);
+  tempc[1] = gammaCorrect(fac1 * rt1[1] + fac2 * rt2[1]);
+  tempc[2] = gammaCorrect(fac1 * rt1[2] + fac2 * rt2[2]);
+  tempc[3] = gammaCorrect(fac1 * rt1[3] + fac2 * rt2[3]);
+
+  premul_float_to_straight_uchar(rt, tempc);
+}
+
 static void do_gammacross_effect_byte(float facf0,
                                       float UNUSED(facf1),
                                       int x,
@@ -897,7 +937,6 @@ static void do_gammacross_effect_byte(float facf0,
   float fac1, fac2;
   int xo;
   unsigned char *cp1, *cp2, *rt;
-  float rt1[4], rt2[4], tempc[4];
 
   xo = x;
   cp1 = rect1;
@@ -910,15 +949,7 @@ static void do_gammacross_effect_byte(float facf0,
   while (y--) {
     x = xo;
     while (x--) {
-      straight_uchar_to_premul_float(rt1, cp1);
-      straight_uchar_to_premul_float(rt2, cp2);
-
-      tempc[0] = gammaCorrect(fac1 * invGammaCorrect(rt1[0]) + fac2 * invGammaCorrect(rt2[0]));
-      tempc[1] = gammaCorrect(fac1 * invGammaCorrect(rt1[1]) + fac2 * invGammaCorrect(rt2[1]));
-      tempc[2] = gammaCorrect(fac1 * invGammaCorrect(rt1[2]) + fac2 * invGammaCorrect(rt2[2]));
-      tempc[3] = gammaCorrect(fac1 * invGammaCorrect(rt1[3]) + fac2 * invGammaCorrect(rt2[3]));
-
-      premul_float_to_straight_uchar(rt, tempc);
+      gammacross_byte_pixel(fac1, fac2, cp1, cp2, rt);
       cp1 += 4;
       cp2 += 4;
       rt += 4;
@@ -931,15 +962,7 @@ static void do_gammacross_effect_byte(float facf0,
 
     x = xo;
     while (x--) {
-      straight_uchar_to_premul_float(rt1, cp1);
-      straight_uchar_to_premul_float(rt2, cp2);
-
-      tempc[0] = gammaCorrect(fac1 * invGammaCorrect(rt1[0]) + fac2 * invGammaCorrect(rt2[0]));
-      tempc[1] = gammaCorrect(fac1 * invGammaCorrect(rt1[1]) + fac2 * invGammaCorrect(rt2[1]));
-      tempc[2] = gammaCorrect(fac1 * invGammaCorrect(rt1[2]) + fac2 * invGammaCorrect(rt2[2]));
-      tempc[3] = gammaCorrect(fac1 * invGammaCorrect(rt1[3]) + fac2 * invGammaCorrect(rt2[3]));
-
-      premul_float_to_straight_uchar(rt, tempc);
+      gammacross_byte_pixel(fac1, fac2, cp1, cp2, rt);
       cp1 += 4;
       cp2 += 4;
       rt += 4;
@@ -3897,6 +3920,11 @@ static int early_out_text(Sequence *seq, float UNUSED(facf0), float UNUSED(facf1
   return EARLY_NO_INPUT;
 }
 
+/* BLF fonts keep their size, wrap width, position and target buffer as state, and the glyph
+ * cache is not thread-safe. Prefetch workers render frames concurrently, so drawing text into a
+ * buffer has to be serialized. */
+static ThreadMutex text_effect_mutex = BLI_MUTEX_INITIALIZER;
+
 static ImBuf *do_text_effect(const SeqRenderData *context,
                              Sequence *seq,
                              float UNUSED(timeline_frame),
@@ -3917,6 +3945,8 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
   int y_ofs, x, y;
   double proxy_size_comp;
 
+  BLI_mutex_lock(&text_effect_mutex);
+
   if (data->text_blf_id == SEQ_FONT_NOT_LOADED) {
     data->text_blf_id = -1;
 
@@ -4030,6 +4060,8 @@ static ImBuf *do_text_effect(const SeqRenderData *context,
 
   BLF_disable(font, BLF_WORD_WRAP);
 
+  BLI_mutex_unlock(&text_effect_mutex);
+
   return out;
 }
 
@@ -20,10 +20,17 @@
  * \ingroup bke
  */
 
+#include <fcntl.h>
 #include <memory.h>
 #include <stddef.h>
 #include <time.h>
 
+#ifndef WIN32
+#  include <unistd.h>
+#else
+#  include <io.h>
+#endif
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_scene_types.h"
@@ -40,8 +47,11 @@
 #include "BLI_fileops_types.h"
 #include "BLI_ghash.h"
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
 #include "BLI_path_util.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BKE_global.h"
@@ -57,6 +67,14 @@
 #include "prefetch.h"
 #include "strip_time.h"
 
+#ifdef WITH_LZO
+#  ifdef WITH_SYSTEM_LZO
+#    include <lzo/lzo1x.h>
+#  else
+#    include "minilzo.h"
+#  endif
+#endif
+
 /**
  * Sequencer Cache Design Notes
  * ============================
@@ -90,7 +108,12 @@
  * Multiple(DCACHE_IMAGES_PER_FILE) images share the same file.
  * Each of these files contains header DiskCacheHeader followed by image data.
  * Zlib compression with user definable level can be used to compress image data(per image)
+ * Alternatively image data is split into blocks (DCACHE_BLOCK_SIZE) which are stored either raw
+ * or compressed with LZO. Float images have their bytes shuffled into planes before
+ * compression. Blocks are encoded and decoded in parallel and read from memory-mapped files.
  * Images are written in order in which they are rendered.
+ * Writing is done by a dedicated thread, so rendering doesn't wait for IO. Images waiting to be
+ * written are kept in a queue (at most DCACHE_WRITE_QUEUE_MAX) and can be read from there.
  * Overwriting of individual entry is not possible.
  * Stored images are deleted by invalidation, or when size of all files exceeds maximum
  * size specified in user preferences.
@@ -102,11 +125,27 @@
 /* <cache type>-<resolution X>x<resolution Y>-<rendersize>%(<view_id>)-<frame no>.dcf */
 #define DCACHE_FNAME_FORMAT "%d-%dx%d-%d%%(%d)-%d.dcf"
 #define DCACHE_IMAGES_PER_FILE 100
-#define DCACHE_CURRENT_VERSION 1
+#define DCACHE_CURRENT_VERSION 2
 #define COLORSPACE_NAME_MAX 64 /* XXX: defined in imb intern */
+#define DCACHE_BLOCK_SIZE (1 << 20)
+#define DCACHE_BLOCKS_PER_BATCH 16
+#define DCACHE_WRITE_QUEUE_MAX 8
+#define DCACHE_TEMP_EXT ".tmp"
+#define DCACHE_LZO_OUT_LEN(size) ((size) + (size) / 16 + 64 + 3)
+
+/* Codec used to store image data of a header entry. */
+enum {
+  /* Zlib stream. */
+  DCACHE_CODEC_ZLIB = 0,
+  /* Table of block sizes followed by blocks, stored raw or compressed with LZO. */
+  DCACHE_CODEC_BLOCKS = 1,
+  /* Same as #DCACHE_CODEC_BLOCKS, bytes of float values are shuffled into planes per block. */
+  DCACHE_CODEC_BLOCKS_SHUFFLE = 2,
+};
 
 typedef struct DiskCacheHeaderEntry {
   unsigned char encoding;
+  unsigned char codec;
   uint64_t frameno;
   uint64_t size_compressed;
   uint64_t size_raw;
@@ -124,8 +163,31 @@ typedef struct SeqDiskCache {
   ListBase files;
   ThreadMutex read_write_mutex;
   size_t size_total;
+
+  /* Images waiting to be written by the writer thread, see #seq_disk_cache_writer_thread. */
+  ListBase write_queue;
+  int write_queue_len;
+  /* Task taken from the queue by the writer thread, until its file is published. */
+  struct DiskCacheWriteTask *write_task_active;
+  ThreadMutex write_queue_mutex;
+  ThreadCondition write_queue_cond;
+  ListBase writer_thread;
+  bool writer_stop;
+  /* Incremented by invalidation, images written before it are not published. */
+  uint64_t invalidate_generation;
 } SeqDiskCache;
 
+typedef struct DiskCacheWriteTask {
+  struct DiskCacheWriteTask *next, *prev;
+  char path[FILE_MAX];
+  int cache_type;
+  uint64_t frameno;
+  int codec;
+  int compression_level;
+  bool use_lzo;
+  struct ImBuf *ibuf;
+} DiskCacheWriteTask;
+
 typedef struct DiskCacheFile {
   struct DiskCacheFile *next, *prev;
   char path[FILE_MAX];
@@ -186,6 +248,7 @@ static int seq_disk_cache_compression_level(void)
 {
   switch (U.sequencer_disk_cache_compression) {
     case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
       return 0;
     case USER_SEQ_DISK_CACHE_COMPRESSION_LOW:
       return 1;
@@ -442,6 +505,64 @@ static void seq_disk_cache_handle_versioning(SeqDiskCache *disk_cache)
   }
 }
 
+static bool seq_disk_cache_is_in_invalidated_range(Sequence *seq,
+                                                   int start_frame,
+                                                   int range_start,
+                                                   int range_end)
+{
+  int timeline_frame_start = seq_cache_frame_index_to_timeline_frame(seq, start_frame);
+  return timeline_frame_start > range_start && timeline_frame_start <= range_end;
+}
+
+static void seq_disk_cache_write_task_free(DiskCacheWriteTask *task)
+{
+  IMB_freeImBuf(task->ibuf);
+  MEM_freeN(task);
+}
+
+/* Drop queued images, that would be written into files deleted by invalidation. */
+static void seq_disk_cache_delete_invalid_write_tasks(SeqDiskCache *disk_cache,
+                                                      const char *cache_dir,
+                                                      Sequence *seq,
+                                                      int invalidate_types,
+                                                      int range_start,
+                                                      int range_end)
+{
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  DiskCacheWriteTask *next_task, *task = disk_cache->write_queue.first;
+
+  while (task) {
+    next_task = task->next;
+    char dir[FILE_MAXDIR];
+    BLI_split_dir_part(task->path, dir, sizeof(dir));
+    int start_frame = ((int)task->frameno / DCACHE_IMAGES_PER_FILE) * DCACHE_IMAGES_PER_FILE;
+
+    if ((task->cache_type & invalidate_types) && STREQ(cache_dir, dir) &&
+        seq_disk_cache_is_in_invalidated_range(seq, start_frame, range_start, range_end)) {
+      BLI_remlink(&disk_cache->write_queue, task);
+      disk_cache->write_queue_len--;
+      seq_disk_cache_write_task_free(task);
+    }
+    task = next_task;
+  }
+
+  /* The task being written is freed by the writer thread, only stop reading its image. */
+  task = disk_cache->write_task_active;
+  if (task) {
+    char dir[FILE_MAXDIR];
+    BLI_split_dir_part(task->path, dir, sizeof(dir));
+    int start_frame = ((int)task->frameno / DCACHE_IMAGES_PER_FILE) * DCACHE_IMAGES_PER_FILE;
+
+    if ((task->cache_type & invalidate_types) && STREQ(cache_dir, dir) &&
+        seq_disk_cache_is_in_invalidated_range(seq, start_frame, range_start, range_end)) {
+      disk_cache->write_task_active = NULL;
+    }
+  }
+
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+}
+
 static void seq_disk_cache_delete_invalid_files(SeqDiskCache *disk_cache,
                                                 Scene *scene,
                                                 Sequence *seq,
@@ -454,13 +575,15 @@ static void seq_disk_cache_delete_invalid_files(SeqDiskCache *disk_cache,
   seq_disk_cache_get_dir(disk_cache, scene, seq, cache_dir, sizeof(cache_dir));
   BLI_path_slash_ensure(cache_dir);
 
+  seq_disk_cache_delete_invalid_write_tasks(
+      disk_cache, cache_dir, seq, invalidate_types, range_start, range_end);
+
   while (cache_file) {
     next_file = cache_file->next;
     if (cache_file->cache_type & invalidate_types) {
       if (STREQ(cache_dir, cache_file->dir)) {
-        int timeline_frame_start = seq_cache_frame_index_to_timeline_frame(
-            seq, cache_file->start_frame);
-        if (timeline_frame_start > range_start && timeline_frame_start <= range_end) {
+        if (seq_disk_cache_is_in_invalidated_range(
+                seq, cache_file->start_frame, range_start, range_end)) {
           seq_disk_cache_delete_file(disk_cache, cache_file);
         }
       }
@@ -480,6 +603,7 @@ static void seq_disk_cache_invalidate(Scene *scene,
 
   BLI_mutex_lock(&disk_cache->read_write_mutex);
 
+  disk_cache->invalidate_generation++;
   start = seq_changed->startdisp - DCACHE_IMAGES_PER_FILE;
   end = seq_changed->enddisp;
 
@@ -513,16 +637,259 @@ static size_t inflate_file_to_imbuf(ImBuf *ibuf, FILE *file, DiskCacheHeaderEntr
       ibuf->rect_float, header_entry->size_raw, file, header_entry->offset);
 }
 
-static bool seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
+/* Split 4 byte values into byte planes. Exponent and high mantissa bytes of neighboring float
+ * pixels end up next to each other, which makes them compressible. */
+static void seq_disk_cache_shuffle_bytes(const unsigned char *src, unsigned char *dst, size_t size)
 {
-  fseek(file, 0, 0);
-  const size_t num_items_read = fread(header, sizeof(*header), 1, file);
-  if (num_items_read < 1) {
-    BLI_assert(!"unable to read disk cache header");
-    perror("unable to read disk cache header");
+  const size_t num_values = size / 4;
+  for (size_t i = 0; i < num_values; i++) {
+    dst[i] = src[i * 4];
+    dst[num_values + i] = src[i * 4 + 1];
+    dst[num_values * 2 + i] = src[i * 4 + 2];
+    dst[num_values * 3 + i] = src[i * 4 + 3];
+  }
+}
+
+static void seq_disk_cache_unshuffle_bytes(const unsigned char *src,
+                                           unsigned char *dst,
+                                           size_t size)
+{
+  const size_t num_values = size / 4;
+  for (size_t i = 0; i < num_values; i++) {
+    dst[i * 4] = src[i];
+    dst[i * 4 + 1] = src[num_values + i];
+    dst[i * 4 + 2] = src[num_values * 2 + i];
+    dst[i * 4 + 3] = src[num_values * 3 + i];
+  }
+}
+
+static int seq_disk_cache_num_blocks(uint64_t size_raw)
+{
+  return (int)((size_raw + DCACHE_BLOCK_SIZE - 1) / DCACHE_BLOCK_SIZE);
+}
+
+static size_t seq_disk_cache_block_size(uint64_t size_raw, int block)
+{
+  return min_zz(DCACHE_BLOCK_SIZE, size_raw - (uint64_t)block * DCACHE_BLOCK_SIZE);
+}
+
+typedef struct DiskCacheBlockEncodeData {
+  const unsigned char *raw;
+  uint64_t size_raw;
+  bool shuffle;
+  bool use_lzo;
+  int block_start;
+  unsigned char *shuffled[DCACHE_BLOCKS_PER_BATCH];
+  unsigned char *compressed[DCACHE_BLOCKS_PER_BATCH];
+  void *lzo_wrkmem[DCACHE_BLOCKS_PER_BATCH];
+  /* Encoding result, points either into `raw` or to one of the buffers above. */
+  const unsigned char *out[DCACHE_BLOCKS_PER_BATCH];
+  uint32_t out_size[DCACHE_BLOCKS_PER_BATCH];
+} DiskCacheBlockEncodeData;
+
+static void seq_disk_cache_encode_block_fn(void *__restrict userdata,
+                                           const int i,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DiskCacheBlockEncodeData *data = userdata;
+  const int block = data->block_start + i;
+  const size_t size = seq_disk_cache_block_size(data->size_raw, block);
+  const unsigned char *src = data->raw + (size_t)block * DCACHE_BLOCK_SIZE;
+
+  if (data->shuffle) {
+    seq_disk_cache_shuffle_bytes(src, data->shuffled[i], size);
+    src = data->shuffled[i];
+  }
+
+  data->out[i] = src;
+  data->out_size[i] = (uint32_t)size;
+
+#ifdef WITH_LZO
+  if (data->use_lzo) {
+    lzo_uint out_len = 0;
+    int r = lzo1x_1_compress(
+        src, (lzo_uint)size, data->compressed[i], &out_len, data->lzo_wrkmem[i]);
+    /* Blocks which don't get smaller are stored raw, block size tells which is which. */
+    if (r == LZO_E_OK && out_len < size) {
+      data->out[i] = data->compressed[i];
+      data->out_size[i] = (uint32_t)out_len;
+    }
+  }
+#endif
+}
+
+/* Write image data as table of block sizes followed by block data. Returns number of bytes
+ * written or 0 on failure. */
+static size_t seq_disk_cache_write_blocks(const unsigned char *raw,
+                                          FILE *file,
+                                          DiskCacheHeaderEntry *header_entry,
+                                          bool use_lzo)
+{
+  const int num_blocks = seq_disk_cache_num_blocks(header_entry->size_raw);
+  const size_t table_size = sizeof(uint32_t) * (num_blocks + 1);
+  uint32_t *table = MEM_mallocN(table_size, "SeqDiskCache block table");
+  table[0] = (uint32_t)num_blocks;
+
+  DiskCacheBlockEncodeData data = {NULL};
+  data.raw = raw;
+  data.size_raw = header_entry->size_raw;
+  data.shuffle = header_entry->codec == DCACHE_CODEC_BLOCKS_SHUFFLE;
+  data.use_lzo = use_lzo;
+
+  for (int i = 0; i < DCACHE_BLOCKS_PER_BATCH; i++) {
+    if (data.shuffle) {
+      data.shuffled[i] = MEM_mallocN(DCACHE_BLOCK_SIZE, "SeqDiskCache shuffled block");
+    }
+#ifdef WITH_LZO
+    if (data.use_lzo) {
+      data.compressed[i] = MEM_mallocN(DCACHE_LZO_OUT_LEN(DCACHE_BLOCK_SIZE),
+                                       "SeqDiskCache compressed block");
+      data.lzo_wrkmem[i] = MEM_mallocN(LZO1X_MEM_COMPRESS, "SeqDiskCache LZO work memory");
+    }
+#endif
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+
+  size_t bytes_written = table_size;
+  bool ok = fseek(file, header_entry->offset + table_size, SEEK_SET) == 0;
+
+  for (int block_start = 0; ok && block_start < num_blocks;
+       block_start += DCACHE_BLOCKS_PER_BATCH) {
+    const int batch_len = min_ii(DCACHE_BLOCKS_PER_BATCH, num_blocks - block_start);
+    data.block_start = block_start;
+    BLI_task_parallel_range(0, batch_len, &data, seq_disk_cache_encode_block_fn, &settings);
+
+    for (int i = 0; i < batch_len && ok; i++) {
+      ok = fwrite(data.out[i], 1, data.out_size[i], file) == data.out_size[i];
+      table[block_start + i + 1] = data.out_size[i];
+      bytes_written += data.out_size[i];
+    }
+  }
+
+  if (ok) {
+    ok = fseek(file, header_entry->offset, SEEK_SET) == 0 &&
+         fwrite(table, table_size, 1, file) == 1;
+  }
+
+  for (int i = 0; i < DCACHE_BLOCKS_PER_BATCH; i++) {
+    MEM_SAFE_FREE(data.shuffled[i]);
+    MEM_SAFE_FREE(data.compressed[i]);
+    MEM_SAFE_FREE(data.lzo_wrkmem[i]);
+  }
+  MEM_freeN(table);
+
+  return ok ? bytes_written : 0;
+}
+
+typedef struct DiskCacheBlockDecodeData {
+  BLI_mmap_file *mmap_file;
+  const unsigned char *mapped_memory;
+  uint64_t *block_offsets;
+  const uint32_t *block_sizes;
+  unsigned char *dst;
+  uint64_t size_raw;
+  bool shuffle;
+  bool error;
+} DiskCacheBlockDecodeData;
+
+static void seq_disk_cache_decode_block_fn(void *__restrict userdata,
+                                           const int block,
+                                           const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  DiskCacheBlockDecodeData *data = userdata;
+  const size_t size = seq_disk_cache_block_size(data->size_raw, block);
+  const size_t size_stored = data->block_sizes[block];
+  unsigned char *dst = data->dst + (size_t)block * DCACHE_BLOCK_SIZE;
+  unsigned char *decoded = data->shuffle ? MEM_mallocN(size, "SeqDiskCache shuffled block") :
+                                           dst;
+  bool ok = false;
+
+  if (size_stored == size) {
+    ok = BLI_mmap_read(data->mmap_file, decoded, data->block_offsets[block], size);
+  }
+  else {
+#ifdef WITH_LZO
+    /* Decode straight from the mapping, IO errors are checked once all blocks are decoded. */
+    lzo_uint out_len = (lzo_uint)size;
+    int r = lzo1x_decompress_safe(data->mapped_memory + data->block_offsets[block],
+                                  (lzo_uint)size_stored,
+                                  decoded,
+                                  &out_len,
+                                  NULL);
+    ok = (r == LZO_E_OK && out_len == size);
+#endif
+  }
+
+  if (data->shuffle) {
+    if (ok) {
+      seq_disk_cache_unshuffle_bytes(decoded, dst, size);
+    }
+    MEM_freeN(decoded);
+  }
+
+  if (!ok) {
+    data->error = true;
+  }
+}
+
+static bool seq_disk_cache_read_blocks(BLI_mmap_file *mmap_file,
+                                       const DiskCacheHeaderEntry *header_entry,
+                                       bool switch_endian,
+                                       unsigned char *dst)
+{
+  const int num_blocks = seq_disk_cache_num_blocks(header_entry->size_raw);
+  const size_t table_size = sizeof(uint32_t) * (num_blocks + 1);
+  if (table_size > header_entry->size_compressed) {
     return false;
   }
 
+  uint32_t *table = MEM_mallocN(table_size, "SeqDiskCache block table");
+  uint64_t *block_offsets = MEM_mallocN(sizeof(uint64_t) * num_blocks, "SeqDiskCache offsets");
+  bool ok = BLI_mmap_read(mmap_file, table, header_entry->offset, table_size);
+
+  if (ok && switch_endian) {
+    BLI_endian_switch_uint32_array(table, num_blocks + 1);
+  }
+  ok = ok && table[0] == (uint32_t)num_blocks;
+
+  /* Locate blocks and make sure they are within data of this entry. */
+  uint64_t offset = header_entry->offset + table_size;
+  const uint64_t offset_end = header_entry->offset + header_entry->size_compressed;
+  for (int block = 0; ok && block < num_blocks; block++) {
+    block_offsets[block] = offset;
+    offset += table[block + 1];
+    ok = offset <= offset_end &&
+         table[block + 1] <= seq_disk_cache_block_size(header_entry->size_raw, block);
+  }
+
+  if (ok) {
+    DiskCacheBlockDecodeData data = {NULL};
+    data.mmap_file = mmap_file;
+    data.mapped_memory = BLI_mmap_get_pointer(mmap_file);
+    data.block_offsets = block_offsets;
+    data.block_sizes = table + 1;
+    data.dst = dst;
+    data.size_raw = header_entry->size_raw;
+    data.shuffle = header_entry->codec == DCACHE_CODEC_BLOCKS_SHUFFLE;
+
+    TaskParallelSettings settings;
+    BLI_parallel_range_settings_defaults(&settings);
+    BLI_task_parallel_range(0, num_blocks, &data, seq_disk_cache_decode_block_fn, &settings);
+
+    /* Reading through #BLI_mmap_read() reports IO errors, that occurred while decoding. */
+    unsigned char test;
+    ok = !data.error && BLI_mmap_read(mmap_file, &test, header_entry->offset, 1);
+  }
+
+  MEM_freeN(table);
+  MEM_freeN(block_offsets);
+  return ok;
+}
+
+static void seq_disk_cache_header_endian_switch(DiskCacheHeader *header)
+{
   for (int i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
     if ((ENDIAN_ORDER == B_ENDIAN) && header->entry[i].encoding == 0) {
       BLI_endian_switch_uint64(&header->entry[i].frameno);
@@ -531,6 +898,19 @@ static bool seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
       BLI_endian_switch_uint64(&header->entry[i].size_raw);
     }
   }
+}
+
+static bool seq_disk_cache_read_header(FILE *file, DiskCacheHeader *header)
+{
+  fseek(file, 0, 0);
+  const size_t num_items_read = fread(header, sizeof(*header), 1, file);
+  if (num_items_read < 1) {
+    BLI_assert(!"unable to read disk cache header");
+    perror("unable to read disk cache header");
+    return false;
+  }
+
+  seq_disk_cache_header_endian_switch(header);
 
   return true;
 }
@@ -541,10 +921,11 @@ static size_t seq_disk_cache_write_header(FILE *file, DiskCacheHeader *header)
   return fwrite(header, sizeof(*header), 1, file);
 }
 
-static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCacheHeader *header)
+static int seq_disk_cache_add_header_entry(DiskCacheWriteTask *task, DiskCacheHeader *header)
 {
   int i;
   uint64_t offset = sizeof(*header);
+  ImBuf *ibuf = task->ibuf;
 
   /* Lookup free entry, get offset for new data. */
   for (i = 0; i < DCACHE_IMAGES_PER_FILE; i++) {
@@ -573,8 +954,9 @@ static int seq_disk_cache_add_header_entry(SeqCacheKey *key, ImBuf *ibuf, DiskCa
     header->entry[i].encoding = 0;
   }
 
+  header->entry[i].codec = task->codec;
   header->entry[i].offset = offset;
-  header->entry[i].frameno = key->frame_index;
+  header->entry[i].frameno = task->frameno;
 
   /* Store colorspace name of ibuf. */
   const char *colorspace_name;
@@ -603,50 +985,119 @@ static int seq_disk_cache_get_header_entry(SeqCacheKey *key, DiskCacheHeader *he
   return -1;
 }
 
-static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache, SeqCacheKey *key, ImBuf *ibuf)
+/* Replace the cache file with the written copy, unless the cache has been invalidated since the
+ * image was taken from the write queue. */
+static bool seq_disk_cache_publish_file(SeqDiskCache *disk_cache,
+                                        char *path,
+                                        const char *path_temp,
+                                        const uint64_t generation)
 {
-  char path[FILE_MAX];
+  bool published = false;
 
-  seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
-  BLI_make_existing_file(path);
+  BLI_mutex_lock(&disk_cache->read_write_mutex);
+  if (generation == disk_cache->invalidate_generation && BLI_rename(path_temp, path) == 0) {
+    if (seq_disk_cache_get_file_entry_by_path(disk_cache, path) == NULL) {
+      seq_disk_cache_add_file_to_list(disk_cache, path);
+    }
+    seq_disk_cache_update_file(disk_cache, path);
+    published = true;
+  }
+  BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+  if (!published) {
+    BLI_delete(path_temp, false, false);
+  }
+  return published;
+}
+
+/* The image is added to a copy of the cache file, which replaces the cache file when complete.
+ * Readers only ever see complete files, so compression and IO don't need the read/write lock. */
+static bool seq_disk_cache_write_file(SeqDiskCache *disk_cache,
+                                      DiskCacheWriteTask *task,
+                                      const uint64_t generation)
+{
+  char *path = task->path;
+  char path_temp[FILE_MAX];
+  ImBuf *ibuf = task->ibuf;
+
+  BLI_snprintf(path_temp, sizeof(path_temp), "%s" DCACHE_TEMP_EXT, path);
+  BLI_make_existing_file(path_temp);
 
-  FILE *file = BLI_fopen(path, "rb+");
+  FILE *file = NULL;
+  if (BLI_exists(path) && BLI_copy(path, path_temp) == 0) {
+    file = BLI_fopen(path_temp, "rb+");
+  }
   if (!file) {
-    file = BLI_fopen(path, "wb+");
+    file = BLI_fopen(path_temp, "wb+");
     if (!file) {
       return false;
     }
-    seq_disk_cache_add_file_to_list(disk_cache, path);
   }
 
-  DiskCacheFile *cache_file = seq_disk_cache_get_file_entry_by_path(disk_cache, path);
   DiskCacheHeader header;
   memset(&header, 0, sizeof(header));
+  fseek(file, 0, SEEK_END);
   /* #BLI_make_existing_file() above may create an empty file. This is fine, don't attempt reading
    * the header in that case. */
-  if (cache_file->fstat.st_size != 0 && !seq_disk_cache_read_header(file, &header)) {
+  if (ftell(file) != 0 && !seq_disk_cache_read_header(file, &header)) {
     fclose(file);
-    seq_disk_cache_delete_file(disk_cache, cache_file);
+    BLI_delete(path_temp, false, false);
     return false;
   }
-  int entry_index = seq_disk_cache_add_header_entry(key, ibuf, &header);
+  int entry_index = seq_disk_cache_add_header_entry(task, &header);
 
-  size_t bytes_written = deflate_imbuf_to_file(
-      ibuf, file, seq_disk_cache_compression_level(), &header.entry[entry_index]);
+  size_t bytes_written;
+  if (task->codec == DCACHE_CODEC_ZLIB) {
+    bytes_written = deflate_imbuf_to_file(
+        ibuf, file, task->compression_level, &header.entry[entry_index]);
+  }
+  else {
+    const void *raw = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+    bytes_written = seq_disk_cache_write_blocks(
+        raw, file, &header.entry[entry_index], task->use_lzo);
+  }
 
-  if (bytes_written != 0) {
-    /* Last step is writing header, as image data can be overwritten,
-     * but missing data would cause problems.
-     */
-    header.entry[entry_index].size_compressed = bytes_written;
-    seq_disk_cache_write_header(file, &header);
-    seq_disk_cache_update_file(disk_cache, path);
+  if (bytes_written == 0) {
     fclose(file);
+    BLI_delete(path_temp, false, false);
+    return false;
+  }
 
-    return true;
+  /* Last step is writing header, as image data can be overwritten,
+   * but missing data would cause problems.
+   */
+  header.entry[entry_index].size_compressed = bytes_written;
+  seq_disk_cache_write_header(file, &header);
+  fclose(file);
+
+  return seq_disk_cache_publish_file(disk_cache, path, path_temp, generation);
+}
+
+/* Image which is queued for writing, but not written yet. */
+static ImBuf *seq_disk_cache_get_queued_image(SeqDiskCache *disk_cache,
+                                              const char *path,
+                                              uint64_t frameno)
+{
+  ImBuf *ibuf = NULL;
+
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  DiskCacheWriteTask *active_task = disk_cache->write_task_active;
+  if (active_task && active_task->frameno == frameno && STREQ(active_task->path, path)) {
+    ibuf = active_task->ibuf;
+    IMB_refImBuf(ibuf);
   }
+  LISTBASE_FOREACH (DiskCacheWriteTask *, task, &disk_cache->write_queue) {
+    if (ibuf) {
+      break;
+    }
+    if (task->frameno == frameno && STREQ(task->path, path)) {
+      ibuf = task->ibuf;
+      IMB_refImBuf(ibuf);
+    }
+  }
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
 
-  return false;
+  return ibuf;
 }
 
 static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *key)
@@ -655,64 +1106,204 @@ static ImBuf *seq_disk_cache_read_file(SeqDiskCache *disk_cache, SeqCacheKey *ke
   DiskCacheHeader header;
 
   seq_disk_cache_get_file_path(disk_cache, key, path, sizeof(path));
+
+  ImBuf *queued_ibuf = seq_disk_cache_get_queued_image(disk_cache, path, key->frame_index);
+  if (queued_ibuf) {
+    return queued_ibuf;
+  }
+
   BLI_make_existing_file(path);
 
-  FILE *file = BLI_fopen(path, "rb");
-  if (!file) {
+  int fd = BLI_open(path, O_BINARY | O_RDONLY, 0);
+  if (fd == -1) {
     return NULL;
   }
 
-  if (!seq_disk_cache_read_header(file, &header)) {
-    fclose(file);
+  IMB_mmap_lock();
+  BLI_mmap_file *mmap_file = BLI_mmap_open(fd);
+  IMB_mmap_unlock();
+
+  if (mmap_file == NULL) {
+    close(fd);
     return NULL;
   }
-  int entry_index = seq_disk_cache_get_header_entry(key, &header);
 
-  /* Item not found. */
-  if (entry_index < 0) {
-    fclose(file);
-    return NULL;
+  int entry_index = -1;
+  if (BLI_mmap_read(mmap_file, &header, 0, sizeof(header))) {
+    seq_disk_cache_header_endian_switch(&header);
+    entry_index = seq_disk_cache_get_header_entry(key, &header);
   }
 
-  ImBuf *ibuf;
+  ImBuf *ibuf = NULL;
   uint64_t size_char = (uint64_t)key->context.rectx * key->context.recty * 4;
   uint64_t size_float = (uint64_t)key->context.rectx * key->context.recty * 16;
-  size_t expected_size;
+  size_t expected_size = 0;
 
-  if (header.entry[entry_index].size_raw == size_char) {
-    expected_size = size_char;
-    ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
-    IMB_colormanagement_assign_rect_colorspace(ibuf, header.entry[entry_index].colorspace_name);
-  }
-  else if (header.entry[entry_index].size_raw == size_float) {
-    expected_size = size_float;
-    ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
-    IMB_colormanagement_assign_float_colorspace(ibuf, header.entry[entry_index].colorspace_name);
+  /* Item not found if entry_index < 0. */
+  if (entry_index >= 0) {
+    DiskCacheHeaderEntry *header_entry = &header.entry[entry_index];
+
+    if (header_entry->size_raw == size_char) {
+      expected_size = size_char;
+      ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rect);
+      IMB_colormanagement_assign_rect_colorspace(ibuf, header_entry->colorspace_name);
+    }
+    else if (header_entry->size_raw == size_float) {
+      expected_size = size_float;
+      ibuf = IMB_allocImBuf(key->context.rectx, key->context.recty, 32, IB_rectfloat);
+      IMB_colormanagement_assign_float_colorspace(ibuf, header_entry->colorspace_name);
+    }
   }
-  else {
-    fclose(file);
-    return NULL;
+
+  if (ibuf) {
+    DiskCacheHeaderEntry *header_entry = &header.entry[entry_index];
+    bool ok = false;
+
+    if (header_entry->codec == DCACHE_CODEC_ZLIB) {
+      FILE *file = BLI_fopen(path, "rb");
+      if (file) {
+        size_t bytes_read = inflate_file_to_imbuf(ibuf, file, header_entry);
+        /* Sanity check. */
+        ok = (bytes_read == expected_size);
+        fclose(file);
+      }
+    }
+    else if (ELEM(header_entry->codec, DCACHE_CODEC_BLOCKS, DCACHE_CODEC_BLOCKS_SHUFFLE)) {
+      void *dst = ibuf->rect ? (void *)ibuf->rect : (void *)ibuf->rect_float;
+      const bool switch_endian = (ENDIAN_ORDER == B_ENDIAN) && header_entry->encoding == 0;
+      ok = seq_disk_cache_read_blocks(mmap_file, header_entry, switch_endian, dst);
+    }
+
+    if (!ok) {
+      IMB_freeImBuf(ibuf);
+      ibuf = NULL;
+    }
   }
 
-  size_t bytes_read = inflate_file_to_imbuf(ibuf, file, &header.entry[entry_index]);
+  IMB_mmap_lock();
+  BLI_mmap_free(mmap_file);
+  IMB_mmap_unlock();
+  close(fd);
 
-  /* Sanity check. */
-  if (bytes_read != expected_size) {
-    fclose(file);
-    IMB_freeImBuf(ibuf);
-    return NULL;
+  if (ibuf) {
+    BLI_file_touch(path);
+    seq_disk_cache_update_file(disk_cache, path);
   }
-  BLI_file_touch(path);
-  seq_disk_cache_update_file(disk_cache, path);
-  fclose(file);
 
   return ibuf;
 }
 
+static void *seq_disk_cache_writer_thread(void *data)
+{
+  SeqDiskCache *disk_cache = data;
+
+  while (true) {
+    BLI_mutex_lock(&disk_cache->write_queue_mutex);
+    while (BLI_listbase_is_empty(&disk_cache->write_queue) && !disk_cache->writer_stop) {
+      BLI_condition_wait(&disk_cache->write_queue_cond, &disk_cache->write_queue_mutex);
+    }
+    /* Queue is always flushed before stopping. */
+    const bool is_done = BLI_listbase_is_empty(&disk_cache->write_queue);
+    BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+
+    if (is_done) {
+      break;
+    }
+
+    /* Take task from the queue while holding read/write lock, so the image is either removed from
+     * the queue by invalidation, or written with the generation that invalidation increments. */
+    BLI_mutex_lock(&disk_cache->read_write_mutex);
+    BLI_mutex_lock(&disk_cache->write_queue_mutex);
+    DiskCacheWriteTask *task = BLI_pophead(&disk_cache->write_queue);
+    if (task) {
+      disk_cache->write_queue_len--;
+    }
+    disk_cache->write_task_active = task;
+    const uint64_t generation = disk_cache->invalidate_generation;
+    BLI_condition_notify_all(&disk_cache->write_queue_cond);
+    BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+    BLI_mutex_unlock(&disk_cache->read_write_mutex);
+
+    if (task) {
+      seq_disk_cache_write_file(disk_cache, task, generation);
+      BLI_mutex_lock(&disk_cache->write_queue_mutex);
+      disk_cache->write_task_active = NULL;
+      BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+      seq_disk_cache_write_task_free(task);
+      seq_disk_cache_enforce_limits(disk_cache);
+    }
+  }
+
+  return NULL;
+}
+
+static void seq_disk_cache_writer_start(SeqDiskCache *disk_cache)
+{
+  BLI_mutex_init(&disk_cache->write_queue_mutex);
+  BLI_condition_init(&disk_cache->write_queue_cond);
+  BLI_threadpool_init(&disk_cache->writer_thread, seq_disk_cache_writer_thread, 1);
+  BLI_threadpool_insert(&disk_cache->writer_thread, disk_cache);
+}
+
+/* Write all queued images and stop the writer thread. */
+static void seq_disk_cache_writer_stop(SeqDiskCache *disk_cache)
+{
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  disk_cache->writer_stop = true;
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+
+  BLI_threadpool_end(&disk_cache->writer_thread);
+  BLI_condition_end(&disk_cache->write_queue_cond);
+  BLI_mutex_end(&disk_cache->write_queue_mutex);
+}
+
+/* Queue image to be written by the writer thread. Waits if the queue is full. */
+static void seq_disk_cache_write_file_async(SeqDiskCache *disk_cache,
+                                            SeqCacheKey *key,
+                                            ImBuf *ibuf)
+{
+  DiskCacheWriteTask *task = MEM_callocN(sizeof(DiskCacheWriteTask), "DiskCacheWriteTask");
+  seq_disk_cache_get_file_path(disk_cache, key, task->path, sizeof(task->path));
+  task->cache_type = key->type;
+  task->frameno = key->frame_index;
+  task->compression_level = seq_disk_cache_compression_level();
+
+  switch (U.sequencer_disk_cache_compression) {
+    case USER_SEQ_DISK_CACHE_COMPRESSION_NONE:
+      task->codec = DCACHE_CODEC_BLOCKS;
+      break;
+    case USER_SEQ_DISK_CACHE_COMPRESSION_FAST:
+      task->codec = ibuf->rect ? DCACHE_CODEC_BLOCKS : DCACHE_CODEC_BLOCKS_SHUFFLE;
+      task->use_lzo = true;
+      break;
+    default:
+      task->codec = DCACHE_CODEC_ZLIB;
+      break;
+  }
+
+  IMB_refImBuf(ibuf);
+  task->ibuf = ibuf;
+
+  BLI_mutex_lock(&disk_cache->write_queue_mutex);
+  while (disk_cache->write_queue_len >= DCACHE_WRITE_QUEUE_MAX) {
+    BLI_condition_wait(&disk_cache->write_queue_cond, &disk_cache->write_queue_mutex);
+  }
+  BLI_addtail(&disk_cache->write_queue, task);
+  disk_cache->write_queue_len++;
+  BLI_condition_notify_all(&disk_cache->write_queue_cond);
+  BLI_mutex_unlock(&disk_cache->write_queue_mutex);
+}
+
 #undef DCACHE_FNAME_FORMAT
 #undef DCACHE_IMAGES_PER_FILE
 #undef COLORSPACE_NAME_MAX
 #undef DCACHE_CURRENT_VERSION
+#undef DCACHE_BLOCK_SIZE
+#undef DCACHE_BLOCKS_PER_BATCH
+#undef DCACHE_WRITE_QUEUE_MAX
+#undef DCACHE_TEMP_EXT
+#undef DCACHE_LZO_OUT_LEN
 
 static bool seq_cmp_render_data(const SeqRenderData *a, const SeqRenderData *b)
 {
@@ -1101,20 +1692,19 @@ static void seq_disk_cache_create(Main *bmain, Scene *scene)
   BLI_mutex_lock(&cache_create_lock);
   SeqCache *cache = seq_cache_get_from_scene(scene);
 
-  if (cache == NULL) {
-    return;
-  }
-
-  if (cache->disk_cache != NULL) {
+  if (cache == NULL || cache->disk_cache != NULL) {
+    BLI_mutex_unlock(&cache_create_lock);
     return;
   }
 
-  cache->disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
-  cache->disk_cache->bmain = bmain;
-  BLI_mutex_init(&cache->disk_cache->read_write_mutex);
-  seq_disk_cache_handle_versioning(cache->disk_cache);
-  seq_disk_cache_get_files(cache->disk_cache, seq_disk_cache_base_dir());
-  cache->disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+  SeqDiskCache *disk_cache = MEM_callocN(sizeof(SeqDiskCache), "SeqDiskCache");
+  disk_cache->bmain = bmain;
+  BLI_mutex_init(&disk_cache->read_write_mutex);
+  seq_disk_cache_handle_versioning(disk_cache);
+  seq_disk_cache_get_files(disk_cache, seq_disk_cache_base_dir());
+  disk_cache->timestamp = scene->ed->disk_cache_timestamp;
+  seq_disk_cache_writer_start(disk_cache);
+  cache->disk_cache = disk_cache;
   BLI_mutex_unlock(&cache_create_lock);
 }
 
@@ -1210,6 +1800,7 @@ void seq_cache_destruct(Scene *scene)
   BLI_mutex_end(&cache->iterator_mutex);
 
   if (cache->disk_cache != NULL) {
+    seq_disk_cache_writer_stop(cache->disk_cache);
     BLI_freelistN(&cache->disk_cache->files);
     BLI_mutex_end(&cache->disk_cache->read_write_mutex);
     MEM_freeN(cache->disk_cache);
@@ -1442,10 +2033,7 @@ void seq_cache_put(
         seq_disk_cache_create(context->bmain, context->scene);
       }
 
-      BLI_mutex_lock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_write_file(cache->disk_cache, key, i);
-      BLI_mutex_unlock(&cache->disk_cache->read_write_mutex);
-      seq_disk_cache_enforce_limits(cache->disk_cache);
+      seq_disk_cache_write_file_async(cache->disk_cache, key, i);
     }
   }
 }
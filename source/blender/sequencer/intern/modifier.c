@@ -296,13 +296,24 @@ static void color_balance_byte_byte(StripColorBalance *cb_,
                                     int height,
                                     float mul)
 {
-  // unsigned char cb_tab[3][256];
   unsigned char *cp = rect;
   unsigned char *e = cp + width * 4 * height;
   unsigned char *m = mask_rect;
 
   StripColorBalance cb = calc_cb(cb_);
 
+  /* Opaque pixels only take 256 values per channel, look their results up instead of
+   * evaluating the power function for every pixel. */
+  float cb_tab[3][256];
+  for (int i = 0; i < 256; i++) {
+    const unsigned char opaque[4] = {i, i, i, 255};
+    float p[4];
+    straight_uchar_to_premul_float(p, opaque);
+    for (int c = 0; c < 3; c++) {
+      cb_tab[c][i] = color_balance_fl(p[c], cb.lift[c], cb.gain[c], cb.gamma[c], mul);
+    }
+  }
+
   while (cp < e) {
     float p[4];
     int c;
@@ -310,7 +321,9 @@ static void color_balance_byte_byte(StripColorBalance *cb_,
     straight_uchar_to_premul_float(p, cp);
 
     for (c = 0; c < 3; c++) {
-      float t = color_balance_fl(p[c], cb.lift[c], cb.gain[c], cb.gamma[c], mul);
+      float t = (cp[3] == 255) ?
+                    cb_tab[c][cp[c]] :
+                    color_balance_fl(p[c], cb.lift[c], cb.gain[c], cb.gamma[c], mul);
 
       if (m) {
         float m_normal = (float)m[c] / 255.0f;
@@ -34,6 +34,8 @@
 #include "DNA_windowmanager_types.h"
 
 #include "BLI_listbase.h"
+#include "BLI_math_base.h"
+#include "BLI_system.h"
 #include "BLI_threads.h"
 
 #include "IMB_imbuf.h"
@@ -61,34 +63,82 @@
 #include "prefetch.h"
 #include "render.h"
 
+/* Upper limit of frames rendered at the same time. Every worker holds its own evaluated copy of
+ * the scene, so this is bounded more by memory than by the number of cores. */
+#define SEQ_PREFETCH_MAX_WORKERS 8
+
+/* Every worker opens the movie files of its scene copy, each with its own decoder threads and
+ * decoded frame cache. The number of workers is reduced so that movie strips are not opened more
+ * often than this in total. */
+#define SEQ_PREFETCH_MAX_MOVIE_ANIMS 16
+
+/* Workers are limited to the part of the unused system memory they may take together, estimated
+ * from the images of the strips of a frame. */
+#define SEQ_PREFETCH_MEMORY_FRACTION 4
+
+struct PrefetchJob;
+
+/* Renders one frame at a time, with its own depsgraph, so that multiple frames can be rendered
+ * concurrently. The depsgraph is built by the worker thread when it gets its first frame. */
+typedef struct PrefetchWorker {
+  struct PrefetchJob *pfjob;
+
+  struct Main *bmain_eval;
+  struct Scene *scene_eval;
+  struct Depsgraph *depsgraph;
+
+  /* context */
+  struct SeqRenderData context;
+  struct SeqRenderData context_cpy;
+
+  /* Frame being rendered, only valid while `rendering` is set. */
+  float cfra;
+  bool rendering;
+} PrefetchWorker;
+
 typedef struct PrefetchJob {
   struct PrefetchJob *next, *prev;
 
   struct Main *bmain;
-  struct Main *bmain_eval;
   struct Scene *scene;
-  struct Scene *scene_eval;
-  struct Depsgraph *depsgraph;
 
+  /* Render size of the context that started the job, used for the worker contexts. */
+  SeqRenderData context;
+
+  /* Protects the prefetch area and control members below. */
   ThreadMutex prefetch_suspend_mutex;
   ThreadCondition prefetch_suspend_cond;
+  /* Workers build their depsgraphs from the original scene one at a time. */
+  ThreadMutex depsgraph_build_mutex;
 
   ListBase threads;
 
-  /* context */
-  struct SeqRenderData context;
-  struct SeqRenderData context_cpy;
-  struct ListBase *seqbasep;
-  struct ListBase *seqbasep_cpy;
+  PrefetchWorker *workers;
+  /* Workers used by the current run, the first `num_workers` of `num_workers_alloc`. */
+  int num_workers;
+  int num_workers_alloc;
 
   /* prefetch area */
   float cfra;
+  /* Frames are handed out to workers in order, but may finish out of order. Frames before
+   * `cfra + num_frames_prefetched` are all done, frames before `cfra + num_frames_dispatched`
+   * are done or being rendered. */
   int num_frames_prefetched;
+  int num_frames_dispatched;
 
   /* control */
+  int num_workers_running;
+  int num_workers_waiting;
   bool running;
   bool waiting;
   bool stop;
+
+  /* Range of dispatched frames, read by the cache while it is locked. Workers lock the cache
+   * while holding `prefetch_suspend_mutex`, so the cache can not take that mutex, this copy is
+   * protected by its own lock instead. */
+  SpinLock time_range_lock;
+  int time_range_start;
+  int time_range_end;
 } PrefetchJob;
 
 static bool seq_prefetch_is_playing(Main *bmain)
@@ -172,7 +222,14 @@ SeqRenderData *seq_prefetch_get_original_context(const SeqRenderData *context)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(context->scene);
 
-  return &pfjob->context;
+  /* Each worker renders its own copy of the scene, the task ID tells which one. Other workers may
+   * be building their depsgraph, so their scene copies can't be compared. */
+  const int worker_index = context->task_id - SEQ_TASK_PREFETCH_RENDER;
+  if (worker_index >= 0 && worker_index < pfjob->num_workers) {
+    return &pfjob->workers[worker_index].context;
+  }
+
+  return &pfjob->workers[0].context;
 }
 
 static bool seq_prefetch_is_cache_full(Scene *scene)
@@ -186,56 +243,91 @@ static bool seq_prefetch_is_cache_full(Scene *scene)
   return seq_cache_recycle_item(pfjob->scene) == false;
 }
 
+/* Next frame to be handed out to a worker. */
 static float seq_prefetch_cfra(PrefetchJob *pfjob)
 {
-  return pfjob->cfra + pfjob->num_frames_prefetched;
+  return pfjob->cfra + pfjob->num_frames_dispatched;
 }
-static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchJob *pfjob)
+
+static AnimationEvalContext seq_prefetch_anim_eval_context(PrefetchWorker *worker)
 {
-  return BKE_animsys_eval_context_construct(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  return BKE_animsys_eval_context_construct(worker->depsgraph, worker->cfra);
+}
+
+/* Must be called with the job locked, whenever the dispatched range changes. */
+static void seq_prefetch_update_time_range(PrefetchJob *pfjob)
+{
+  BLI_spin_lock(&pfjob->time_range_lock);
+  pfjob->time_range_start = pfjob->cfra;
+  pfjob->time_range_end = seq_prefetch_cfra(pfjob);
+  BLI_spin_unlock(&pfjob->time_range_lock);
 }
 
 void seq_prefetch_get_time_range(Scene *scene, int *start, int *end)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  *start = pfjob->cfra;
-  *end = seq_prefetch_cfra(pfjob);
+  /* Include frames that are still being rendered, so they are not recycled as soon as they
+   * are done. */
+  BLI_spin_lock(&pfjob->time_range_lock);
+  *start = pfjob->time_range_start;
+  *end = pfjob->time_range_end;
+  BLI_spin_unlock(&pfjob->time_range_lock);
 }
 
-static void seq_prefetch_free_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_free_depsgraph(PrefetchWorker *worker)
 {
-  if (pfjob->depsgraph != NULL) {
-    DEG_graph_free(pfjob->depsgraph);
+  if (worker->depsgraph != NULL) {
+    DEG_graph_free(worker->depsgraph);
   }
-  pfjob->depsgraph = NULL;
-  pfjob->scene_eval = NULL;
+  worker->depsgraph = NULL;
+  worker->scene_eval = NULL;
 }
 
-static void seq_prefetch_update_depsgraph(PrefetchJob *pfjob)
+static void seq_prefetch_update_depsgraph(PrefetchWorker *worker)
 {
-  DEG_evaluate_on_framechange(pfjob->depsgraph, seq_prefetch_cfra(pfjob));
+  DEG_evaluate_on_framechange(worker->depsgraph, worker->cfra);
 }
 
-static void seq_prefetch_init_depsgraph(PrefetchJob *pfjob)
+/* Called by the worker thread, the frame to render must be set already. */
+static void seq_prefetch_init_depsgraph(PrefetchWorker *worker)
 {
-  Main *bmain = pfjob->bmain_eval;
+  PrefetchJob *pfjob = worker->pfjob;
+  Main *bmain = worker->bmain_eval;
   Scene *scene = pfjob->scene;
   ViewLayer *view_layer = BKE_view_layer_default_render(scene);
 
-  pfjob->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
-  DEG_debug_name_set(pfjob->depsgraph, "SEQUENCER PREFETCH");
+  BLI_mutex_lock(&pfjob->depsgraph_build_mutex);
+  worker->depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+  DEG_debug_name_set(worker->depsgraph, "SEQUENCER PREFETCH");
 
   /* Make sure there is a correct evaluated scene pointer. */
-  DEG_graph_build_for_render_pipeline(pfjob->depsgraph);
+  DEG_graph_build_for_render_pipeline(worker->depsgraph);
+  BLI_mutex_unlock(&pfjob->depsgraph_build_mutex);
 
   /* Update immediately so we have proper evaluated scene. */
-  seq_prefetch_update_depsgraph(pfjob);
+  seq_prefetch_update_depsgraph(worker);
 
-  pfjob->scene_eval = DEG_get_evaluated_scene(pfjob->depsgraph);
-  pfjob->scene_eval->ed->cache_flag = 0;
+  worker->scene_eval = DEG_get_evaluated_scene(worker->depsgraph);
+  worker->scene_eval->ed->cache_flag = 0;
 }
 
+/* Recompute the contiguous range of finished frames. Must be called with the job locked. */
+static void seq_prefetch_update_progress(PrefetchJob *pfjob)
+{
+  float first_unfinished = seq_prefetch_cfra(pfjob);
+
+  for (int i = 0; i < pfjob->num_workers; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    if (worker->rendering && worker->cfra > pfjob->cfra && worker->cfra < first_unfinished) {
+      first_unfinished = worker->cfra;
+    }
+  }
+
+  pfjob->num_frames_prefetched = max_ii((int)(first_unfinished - pfjob->cfra), 1);
+}
+
+/* Must be called with the job locked. */
 static void seq_prefetch_update_area(PrefetchJob *pfjob)
 {
   int cfra = pfjob->scene->r.cfra;
@@ -244,18 +336,21 @@ static void seq_prefetch_update_area(PrefetchJob *pfjob)
   if (cfra > pfjob->cfra) {
     int delta = cfra - pfjob->cfra;
     pfjob->cfra = cfra;
-    pfjob->num_frames_prefetched -= delta;
+    pfjob->num_frames_dispatched -= delta;
 
-    if (pfjob->num_frames_prefetched <= 1) {
-      pfjob->num_frames_prefetched = 1;
+    if (pfjob->num_frames_dispatched <= 1) {
+      pfjob->num_frames_dispatched = 1;
     }
   }
 
   /* reset */
   if (cfra < pfjob->cfra) {
     pfjob->cfra = cfra;
-    pfjob->num_frames_prefetched = 1;
+    pfjob->num_frames_dispatched = 1;
   }
+
+  seq_prefetch_update_progress(pfjob);
+  seq_prefetch_update_time_range(pfjob);
 }
 
 void SEQ_prefetch_stop_all(void)
@@ -281,41 +376,45 @@ void SEQ_prefetch_stop(Scene *scene)
   pfjob->stop = true;
 
   while (pfjob->running) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
-static void seq_prefetch_update_context(const SeqRenderData *context)
+/* Set up the render contexts of the worker, once its depsgraph has been built. */
+static void seq_prefetch_update_context(PrefetchWorker *worker)
 {
-  PrefetchJob *pfjob;
-  pfjob = seq_prefetch_job_get(context->scene);
+  PrefetchJob *pfjob = worker->pfjob;
+  const SeqRenderData *context = &pfjob->context;
 
-  SEQ_render_new_render_data(pfjob->bmain_eval,
-                             pfjob->depsgraph,
-                             pfjob->scene_eval,
+  /* Each worker has its own ID, so they only free their own temp cache entries. */
+  eSeqTaskId task_id = (eSeqTaskId)(SEQ_TASK_PREFETCH_RENDER + (worker - pfjob->workers));
+
+  SEQ_render_new_render_data(worker->bmain_eval,
+                             worker->depsgraph,
+                             worker->scene_eval,
                              context->rectx,
                              context->recty,
                              context->preview_render_size,
                              false,
-                             &pfjob->context_cpy);
-  pfjob->context_cpy.is_prefetch_render = true;
-  pfjob->context_cpy.task_id = SEQ_TASK_PREFETCH_RENDER;
+                             &worker->context_cpy);
+  worker->context_cpy.is_prefetch_render = true;
+  worker->context_cpy.task_id = task_id;
 
   SEQ_render_new_render_data(pfjob->bmain,
-                             pfjob->depsgraph,
+                             worker->depsgraph,
                              pfjob->scene,
                              context->rectx,
                              context->recty,
                              context->preview_render_size,
                              false,
-                             &pfjob->context);
-  pfjob->context.is_prefetch_render = false;
+                             &worker->context);
+  worker->context.is_prefetch_render = false;
 
   /* Same ID as prefetch context, because context will be swapped, but we still
    * want to assign this ID to cache entries created in this thread.
    * This is to allow "temp cache" work correctly for both threads.
    */
-  pfjob->context.task_id = SEQ_TASK_PREFETCH_RENDER;
+  worker->context.task_id = task_id;
 }
 
 static void seq_prefetch_update_scene(Scene *scene)
@@ -327,16 +426,20 @@ static void seq_prefetch_update_scene(Scene *scene)
   }
 
   pfjob->scene = scene;
-  seq_prefetch_free_depsgraph(pfjob);
-  seq_prefetch_init_depsgraph(pfjob);
+
+  /* Workers build new depsgraphs when they get their first frame, so the main thread doesn't
+   * wait for them, and unused workers don't keep a scene copy with its open movies around. */
+  for (int i = 0; i < pfjob->num_workers_alloc; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->workers[i]);
+  }
 }
 
 static void seq_prefetch_resume(Scene *scene)
 {
   PrefetchJob *pfjob = seq_prefetch_job_get(scene);
 
-  if (pfjob && pfjob->waiting) {
-    BLI_condition_notify_one(&pfjob->prefetch_suspend_cond);
+  if (pfjob && pfjob->num_workers_waiting > 0) {
+    BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
   }
 }
 
@@ -349,30 +452,36 @@ void seq_prefetch_free(Scene *scene)
 
   SEQ_prefetch_stop(scene);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
   BLI_threadpool_end(&pfjob->threads);
   BLI_mutex_end(&pfjob->prefetch_suspend_mutex);
   BLI_condition_end(&pfjob->prefetch_suspend_cond);
-  seq_prefetch_free_depsgraph(pfjob);
-  BKE_main_free(pfjob->bmain_eval);
+  BLI_mutex_end(&pfjob->depsgraph_build_mutex);
+  BLI_spin_end(&pfjob->time_range_lock);
+
+  for (int i = 0; i < pfjob->num_workers_alloc; i++) {
+    seq_prefetch_free_depsgraph(&pfjob->workers[i]);
+    BKE_main_free(pfjob->workers[i].bmain_eval);
+  }
+
+  MEM_freeN(pfjob->workers);
   MEM_freeN(pfjob);
   scene->ed->prefetch_job = NULL;
 }
 
 /* Skip frame if we need to render 3D scene strip. Rendering 3D scene requires main lock or setting
  * up render job that doesn't have API to do openGL renders which can be used for sequencer. */
-static bool seq_prefetch_do_skip_frame(PrefetchJob *pfjob, ListBase *seqbase)
+static bool seq_prefetch_do_skip_frame(PrefetchWorker *worker, ListBase *seqbase)
 {
-  float cfra = seq_prefetch_cfra(pfjob);
+  float cfra = worker->cfra;
   Sequence *seq_arr[MAXSEQ + 1];
   int count = seq_get_shown_sequences(seqbase, cfra, 0, seq_arr);
-  SeqRenderData *ctx = &pfjob->context_cpy;
+  SeqRenderData *ctx = &worker->context_cpy;
   ImBuf *ibuf = NULL;
 
   /* Disable prefetching 3D scene strips, but check for disk cache. */
   for (int i = 0; i < count; i++) {
     if (seq_arr[i]->type == SEQ_TYPE_META &&
-        seq_prefetch_do_skip_frame(pfjob, &seq_arr[i]->seqbase)) {
+        seq_prefetch_do_skip_frame(worker, &seq_arr[i]->seqbase)) {
       return true;
     }
 
@@ -426,34 +535,70 @@ static bool seq_prefetch_do_skip_frame(PrefetchJob *pfjob, ListBase *seqbase)
 static bool seq_prefetch_need_suspend(PrefetchJob *pfjob)
 {
   return seq_prefetch_is_cache_full(pfjob->scene) || seq_prefetch_is_scrubbing(pfjob->bmain) ||
-         (seq_prefetch_cfra(pfjob) >= pfjob->scene->r.efra);
+         (seq_prefetch_cfra(pfjob) > pfjob->scene->r.efra);
 }
 
-static void seq_prefetch_do_suspend(PrefetchJob *pfjob)
+/* Hand out the next frame to render to the worker, suspending it while there is nothing to be
+ * prefetched. Returns false when the worker should stop. */
+static bool seq_prefetch_next_frame(PrefetchWorker *worker)
 {
+  PrefetchJob *pfjob = worker->pfjob;
+  bool has_frame = false;
+
   BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+
+  worker->rendering = false;
+  seq_prefetch_update_progress(pfjob);
+
+  /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
+  if (pfjob->num_frames_prefetched > 5 &&
+      (pfjob->cfra + pfjob->num_frames_prefetched - pfjob->scene->r.cfra) < 2) {
+    BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+    return false;
+  }
+
+  seq_prefetch_update_area(pfjob);
+
   while (seq_prefetch_need_suspend(pfjob) &&
          (pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
-    pfjob->waiting = true;
+    pfjob->num_workers_waiting++;
+    pfjob->waiting = pfjob->num_workers_waiting == pfjob->num_workers_running;
     BLI_condition_wait(&pfjob->prefetch_suspend_cond, &pfjob->prefetch_suspend_mutex);
+    pfjob->num_workers_waiting--;
+    pfjob->waiting = false;
     seq_prefetch_update_area(pfjob);
   }
-  pfjob->waiting = false;
+
+  if ((pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) && !pfjob->stop) {
+    worker->cfra = seq_prefetch_cfra(pfjob);
+    worker->rendering = true;
+    pfjob->num_frames_dispatched++;
+    seq_prefetch_update_time_range(pfjob);
+    has_frame = true;
+  }
+
   BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
+
+  return has_frame;
 }
 
-static void *seq_prefetch_frames(void *job)
+static void *seq_prefetch_frames(void *worker_v)
 {
-  PrefetchJob *pfjob = (PrefetchJob *)job;
+  PrefetchWorker *worker = (PrefetchWorker *)worker_v;
+  PrefetchJob *pfjob = worker->pfjob;
 
-  while (seq_prefetch_cfra(pfjob) <= pfjob->scene->r.efra) {
-    pfjob->scene_eval->ed->prefetch_job = NULL;
+  while (seq_prefetch_next_frame(worker)) {
+    if (worker->depsgraph == NULL) {
+      seq_prefetch_init_depsgraph(worker);
+      seq_prefetch_update_context(worker);
+    }
+    worker->scene_eval->ed->prefetch_job = NULL;
 
-    seq_prefetch_update_depsgraph(pfjob);
-    AnimData *adt = BKE_animdata_from_id(&pfjob->context_cpy.scene->id);
-    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(pfjob);
+    seq_prefetch_update_depsgraph(worker);
+    AnimData *adt = BKE_animdata_from_id(&worker->context_cpy.scene->id);
+    AnimationEvalContext anim_eval_context = seq_prefetch_anim_eval_context(worker);
     BKE_animsys_evaluate_animdata(
-        &pfjob->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
+        &worker->context_cpy.scene->id, adt, &anim_eval_context, ADT_RECALC_ALL, false);
 
     /* This is quite hacky solution:
      * We need cross-reference original scene with copy for cache.
@@ -461,40 +606,83 @@ static void *seq_prefetch_frames(void *job)
      * Scene copy don't reference original scene. Perhaps, this could be done by depsgraph.
      * Set to NULL before return!
      */
-    pfjob->scene_eval->ed->prefetch_job = pfjob;
+    worker->scene_eval->ed->prefetch_job = pfjob;
 
     ListBase *seqbase = SEQ_active_seqbase_get(SEQ_editing_get(pfjob->scene, false));
-    if (seq_prefetch_do_skip_frame(pfjob, seqbase)) {
-      pfjob->num_frames_prefetched++;
+    if (seq_prefetch_do_skip_frame(worker, seqbase)) {
       continue;
     }
 
-    ImBuf *ibuf = SEQ_render_give_ibuf(&pfjob->context_cpy, seq_prefetch_cfra(pfjob), 0);
-    seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
+    ImBuf *ibuf = SEQ_render_give_ibuf(&worker->context_cpy, worker->cfra, 0);
+    seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, worker->cfra);
     IMB_freeImBuf(ibuf);
+  }
 
-    /* Suspend thread if there is nothing to be prefetched. */
-    seq_prefetch_do_suspend(pfjob);
+  if (worker->scene_eval != NULL) {
+    seq_cache_free_temp_cache(pfjob->scene, worker->context.task_id, seq_prefetch_cfra(pfjob));
+    worker->scene_eval->ed->prefetch_job = NULL;
+  }
 
-    /* Avoid "collision" with main thread, but make sure to fetch at least few frames */
-    if (pfjob->num_frames_prefetched > 5 &&
-        (seq_prefetch_cfra(pfjob) - pfjob->scene->r.cfra) < 2) {
-      break;
-    }
+  BLI_mutex_lock(&pfjob->prefetch_suspend_mutex);
+  worker->rendering = false;
+  pfjob->num_workers_running--;
+  pfjob->running = pfjob->num_workers_running > 0;
+  pfjob->waiting = pfjob->running && pfjob->num_workers_waiting == pfjob->num_workers_running;
+  BLI_mutex_unlock(&pfjob->prefetch_suspend_mutex);
 
-    if (!(pfjob->scene->ed->cache_flag & SEQ_CACHE_PREFETCH_ENABLE) || pfjob->stop) {
-      break;
-    }
+  /* Wake up other workers, they may be waiting only for the ones that stopped. */
+  BLI_condition_notify_all(&pfjob->prefetch_suspend_cond);
 
-    seq_prefetch_update_area(pfjob);
-    pfjob->num_frames_prefetched++;
+  return NULL;
+}
+
+static int seq_prefetch_num_workers_max(void)
+{
+  /* Effects and image processing of a single frame are threaded already, use the remaining
+   * parallelism for rendering multiple frames at once. */
+  return max_ii(1, min_ii(BLI_system_thread_count() / 4, SEQ_PREFETCH_MAX_WORKERS));
+}
+
+static void seq_prefetch_count_strips(ListBase *seqbase,
+                                      int *r_num_strips,
+                                      int *r_num_movie_strips)
+{
+  LISTBASE_FOREACH (Sequence *, seq, seqbase) {
+    (*r_num_strips)++;
+    if (seq->type == SEQ_TYPE_MOVIE) {
+      (*r_num_movie_strips)++;
+    }
+    else if (seq->type == SEQ_TYPE_META) {
+      seq_prefetch_count_strips(&seq->seqbase, r_num_strips, r_num_movie_strips);
+    }
   }
+}
 
-  seq_cache_free_temp_cache(pfjob->scene, pfjob->context.task_id, seq_prefetch_cfra(pfjob));
-  pfjob->running = false;
-  pfjob->scene_eval->ed->prefetch_job = NULL;
+/* Number of workers that fit in the memory budget, assuming that every strip of the frame holds a
+ * float image while the frame is rendered. */
+static int seq_prefetch_num_workers_for_memory(const SeqRenderData *context, const int num_strips)
+{
+  const size_t memory_max = BLI_system_memory_max_in_megabytes() * 1024 * 1024;
+  const size_t memory_in_use = MEM_get_memory_in_use();
+  if (memory_in_use >= memory_max) {
+    return 1;
+  }
+  const size_t memory_budget = (memory_max - memory_in_use) / SEQ_PREFETCH_MEMORY_FRACTION;
+  const size_t image_size = (size_t)context->rectx * context->recty * 4 * sizeof(float);
+  const size_t worker_size = max_zz(image_size * (num_strips + 1), 1);
+  return (int)min_zz(memory_budget / worker_size, SEQ_PREFETCH_MAX_WORKERS);
+}
 
-  return NULL;
+static int seq_prefetch_num_workers(PrefetchJob *pfjob, const SeqRenderData *context)
+{
+  int num_strips = 0, num_movie_strips = 0;
+  seq_prefetch_count_strips(&context->scene->ed->seqbase, &num_strips, &num_movie_strips);
+  int num_workers = min_ii(pfjob->num_workers_alloc,
+                           seq_prefetch_num_workers_for_memory(context, num_strips));
+  if (num_movie_strips > 0) {
+    num_workers = min_ii(num_workers, SEQ_PREFETCH_MAX_MOVIE_ANIMS / num_movie_strips);
+  }
+  return max_ii(1, num_workers);
 }
 
 static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cfra)
@@ -506,29 +694,52 @@ static PrefetchJob *seq_prefetch_start_ex(const SeqRenderData *context, float cf
       pfjob = (PrefetchJob *)MEM_callocN(sizeof(PrefetchJob), "PrefetchJob");
       context->scene->ed->prefetch_job = pfjob;
 
-      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, 1);
+      pfjob->num_workers_alloc = seq_prefetch_num_workers_max();
+      pfjob->workers = (PrefetchWorker *)MEM_callocN(
+          sizeof(PrefetchWorker) * pfjob->num_workers_alloc, "PrefetchWorker");
+
+      BLI_threadpool_init(&pfjob->threads, seq_prefetch_frames, pfjob->num_workers_alloc);
       BLI_mutex_init(&pfjob->prefetch_suspend_mutex);
       BLI_condition_init(&pfjob->prefetch_suspend_cond);
+      BLI_mutex_init(&pfjob->depsgraph_build_mutex);
+      BLI_spin_init(&pfjob->time_range_lock);
 
-      pfjob->bmain_eval = BKE_main_new();
       pfjob->scene = context->scene;
-      seq_prefetch_init_depsgraph(pfjob);
+      pfjob->cfra = cfra;
+
+      for (int i = 0; i < pfjob->num_workers_alloc; i++) {
+        PrefetchWorker *worker = &pfjob->workers[i];
+        worker->pfjob = pfjob;
+        worker->bmain_eval = BKE_main_new();
+      }
     }
   }
   pfjob->bmain = context->bmain;
+  pfjob->context = *context;
+  pfjob->num_workers = seq_prefetch_num_workers(pfjob, context);
 
   pfjob->cfra = cfra;
   pfjob->num_frames_prefetched = 1;
+  pfjob->num_frames_dispatched = 1;
+  seq_prefetch_update_time_range(pfjob);
 
+  pfjob->num_workers_running = pfjob->num_workers;
+  pfjob->num_workers_waiting = 0;
   pfjob->waiting = false;
   pfjob->stop = false;
   pfjob->running = true;
 
   seq_prefetch_update_scene(context->scene);
-  seq_prefetch_update_context(context);
 
-  BLI_threadpool_remove(&pfjob->threads, pfjob);
-  BLI_threadpool_insert(&pfjob->threads, pfjob);
+  for (int i = 0; i < pfjob->num_workers_alloc; i++) {
+    PrefetchWorker *worker = &pfjob->workers[i];
+    worker->rendering = false;
+
+    BLI_threadpool_remove(&pfjob->threads, worker);
+    if (i < pfjob->num_workers) {
+      BLI_threadpool_insert(&pfjob->threads, worker);
+    }
+  }
 
   return pfjob;
 }
@@ -35,6 +35,7 @@
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
 #include "BLI_string.h"
+#include "BLI_task.h"
 
 #ifdef WIN32
 #  include "BLI_winstuff.h"
@@ -260,45 +261,41 @@ ImBuf *seq_proxy_fetch(const SeqRenderData *context, Sequence *seq, int timeline
   return NULL;
 }
 
-static void seq_proxy_build_frame(const SeqRenderData *context,
-                                  SeqRenderState *state,
-                                  Sequence *seq,
-                                  int timeline_frame,
-                                  int proxy_render_size,
-                                  const bool overwrite)
-{
+typedef struct SeqProxyBuildSize {
+  int proxy_render_size;
   char name[PROXY_MAXFILE];
-  int quality;
-  int rectx, recty;
-  ImBuf *ibuf_tmp, *ibuf;
-  Editing *ed = context->scene->ed;
-
-  if (!seq_proxy_get_fname(ed, seq, timeline_frame, proxy_render_size, name, context->view_id)) {
-    return;
-  }
+} SeqProxyBuildSize;
 
-  if (!overwrite && BLI_exists(name)) {
-    return;
-  }
+typedef struct SeqProxyBuildFrameData {
+  Sequence *seq;
+  ImBuf *ibuf_render;
+  SeqProxyBuildSize *sizes;
+} SeqProxyBuildFrameData;
 
-  ibuf_tmp = seq_render_strip(context, state, seq, timeline_frame);
+static void seq_proxy_build_size(void *__restrict userdata,
+                                 const int i,
+                                 const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SeqProxyBuildFrameData *data = userdata;
+  const SeqProxyBuildSize *size = &data->sizes[i];
+  ImBuf *ibuf_render = data->ibuf_render;
+  ImBuf *ibuf;
+  int quality;
+  int rectx, recty;
 
-  rectx = (proxy_render_size * ibuf_tmp->x) / 100;
-  recty = (proxy_render_size * ibuf_tmp->y) / 100;
+  rectx = (size->proxy_render_size * ibuf_render->x) / 100;
+  recty = (size->proxy_render_size * ibuf_render->y) / 100;
 
-  if (ibuf_tmp->x != rectx || ibuf_tmp->y != recty) {
-    ibuf = IMB_dupImBuf(ibuf_tmp);
-    IMB_metadata_copy(ibuf, ibuf_tmp);
-    IMB_freeImBuf(ibuf_tmp);
+  /* The rendered frame is shared by all sizes, so it is never modified in place. */
+  ibuf = IMB_dupImBuf(ibuf_render);
+  IMB_metadata_copy(ibuf, ibuf_render);
+  if (ibuf->x != rectx || ibuf->y != recty) {
     IMB_scalefastImBuf(ibuf, (short)rectx, (short)recty);
   }
-  else {
-    ibuf = ibuf_tmp;
-  }
 
   /* depth = 32 is intentionally left in, otherwise ALPHA channels
    * won't work... */
-  quality = seq->strip->proxy->quality;
+  quality = data->seq->strip->proxy->quality;
   ibuf->ftype = IMB_FTYPE_JPG;
   ibuf->foptions.quality = quality;
 
@@ -307,16 +304,75 @@ static void seq_proxy_build_frame(const SeqRenderData *context,
     ibuf->planes = 24;
   }
 
-  BLI_make_existing_file(name);
+  BLI_make_existing_file(size->name);
 
-  const bool ok = IMB_saveiff(ibuf, name, IB_rect | IB_zbuf | IB_zbuffloat);
+  const bool ok = IMB_saveiff(ibuf, size->name, IB_rect | IB_zbuf | IB_zbuffloat);
   if (ok == false) {
-    perror(name);
+    perror(size->name);
   }
 
   IMB_freeImBuf(ibuf);
 }
 
+/**
+ * Render the strip once and write all requested proxy sizes of the frame from that render,
+ * scaling and compressing the sizes in parallel.
+ */
+static void seq_proxy_build_frame(const SeqRenderData *context,
+                                  SeqRenderState *state,
+                                  Sequence *seq,
+                                  int timeline_frame,
+                                  IMB_Proxy_Size size_flags,
+                                  const bool overwrite)
+{
+  static const int proxy_render_sizes[] = {25, 50, 75, 100};
+  static const IMB_Proxy_Size proxy_sizes[] = {
+      IMB_PROXY_25, IMB_PROXY_50, IMB_PROXY_75, IMB_PROXY_100};
+  SeqProxyBuildSize sizes[ARRAY_SIZE(proxy_render_sizes)];
+  int sizes_num = 0;
+  Editing *ed = context->scene->ed;
+
+  for (int i = 0; i < ARRAY_SIZE(proxy_render_sizes); i++) {
+    const int proxy_render_size = proxy_render_sizes[i];
+    SeqProxyBuildSize *size = &sizes[sizes_num];
+
+    if ((size_flags & proxy_sizes[i]) == 0) {
+      continue;
+    }
+    if (!seq_proxy_get_fname(
+            ed, seq, timeline_frame, proxy_render_size, size->name, context->view_id)) {
+      continue;
+    }
+    if (!overwrite && BLI_exists(size->name)) {
+      continue;
+    }
+
+    size->proxy_render_size = proxy_render_size;
+    sizes_num++;
+  }
+
+  if (sizes_num == 0) {
+    return;
+  }
+
+  ImBuf *ibuf_render = seq_render_strip(context, state, seq, timeline_frame);
+  if (ibuf_render == NULL) {
+    return;
+  }
+
+  SeqProxyBuildFrameData data = {
+      .seq = seq,
+      .ibuf_render = ibuf_render,
+      .sizes = sizes,
+  };
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = sizes_num > 1;
+  BLI_task_parallel_range(0, sizes_num, &data, seq_proxy_build_size, &settings);
+
+  IMB_freeImBuf(ibuf_render);
+}
+
 /**
  * Returns whether the file this context would read from even exist,
  * if not, don't create the context
@@ -515,18 +571,8 @@ void SEQ_proxy_rebuild(SeqIndexBuildContext *context,
   for (timeline_frame = seq->startdisp + seq->startstill;
        timeline_frame < seq->enddisp - seq->endstill;
        timeline_frame++) {
-    if (context->size_flags & IMB_PROXY_25) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 25, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_50) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 50, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_75) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 75, overwrite);
-    }
-    if (context->size_flags & IMB_PROXY_100) {
-      seq_proxy_build_frame(&render_context, &state, seq, timeline_frame, 100, overwrite);
-    }
+    seq_proxy_build_frame(
+        &render_context, &state, seq, timeline_frame, context->size_flags, overwrite);
 
     *progress = (float)(timeline_frame - seq->startdisp - seq->startstill) /
                 (seq->enddisp - seq->endstill - seq->startdisp - seq->startstill);
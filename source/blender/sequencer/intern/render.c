@@ -37,6 +37,7 @@
 #include "BLI_linklist.h"
 #include "BLI_listbase.h"
 #include "BLI_path_util.h"
+#include "BLI_rect.h"
 
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
@@ -487,27 +488,96 @@ static bool seq_input_have_to_preprocess(const SeqRenderData *context,
 typedef struct ImageTransformThreadInitData {
   ImBuf *ibuf_source;
   ImBuf *ibuf_out;
-  StripTransform *transform;
-  float scale_to_fit;
-  float image_scale_factor;
-  float preview_scale_factor;
+  /* Maps output pixels to source pixels. */
+  float transform_matrix[3][3];
+  /* Output pixels the source is visible in, max is exclusive. */
+  rcti region;
   bool for_render;
 } ImageTransformThreadInitData;
 
 typedef struct ImageTransformThreadData {
   ImBuf *ibuf_source;
   ImBuf *ibuf_out;
-  StripTransform *transform;
-  float scale_to_fit;
-  /* image_scale_factor is used to scale proxies to correct preview size. */
-  float image_scale_factor;
-  /* Preview scale factor is needed to correct translation to match preview size. */
-  float preview_scale_factor;
+  const float (*transform_matrix)[3];
+  int xmin, xmax;
   bool for_render;
   int start_line;
   int tot_line;
 } ImageTransformThreadData;
 
+/**
+ * Matrix mapping output pixels to source pixels.
+ *
+ * \param image_scale_factor: Used to scale proxies to correct preview size.
+ * \param preview_scale_factor: Needed to correct translation to match preview size.
+ */
+static void sequencer_image_transform_matrix_get(const ImBuf *ibuf_source,
+                                                 const ImBuf *ibuf_out,
+                                                 const StripTransform *transform,
+                                                 const float image_scale_factor,
+                                                 const float preview_scale_factor,
+                                                 float r_transform_matrix[3][3])
+{
+  const float scale_x = transform->scale_x * image_scale_factor;
+  const float scale_y = transform->scale_y * image_scale_factor;
+  const float image_center_offs_x = (ibuf_out->x - ibuf_source->x) / 2;
+  const float image_center_offs_y = (ibuf_out->y - ibuf_source->y) / 2;
+  const float translate_x = transform->xofs * preview_scale_factor + image_center_offs_x;
+  const float translate_y = transform->yofs * preview_scale_factor + image_center_offs_y;
+  const float pivot[2] = {ibuf_source->x / 2, ibuf_source->y / 2};
+  loc_rot_size_to_mat3(r_transform_matrix,
+                       (const float[]){translate_x, translate_y},
+                       transform->rotation,
+                       (const float[]){scale_x, scale_y});
+  invert_m3(r_transform_matrix);
+  transform_pivot_set_m3(r_transform_matrix, pivot);
+}
+
+/**
+ * Find the output pixels in which the non-transparent part of the source can be visible.
+ * Both interpolation methods write zero for samples outside of the source, as do the crop fills,
+ * so pixels outside of the region can be left as allocated.
+ *
+ * \param source_rect: Part of the source which is not cropped.
+ * \return false when no output pixel is affected.
+ */
+static bool sequencer_image_transform_region_get(const ImBuf *ibuf_out,
+                                                 const float transform_matrix[3][3],
+                                                 const rctf *source_rect,
+                                                 rcti *r_region)
+{
+  BLI_rcti_init(r_region, 0, ibuf_out->x, 0, ibuf_out->y);
+
+  float source_to_out[3][3];
+  if (!invert_m3_m3(source_to_out, transform_matrix)) {
+    return true;
+  }
+
+  /* Samples less than a pixel before the first pixel still pick up the first pixel. */
+  const float corners[4][2] = {
+      {source_rect->xmin - 1.0f, source_rect->ymin - 1.0f},
+      {source_rect->xmax, source_rect->ymin - 1.0f},
+      {source_rect->xmin - 1.0f, source_rect->ymax},
+      {source_rect->xmax, source_rect->ymax},
+  };
+  rctf bounds;
+  BLI_rctf_init_minmax(&bounds);
+  for (int i = 0; i < 4; i++) {
+    float co[2];
+    mul_v2_m3v2(co, source_to_out, corners[i]);
+    BLI_rctf_do_minmax_v(&bounds, co);
+  }
+
+  /* One pixel of margin on each side for rounding. Clamp before converting to int, the bounds
+   * can be huge for strips scaled down to almost nothing. */
+  BLI_rcti_init(r_region,
+                (int)clamp_f(floorf(bounds.xmin) - 1.0f, 0.0f, ibuf_out->x),
+                (int)clamp_f(ceilf(bounds.xmax) + 2.0f, 0.0f, ibuf_out->x),
+                (int)clamp_f(floorf(bounds.ymin) - 1.0f, 0.0f, ibuf_out->y),
+                (int)clamp_f(ceilf(bounds.ymax) + 2.0f, 0.0f, ibuf_out->y));
+  return !BLI_rcti_is_empty(r_region);
+}
+
 static void sequencer_image_transform_init(void *handle_v,
                                            int start_line,
                                            int tot_line,
@@ -518,39 +588,24 @@ static void sequencer_image_transform_init(void *handle_v,
 
   handle->ibuf_source = init_data->ibuf_source;
   handle->ibuf_out = init_data->ibuf_out;
-  handle->transform = init_data->transform;
-  handle->image_scale_factor = init_data->image_scale_factor;
-  handle->preview_scale_factor = init_data->preview_scale_factor;
+  handle->transform_matrix = init_data->transform_matrix;
+  handle->xmin = init_data->region.xmin;
+  handle->xmax = init_data->region.xmax;
   handle->for_render = init_data->for_render;
 
-  handle->start_line = start_line;
+  /* Lines are split over the region only. */
+  handle->start_line = init_data->region.ymin + start_line;
   handle->tot_line = tot_line;
 }
 
 static void *sequencer_image_transform_do_thread(void *data_v)
 {
   const ImageTransformThreadData *data = (ImageTransformThreadData *)data_v;
-  const StripTransform *transform = data->transform;
-  const float scale_x = transform->scale_x * data->image_scale_factor;
-  const float scale_y = transform->scale_y * data->image_scale_factor;
-  const float image_center_offs_x = (data->ibuf_out->x - data->ibuf_source->x) / 2;
-  const float image_center_offs_y = (data->ibuf_out->y - data->ibuf_source->y) / 2;
-  const float translate_x = transform->xofs * data->preview_scale_factor + image_center_offs_x;
-  const float translate_y = transform->yofs * data->preview_scale_factor + image_center_offs_y;
-  const float pivot[2] = {data->ibuf_source->x / 2, data->ibuf_source->y / 2};
-  float transform_matrix[3][3];
-  loc_rot_size_to_mat3(transform_matrix,
-                       (const float[]){translate_x, translate_y},
-                       transform->rotation,
-                       (const float[]){scale_x, scale_y});
-  invert_m3(transform_matrix);
-  transform_pivot_set_m3(transform_matrix, pivot);
 
-  const int width = data->ibuf_out->x;
   for (int yi = data->start_line; yi < data->start_line + data->tot_line; yi++) {
-    for (int xi = 0; xi < width; xi++) {
+    for (int xi = data->xmin; xi < data->xmax; xi++) {
       float uv[2] = {xi, yi};
-      mul_v2_m3v2(uv, transform_matrix, uv);
+      mul_v2_m3v2(uv, data->transform_matrix, uv);
 
       if (data->for_render) {
         bilinear_interpolation(data->ibuf_source, data->ibuf_out, uv[0], uv[1], xi, yi);
@@ -566,12 +621,12 @@ static void *sequencer_image_transform_do_thread(void *data_v)
 
 static void multibuf(ImBuf *ibuf, const float fmul)
 {
-  char *rt;
+  unsigned char *rt;
   float *rt_float;
 
   int a;
 
-  rt = (char *)ibuf->rect;
+  rt = (unsigned char *)ibuf->rect;
   rt_float = ibuf->rect_float;
 
   if (rt) {
@@ -644,6 +699,10 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
     preview_scale_factor = SEQ_rendersize_to_scale_factor(context->preview_render_size);
   }
 
+  /* Part of the source which is not cropped away. */
+  rctf source_rect;
+  BLI_rctf_init(&source_rect, 0.0f, ibuf->x, 0.0f, ibuf->y);
+
   if (sequencer_use_crop(seq)) {
     /* Change original image pointer to avoid another duplication in SEQ_USE_TRANSFORM. */
     preprocessed_ibuf = IMB_makeSingleUser(ibuf);
@@ -672,6 +731,8 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
     IMB_rectfill_area_replace(preprocessed_ibuf, col, width - right, bottom, width, height);
     /* Top. */
     IMB_rectfill_area_replace(preprocessed_ibuf, col, left, height - top, width - right, height);
+
+    BLI_rctf_init(&source_rect, left, width - right, bottom, height - top);
   }
 
   if (sequencer_use_transform(seq) || context->rectx != ibuf->x || context->recty != ibuf->y) {
@@ -682,20 +743,25 @@ static ImBuf *input_preprocess(const SeqRenderData *context,
     ImageTransformThreadInitData init_data = {NULL};
     init_data.ibuf_source = ibuf;
     init_data.ibuf_out = preprocessed_ibuf;
-    init_data.transform = seq->strip->transform;
-    if (seq_need_scale_to_render_size(seq, is_proxy_image)) {
-      init_data.image_scale_factor = 1.0f;
-    }
-    else {
-      init_data.image_scale_factor = preview_scale_factor;
-    }
-    init_data.preview_scale_factor = preview_scale_factor;
+    sequencer_image_transform_matrix_get(
+        ibuf,
+        preprocessed_ibuf,
+        seq->strip->transform,
+        seq_need_scale_to_render_size(seq, is_proxy_image) ? 1.0f : preview_scale_factor,
+        preview_scale_factor,
+        init_data.transform_matrix);
     init_data.for_render = context->for_render;
-    IMB_processor_apply_threaded(context->recty,
-                                 sizeof(ImageTransformThreadData),
-                                 &init_data,
-                                 sequencer_image_transform_init,
-                                 sequencer_image_transform_do_thread);
+
+    /* Only transform the part of the frame the strip is visible in, the rest stays
+     * transparent. */
+    if (sequencer_image_transform_region_get(
+            preprocessed_ibuf, init_data.transform_matrix, &source_rect, &init_data.region)) {
+      IMB_processor_apply_threaded(BLI_rcti_size_y(&init_data.region),
+                                   sizeof(ImageTransformThreadData),
+                                   &init_data,
+                                   sequencer_image_transform_init,
+                                   sequencer_image_transform_do_thread);
+    }
     seq_imbuf_assign_spaces(scene, preprocessed_ibuf);
     IMB_metadata_copy(preprocessed_ibuf, ibuf);
     IMB_freeImBuf(ibuf);
@@ -1877,6 +1943,50 @@ static int seq_get_early_out_for_blend_mode(Sequence *seq)
   return early_out;
 }
 
+/* Strips that are alpha-overed at full opacity hide everything below them where they are
+ * opaque. */
+static bool seq_render_strip_may_occlude(Sequence *seq)
+{
+  return seq->blend_mode == SEQ_TYPE_ALPHAOVER && seq->blend_opacity >= 100.0f;
+}
+
+/* Check whether the image covers the whole frame with opaque pixels. */
+static bool seq_render_ibuf_is_opaque(const SeqRenderData *context, const ImBuf *ibuf)
+{
+  if (ibuf == NULL || ibuf->x != context->rectx || ibuf->y != context->recty) {
+    return false;
+  }
+
+  const size_t num_pixels = (size_t)ibuf->x * ibuf->y;
+
+  /* Blending uses the float buffer when there is one. */
+  if (ibuf->rect_float) {
+    if (ibuf->channels != 4) {
+      return ibuf->channels == 3;
+    }
+
+    const float *rect_float = ibuf->rect_float;
+    for (size_t i = 0; i < num_pixels; i++) {
+      if (rect_float[i * 4 + 3] < 1.0f) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (ibuf->rect) {
+    const uchar *rect = (const uchar *)ibuf->rect;
+    for (size_t i = 0; i < num_pixels; i++) {
+      if (rect[i * 4 + 3] != 255) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  return false;
+}
+
 static ImBuf *seq_render_strip_stack_apply_effect(
     const SeqRenderData *context, Sequence *seq, float timeline_frame, ImBuf *ibuf1, ImBuf *ibuf2)
 {
@@ -1914,6 +2024,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
                                      int chanshown)
 {
   Sequence *seq_arr[MAXSEQ + 1];
+  /* Strips rendered while looking for the bottom of the visible stack, used when blending. */
+  ImBuf *ibuf_arr[MAXSEQ + 1] = {NULL};
   int count;
   int i;
   ImBuf *out = NULL;
@@ -1962,6 +2074,16 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
           IMB_freeImBuf(ibuf1);
           IMB_freeImBuf(ibuf2);
         }
+        else if (seq_render_strip_may_occlude(seq)) {
+          /* The strip has to be rendered for blending anyway. When it turns out to cover the
+           * whole frame, strips below it are not rendered at all. */
+          ibuf_arr[i] = seq_render_strip(context, state, seq, timeline_frame);
+
+          if (seq_render_ibuf_is_opaque(context, ibuf_arr[i])) {
+            out = ibuf_arr[i];
+            ibuf_arr[i] = NULL;
+          }
+        }
         break;
     }
     if (out) {
@@ -1975,7 +2097,8 @@ static ImBuf *seq_render_strip_stack(const SeqRenderData *context,
 
     if (seq_get_early_out_for_blend_mode(seq) == EARLY_DO_EFFECT) {
       ImBuf *ibuf1 = out;
-      ImBuf *ibuf2 = seq_render_strip(context, state, seq, timeline_frame);
+      ImBuf *ibuf2 = ibuf_arr[i] ? ibuf_arr[i] :
+                                   seq_render_strip(context, state, seq, timeline_frame);
 
       out = seq_render_strip_stack_apply_effect(context, seq, timeline_frame, ibuf1, ibuf2);
 
@@ -2028,7 +2151,13 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
   seq_cache_free_temp_cache(context->scene, context->task_id, timeline_frame);
 
   if (count && !out) {
-    BLI_mutex_lock(&seq_render_mutex);
+    /* Prefetch workers each render their own evaluated copy of the scene, so they can render
+     * frames concurrently. Shared state such as the fonts of text strips is locked where used. */
+    const bool use_render_mutex = !context->is_prefetch_render;
+
+    if (use_render_mutex) {
+      BLI_mutex_lock(&seq_render_mutex);
+    }
     out = seq_render_strip_stack(context, &state, seqbasep, timeline_frame, chanshown);
 
     if (context->is_prefetch_render) {
@@ -2038,7 +2167,9 @@ ImBuf *SEQ_render_give_ibuf(const SeqRenderData *context, float timeline_frame,
       seq_cache_put_if_possible(
           context, seq_arr[count - 1], timeline_frame, SEQ_CACHE_STORE_FINAL_OUT, out);
     }
-    BLI_mutex_unlock(&seq_render_mutex);
+    if (use_render_mutex) {
+      BLI_mutex_unlock(&seq_render_mutex);
+    }
   }
 
   seq_prefetch_start(context, timeline_frame);
@@ -97,6 +97,7 @@
 #include "RNA_access.h"
 #include "RNA_define.h"
 
+#include "IMB_colormanagement.h"
 #include "IMB_imbuf.h"
 #include "IMB_imbuf_types.h"
 #include "IMB_thumbs.h"
@@ -410,6 +411,7 @@ static void wm_init_userdef(Main *bmain)
   }
 
   MEM_CacheLimiter_set_maximum(((size_t)U.memcachelimit) * 1024 * 1024);
+  IMB_colormanagement_display_lut_use_set((U.gpu_flag & USER_GPU_FLAG_DISPLAY_LUT) != 0);
   BKE_sound_init(bmain);
 
   /* Update the temporary directory from the preferences or fallback to the system default. */